@@ -3,6 +3,8 @@
 #include "display.h"
 #include "system_info.h"
 #include "audio_codec.h"
+#include "audio_pool.h"
+#include "audio_latency.h"
 #include "mqtt_protocol.h"
 #include "websocket_protocol.h"
 #include "assets/lang_config.h"
@@ -339,6 +341,7 @@ void Application::StopListening() {
 
     Schedule([this]() {
         if (device_state_ == kDeviceStateListening) {
+            audio_service_.WarmUpOutput();
             protocol_->SendStopListening();
             SetDeviceState(kDeviceStateIdle);
         }
@@ -359,6 +362,12 @@ void Application::Start() {
     auto codec = board.GetAudioCodec();
     audio_service_.Initialize(codec);
     audio_service_.Start();
+#if CONFIG_USE_SOUND_PCM_CACHE
+    // Latency critical cues skip the decoder when played
+    audio_service_.CacheSound(Lang::Sounds::OGG_POPUP);
+    audio_service_.CacheSound(Lang::Sounds::OGG_SUCCESS);
+    audio_service_.CacheSound(Lang::Sounds::OGG_EXCLAMATION);
+#endif
 
     AudioServiceCallbacks callbacks;
     callbacks.on_send_queue_available = [this]() {
@@ -410,6 +419,7 @@ void Application::Start() {
         ESP_LOGW(TAG, "No protocol specified in the OTA config, using MQTT");
         protocol_ = std::make_unique<MqttProtocol>();
     }
+    UpdateUplinkFrameDuration();
 
     protocol_->OnConnected([this]() {
         DismissAlert();
@@ -420,12 +430,14 @@ void Application::Start() {
         xEventGroupSetBits(event_group_, MAIN_EVENT_ERROR);
     });
     protocol_->OnIncomingAudio([this](std::unique_ptr<AudioStreamPacket> packet) {
-        if (device_state_ == kDeviceStateSpeaking) {
+        // Audio still in flight for an aborted utterance is dropped until the next tts start
+        if (device_state_ == kDeviceStateSpeaking && !aborted_) {
             audio_service_.PushPacketToDecodeQueue(std::move(packet));
         }
     });
     protocol_->OnAudioChannelOpened([this, codec, &board]() {
         board.SetPowerSaveMode(false);
+        ApplyNegotiatedFrameDurations();
         if (protocol_->server_sample_rate() != codec->output_sample_rate()) {
             ESP_LOGW(TAG, "Server sample rate %d does not match device output sample rate %d, resampling may cause distortion",
                 protocol_->server_sample_rate(), codec->output_sample_rate());
@@ -445,8 +457,10 @@ void Application::Start() {
         if (strcmp(type->valuestring, "tts") == 0) {
             auto state = cJSON_GetObjectItem(root, "state");
             if (strcmp(state->valuestring, "start") == 0) {
+                // Cleared here rather than in the scheduled callback, the new utterance's audio may arrive first
+                aborted_ = false;
+                audio_service_.WarmUpOutput(true);
                 Schedule([this]() {
-                    aborted_ = false;
                     if (device_state_ == kDeviceStateIdle || device_state_ == kDeviceStateListening) {
                         SetDeviceState(kDeviceStateSpeaking);
                     }
@@ -465,12 +479,16 @@ void Application::Start() {
                 auto text = cJSON_GetObjectItem(root, "text");
                 if (cJSON_IsString(text)) {
                     ESP_LOGI(TAG, "<< %s", text->valuestring);
+                    // Marked here, the sentence's audio follows this message and may arrive before the callback runs
+                    audio_service_.MarkSentenceStart();
                     Schedule([this, display, message = std::string(text->valuestring)]() {
                         display->SetChatMessage("assistant", message.c_str());
                     });
                 }
             }
         } else if (strcmp(type->valuestring, "stt") == 0) {
+            // The reply follows the transcript, power the speaker up while the server thinks
+            audio_service_.WarmUpOutput();
             auto text = cJSON_GetObjectItem(root, "text");
             if (cJSON_IsString(text)) {
                 ESP_LOGI(TAG, ">> %s", text->valuestring);
@@ -585,6 +603,9 @@ void Application::MainEventLoop() {
             if (device_state_ == kDeviceStateListening) {
                 auto led = Board::GetInstance().GetLed();
                 led->OnStateChanged();
+                if (!audio_service_.IsVoiceDetected()) {
+                    audio_service_.WarmUpOutput();
+                }
             }
         }
 
@@ -607,6 +628,10 @@ void Application::MainEventLoop() {
                 // SystemInfo::PrintTaskCpuUsage(pdMS_TO_TICKS(1000));
                 // SystemInfo::PrintTaskList();
                 SystemInfo::PrintHeapStats();
+                AudioPool::PrintStats();
+#if CONFIG_USE_AUDIO_LATENCY_TRACE
+                AudioLatency::PrintStats();
+#endif
             }
         }
     }
@@ -653,6 +678,8 @@ void Application::OnWakeWordDetected() {
 void Application::AbortSpeaking(AbortReason reason) {
     ESP_LOGI(TAG, "Abort speaking");
     aborted_ = true;
+    // Go silent locally instead of waiting for the server's tts stop
+    audio_service_.AbortPlayback();
     if (protocol_) {
         protocol_->SendAbortSpeaking(reason);
     }
@@ -887,9 +914,33 @@ void Application::SetAecMode(AecMode mode) {
         if (protocol_ && protocol_->IsAudioChannelOpened()) {
             protocol_->CloseAudioChannel();
         }
+        UpdateUplinkFrameDuration();
     });
 }
 
+void Application::UpdateUplinkFrameDuration() {
+    // Realtime mode trades more packets for lower latency, the new size is announced in the next hello
+    int frame_duration = aec_mode_ == kAecOff ? OPUS_FRAME_DURATION_MS : CONFIG_REALTIME_OPUS_FRAME_DURATION_MS;
+    audio_service_.SetUplinkFrameDuration(frame_duration);
+    if (protocol_) {
+        protocol_->SetClientFrameDuration(audio_service_.uplink_frame_duration());
+    }
+}
+
+void Application::ApplyNegotiatedFrameDurations() {
+    audio_service_.SetDownlinkFrameDuration(protocol_->server_frame_duration());
+
+    /* A server that does not echo the shorter uplink frame in its hello keeps getting the default */
+    int requested = protocol_->client_frame_duration();
+    int accepted = protocol_->accepted_client_frame_duration();
+    if (requested != OPUS_FRAME_DURATION_MS && accepted != requested) {
+        ESP_LOGW(TAG, "Server did not accept %d ms uplink frames (hello says %d), using %d ms",
+            requested, accepted, OPUS_FRAME_DURATION_MS);
+        requested = OPUS_FRAME_DURATION_MS;
+    }
+    audio_service_.SetUplinkFrameDuration(requested);
+}
+
 void Application::PlaySound(const std::string_view& sound) {
     audio_service_.PlaySound(sound);
 }
\ No newline at end of file
@@ -8,6 +8,7 @@
 
 #include <string>
 #include <mutex>
+#include <atomic>
 #include <deque>
 #include <memory>
 
@@ -80,7 +81,7 @@ private:
     AudioService audio_service_;
 
     bool has_server_time_ = false;
-    bool aborted_ = false;
+    std::atomic<bool> aborted_ = false;
     int clock_ticks_ = 0;
     TaskHandle_t check_new_version_task_handle_ = nullptr;
     TaskHandle_t main_event_loop_task_handle_ = nullptr;
@@ -90,6 +91,9 @@ private:
     void CheckAssetsVersion();
     void ShowActivationCode(const std::string& code, const std::string& message);
     void SetListeningMode(ListeningMode mode);
+    void UpdateUplinkFrameDuration();
+    // Called when the audio channel opens, falls back to the default uplink frame the server did not accept
+    void ApplyNegotiatedFrameDurations();
 };
 
 
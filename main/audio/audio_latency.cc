@@ -0,0 +1,119 @@
+#include "audio_latency.h"
+
+#if CONFIG_USE_AUDIO_LATENCY_TRACE
+
+#include <cstdio>
+#include <esp_log.h>
+#include <freertos/FreeRTOS.h>
+
+#define TAG "AudioLatency"
+
+namespace {
+
+const char* const kStageNames[kLatencyStageCount] = {
+    "process", "encode", "send", "uplink", "jitter", "decode", "resample", "playback", "downlink", "abort", "first_sample",
+};
+
+struct Histogram {
+    uint32_t buckets[AUDIO_LATENCY_BUCKETS];
+    uint32_t count;
+    uint32_t max_ms;
+};
+
+Histogram s_histograms[kLatencyStageCount];
+portMUX_TYPE s_lock = portMUX_INITIALIZER_UNLOCKED;
+
+// Bucket i holds [5 << (i - 1), 5 << i) ms, the last one everything above
+int BucketOf(uint32_t ms) {
+    int bucket = 0;
+    while (bucket < AUDIO_LATENCY_BUCKETS - 1 && ms >= (5u << bucket)) {
+        bucket++;
+    }
+    return bucket;
+}
+
+uint32_t Percentile(const Histogram& histogram, uint32_t percent) {
+    if (histogram.count == 0) {
+        return 0;
+    }
+    uint32_t rank = (histogram.count * percent + 99) / 100;
+    uint32_t seen = 0;
+    for (int i = 0; i < AUDIO_LATENCY_BUCKETS - 1; i++) {
+        seen += histogram.buckets[i];
+        if (seen >= rank) {
+            uint32_t upper = 5u << i;
+            return upper < histogram.max_ms ? upper : histogram.max_ms;
+        }
+    }
+    return histogram.max_ms;
+}
+
+Histogram Snapshot(AudioLatencyStage stage) {
+    portENTER_CRITICAL(&s_lock);
+    Histogram histogram = s_histograms[stage];
+    portEXIT_CRITICAL(&s_lock);
+    return histogram;
+}
+
+} // namespace
+
+void AudioLatency::Record(AudioLatencyStage stage, int64_t start_us, int64_t end_us) {
+    if (start_us == 0 || end_us < start_us) {
+        return;
+    }
+    uint32_t ms = (end_us - start_us) / 1000;
+    int bucket = BucketOf(ms);
+    portENTER_CRITICAL(&s_lock);
+    auto& histogram = s_histograms[stage];
+    histogram.buckets[bucket]++;
+    histogram.count++;
+    if (ms > histogram.max_ms) {
+        histogram.max_ms = ms;
+    }
+    portEXIT_CRITICAL(&s_lock);
+}
+
+void AudioLatency::Reset() {
+    portENTER_CRITICAL(&s_lock);
+    for (auto& histogram : s_histograms) {
+        histogram = Histogram();
+    }
+    portEXIT_CRITICAL(&s_lock);
+}
+
+cJSON* AudioLatency::GetJson() {
+    cJSON* json = cJSON_CreateObject();
+    for (int i = 0; i < kLatencyStageCount; i++) {
+        auto histogram = Snapshot(static_cast<AudioLatencyStage>(i));
+        cJSON* stage = cJSON_CreateObject();
+        cJSON_AddNumberToObject(stage, "count", histogram.count);
+        cJSON_AddNumberToObject(stage, "p50_ms", Percentile(histogram, 50));
+        cJSON_AddNumberToObject(stage, "p95_ms", Percentile(histogram, 95));
+        cJSON_AddNumberToObject(stage, "max_ms", histogram.max_ms);
+        cJSON* buckets = cJSON_CreateArray();
+        for (int b = 0; b < AUDIO_LATENCY_BUCKETS; b++) {
+            cJSON_AddItemToArray(buckets, cJSON_CreateNumber(histogram.buckets[b]));
+        }
+        cJSON_AddItemToObject(stage, "buckets", buckets);
+        cJSON_AddItemToObject(json, kStageNames[i], stage);
+    }
+    return json;
+}
+
+void AudioLatency::PrintStats() {
+    char line[320];
+    int length = 0;
+    for (int i = 0; i < kLatencyStageCount && length < (int)sizeof(line); i++) {
+        auto histogram = Snapshot(static_cast<AudioLatencyStage>(i));
+        if (histogram.count == 0) {
+            continue;
+        }
+        length += snprintf(line + length, sizeof(line) - length, " %s %lu/%lu/%lu",
+            kStageNames[i], Percentile(histogram, 50), Percentile(histogram, 95), histogram.max_ms);
+    }
+    if (length > 0) {
+        ESP_LOGI(TAG, "p50/p95/max ms:%s", line);
+    }
+}
+
+#endif // CONFIG_USE_AUDIO_LATENCY_TRACE
@@ -0,0 +1,53 @@
+#ifndef AUDIO_LATENCY_H
+#define AUDIO_LATENCY_H
+
+#include <cstdint>
+#include <sdkconfig.h>
+#include <cJSON.h>
+
+/*
+ * Per-stage audio latency histograms (CONFIG_USE_AUDIO_LATENCY_TRACE).
+ *
+ * Uplink frames carry the time they were captured and downlink packets the
+ * time they were received, plus the time they left the previous stage, in
+ * AudioTrace (esp_timer microseconds). Each stage records its delta into a
+ * fixed-bucket histogram. Percentiles are reported as the upper bound of the
+ * bucket they fall in. When the option is off the trace fields and every
+ * call site are compiled out.
+ */
+
+enum AudioLatencyStage {
+    kLatencyProcess,    // capture -> audio processor output
+    kLatencyEncode,     // processor output -> encoded (encode queue + encoder)
+    kLatencySend,       // encoded -> handed to the protocol (send queue)
+    kLatencyUplink,     // capture -> handed to the protocol
+    kLatencyJitter,     // network receive -> decode start (decode queue + jitter buffer)
+    kLatencyDecode,     // Opus decode
+    kLatencyResample,   // output resampler
+    kLatencyPlayback,   // decoded -> I2S write returned (playback queue + codec)
+    kLatencyDownlink,   // network receive -> I2S write returned
+    kLatencyAbort,      // AbortPlayback() -> last sample out of the DMA ring (estimated)
+    kLatencyFirstSample, // tts start -> first speech sample written to the codec
+    kLatencyStageCount,
+};
+
+// 5, 10, 20 ... 1280 ms and above
+#define AUDIO_LATENCY_BUCKETS 10
+
+struct AudioTrace {
+    int64_t origin_us = 0;  // capture or network receive, 0 if not traced (e.g. local sounds)
+    int64_t stage_us = 0;   // left the previous stage
+};
+
+class AudioLatency {
+public:
+    // Ignored if start_us is 0
+    static void Record(AudioLatencyStage stage, int64_t start_us, int64_t end_us);
+    static void Reset();
+    // {"uplink": {"count", "p50_ms", "p95_ms", "max_ms", "buckets": [...]}, ...}
+    static cJSON* GetJson();
+    // One compact line of p50/p95/max per stage
+    static void PrintStats();
+};
+
+#endif // AUDIO_LATENCY_H
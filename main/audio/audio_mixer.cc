@@ -0,0 +1,61 @@
+#include "audio_mixer.h"
+
+#include <algorithm>
+
+#define Q15_UNITY 32768
+
+AudioMixer::AudioMixer() {
+    for (int i = 0; i < kAudioMixerSourceCount; i++) {
+        gain_q15_[i] = Q15_UNITY;
+        duck_q15_[i] = Q15_UNITY;
+        level_q15_[i] = Q15_UNITY;
+    }
+}
+
+void AudioMixer::SetGain(AudioMixerSource source, int percent) {
+    gain_q15_[source] = std::clamp(percent, 0, 100) * Q15_UNITY / 100;
+}
+
+void AudioMixer::SetDucking(AudioMixerSource source, int percent) {
+    duck_q15_[source] = std::clamp(percent, 0, 100) * Q15_UNITY / 100;
+}
+
+void AudioMixer::Reset() {
+    for (int i = 0; i < kAudioMixerSourceCount; i++) {
+        level_q15_[i] = Q15_UNITY;
+    }
+}
+
+void AudioMixer::Mix(const int16_t* const inputs[kAudioMixerSourceCount], int16_t* out, size_t samples) {
+    if (samples == 0) {
+        return;
+    }
+
+    std::fill(out, out + samples, 0);
+    for (int i = 0; i < kAudioMixerSourceCount; i++) {
+        /* The strongest ducking among the other active sources */
+        int32_t target = Q15_UNITY;
+        for (int j = 0; j < kAudioMixerSourceCount; j++) {
+            if (j != i && inputs[j] != nullptr) {
+                target = std::min(target, duck_q15_[j]);
+            }
+        }
+        int32_t start = level_q15_[i];
+        level_q15_[i] = target;
+        if (inputs[i] == nullptr) {
+            continue;
+        }
+
+        /* Gain ramps linearly from the previous level to the target over this call */
+        const int16_t* in = inputs[i];
+        int32_t gain = gain_q15_[i];
+        int32_t step = (target - start) / int32_t(samples);
+        int32_t level = start;
+        for (size_t n = 0; n < samples; n++) {
+            int32_t g = (gain * level) >> 15;
+            int32_t value = out[n] + ((int32_t(in[n]) * g) >> 15);
+            out[n] = value > INT16_MAX ? INT16_MAX : value < -INT16_MAX ? -INT16_MAX : value;
+            level += step;
+        }
+    }
+}
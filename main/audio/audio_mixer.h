@@ -0,0 +1,42 @@
+#ifndef AUDIO_MIXER_H
+#define AUDIO_MIXER_H
+
+#include <cstddef>
+#include <cstdint>
+
+/*
+ * Fixed-point mixer in front of the codec output.
+ *
+ * Every source has its own gain. A source can duck the others while it is
+ * active (e.g. a notification over speech); the duck level ramps across one
+ * mix call, so starting or ending a cue does not click. Gains are Q15
+ * (32768 = unity), the sum saturates to int16.
+ *
+ * Plain C++, owned by the audio output task, not thread safe.
+ */
+
+enum AudioMixerSource {
+    kAudioMixerSpeech,  // Decoded server audio
+    kAudioMixerCue,     // Local sounds
+    kAudioMixerSourceCount,
+};
+
+class AudioMixer {
+public:
+    AudioMixer();
+
+    void SetGain(AudioMixerSource source, int percent);
+    // While source is active, every other source is attenuated to percent
+    void SetDucking(AudioMixerSource source, int percent);
+
+    // inputs[source] is nullptr for a source with nothing to play, each other input holds samples
+    void Mix(const int16_t* const inputs[kAudioMixerSourceCount], int16_t* out, size_t samples);
+    void Reset();
+
+private:
+    int32_t gain_q15_[kAudioMixerSourceCount];
+    int32_t duck_q15_[kAudioMixerSourceCount];
+    int32_t level_q15_[kAudioMixerSourceCount];  // Current duck level of each source
+};
+
+#endif // AUDIO_MIXER_H
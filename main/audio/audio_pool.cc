@@ -0,0 +1,193 @@
+#include "audio_pool.h"
+#include "audio_service.h"
+
+#include <new>
+#include <utility>
+#include <esp_log.h>
+#include <freertos/FreeRTOS.h>
+
+#define TAG "AudioPool"
+
+// Queued items plus the ones held by the network, codec and output tasks
+// The queues are counted at the default frame duration, shorter frames may spill to the heap
+#define PACKET_POOL_SLOTS (MAX_DECODE_QUEUE_MS / OPUS_FRAME_DURATION_MS + JITTER_BUFFER_MAX_PACKETS + MAX_SEND_QUEUE_MS / OPUS_FRAME_DURATION_MS + 4)
+#if CONFIG_USE_UPLINK_SILENCE_SUPPRESSION
+#define TASK_POOL_SLOTS (MAX_ENCODE_TASKS_IN_QUEUE + MAX_PLAYBACK_TASKS_IN_QUEUE + MAX_CUE_TASKS_IN_QUEUE + UPLINK_PREROLL_FRAMES + 4)
+#else
+#define TASK_POOL_SLOTS (MAX_ENCODE_TASKS_IN_QUEUE + MAX_PLAYBACK_TASKS_IN_QUEUE + MAX_CUE_TASKS_IN_QUEUE + 4)
+#endif
+
+namespace {
+
+template <size_t ObjectSize, size_t Slots>
+class SlabPool {
+    static constexpr size_t kAlign = alignof(std::max_align_t);
+    static constexpr size_t kStride = (ObjectSize + kAlign - 1) & ~(kAlign - 1);
+    static_assert(Slots <= UINT16_MAX, "SlabPool slot index is 16-bit");
+
+public:
+    SlabPool() {
+        for (size_t i = 0; i < Slots; i++) {
+            free_[i] = Slots - 1 - i;
+        }
+    }
+
+    void* Allocate(size_t size) {
+        void* ptr = nullptr;
+        portENTER_CRITICAL(&lock_);
+        if (size <= ObjectSize && free_count_ > 0) {
+            ptr = &storage_[free_[--free_count_] * kStride];
+            in_use_++;
+            if (in_use_ > high_water_) {
+                high_water_ = in_use_;
+            }
+        } else {
+            fallbacks_++;
+        }
+        portEXIT_CRITICAL(&lock_);
+        return ptr != nullptr ? ptr : ::operator new(size);
+    }
+
+    void Free(void* ptr) {
+        auto p = static_cast<uint8_t*>(ptr);
+        if (p < storage_ || p >= storage_ + sizeof(storage_)) {
+            ::operator delete(ptr);
+            return;
+        }
+        portENTER_CRITICAL(&lock_);
+        free_[free_count_++] = (p - storage_) / kStride;
+        in_use_--;
+        portEXIT_CRITICAL(&lock_);
+    }
+
+    AudioPoolStats stats() {
+        portENTER_CRITICAL(&lock_);
+        AudioPoolStats stats = { Slots, in_use_, high_water_, fallbacks_ };
+        portEXIT_CRITICAL(&lock_);
+        return stats;
+    }
+
+private:
+    alignas(kAlign) uint8_t storage_[kStride * Slots];
+    uint16_t free_[Slots];
+    uint16_t free_count_ = Slots;
+    uint16_t in_use_ = 0;
+    uint16_t high_water_ = 0;
+    uint32_t fallbacks_ = 0;
+    portMUX_TYPE lock_ = portMUX_INITIALIZER_UNLOCKED;
+};
+
+template <typename T, size_t Slots>
+class BufferPool {
+public:
+    std::vector<T> Acquire() {
+        std::vector<T> buffer;
+        portENTER_CRITICAL(&lock_);
+        if (count_ > 0) {
+            // Moving into an empty vector never touches the heap
+            buffer = std::move(buffers_[--count_]);
+        } else {
+            fallbacks_++;
+        }
+        portEXIT_CRITICAL(&lock_);
+        return buffer;
+    }
+
+    void Release(std::vector<T>&& buffer) {
+        if (buffer.capacity() == 0) {
+            return;
+        }
+        buffer.clear();
+        portENTER_CRITICAL(&lock_);
+        if (count_ < Slots) {
+            buffers_[count_++] = std::move(buffer);
+            if (count_ > high_water_) {
+                high_water_ = count_;
+            }
+        }
+        portEXIT_CRITICAL(&lock_);
+        // A buffer the pool had no room for is freed by the caller, outside the critical section
+    }
+
+    AudioPoolStats stats() {
+        portENTER_CRITICAL(&lock_);
+        AudioPoolStats stats = { Slots, count_, high_water_, fallbacks_ };
+        portEXIT_CRITICAL(&lock_);
+        return stats;
+    }
+
+private:
+    std::vector<T> buffers_[Slots];
+    uint16_t count_ = 0;
+    uint16_t high_water_ = 0;
+    uint32_t fallbacks_ = 0;
+    portMUX_TYPE lock_ = portMUX_INITIALIZER_UNLOCKED;
+};
+
+SlabPool<sizeof(AudioStreamPacket), PACKET_POOL_SLOTS> s_packet_pool;
+SlabPool<sizeof(AudioTask), TASK_POOL_SLOTS> s_task_pool;
+BufferPool<uint8_t, PACKET_POOL_SLOTS> s_payload_pool;
+BufferPool<int16_t, TASK_POOL_SLOTS> s_pcm_pool;
+
+} // namespace
+
+void* AudioPool::AllocatePacket(size_t size) {
+    return s_packet_pool.Allocate(size);
+}
+
+void AudioPool::FreePacket(void* ptr) {
+    s_packet_pool.Free(ptr);
+}
+
+void* AudioPool::AllocateTask(size_t size) {
+    return s_task_pool.Allocate(size);
+}
+
+void AudioPool::FreeTask(void* ptr) {
+    s_task_pool.Free(ptr);
+}
+
+std::vector<uint8_t> AudioPool::AcquirePayload() {
+    return s_payload_pool.Acquire();
+}
+
+void AudioPool::ReleasePayload(std::vector<uint8_t>&& buffer) {
+    s_payload_pool.Release(std::move(buffer));
+}
+
+std::vector<int16_t> AudioPool::AcquirePcm() {
+    return s_pcm_pool.Acquire();
+}
+
+void AudioPool::ReleasePcm(std::vector<int16_t>&& buffer) {
+    s_pcm_pool.Release(std::move(buffer));
+}
+
+AudioPoolStats AudioPool::GetPacketStats() {
+    return s_packet_pool.stats();
+}
+
+AudioPoolStats AudioPool::GetTaskStats() {
+    return s_task_pool.stats();
+}
+
+AudioPoolStats AudioPool::GetPayloadStats() {
+    return s_payload_pool.stats();
+}
+
+AudioPoolStats AudioPool::GetPcmStats() {
+    return s_pcm_pool.stats();
+}
+
+void AudioPool::PrintStats() {
+    auto packet = GetPacketStats();
+    auto task = GetTaskStats();
+    auto payload = GetPayloadStats();
+    auto pcm = GetPcmStats();
+    ESP_LOGI(TAG, "packets %u/%u peak %u heap %lu, tasks %u/%u peak %u heap %lu",
+        packet.in_use, packet.capacity, packet.high_water, packet.fallbacks,
+        task.in_use, task.capacity, task.high_water, task.fallbacks);
+    ESP_LOGI(TAG, "idle payloads %u peak %u miss %lu, idle pcm %u peak %u miss %lu",
+        payload.in_use, payload.high_water, payload.fallbacks,
+        pcm.in_use, pcm.high_water, pcm.fallbacks);
+}
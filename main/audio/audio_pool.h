@@ -0,0 +1,47 @@
+#ifndef AUDIO_POOL_H
+#define AUDIO_POOL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/*
+ * Fixed-size pools for the objects that flow through the audio queues.
+ *
+ * AudioStreamPacket and AudioTask objects come from static slabs sized from
+ * the MAX_*_IN_QUEUE limits (class operator new / delete, so std::unique_ptr
+ * is the RAII handle). Their payload / PCM vectors are recycled with their
+ * capacity on destruction and handed out again by AcquirePayload() /
+ * AcquirePcm(), so steady-state streaming does not touch the heap.
+ * A pool that runs dry falls back to the heap and counts it.
+ */
+
+// For the buffer pools in_use counts idle buffers held for reuse
+struct AudioPoolStats {
+    uint16_t capacity;
+    uint16_t in_use;
+    uint16_t high_water;
+    uint32_t fallbacks;
+};
+
+class AudioPool {
+public:
+    static void* AllocatePacket(size_t size);
+    static void FreePacket(void* ptr);
+    static void* AllocateTask(size_t size);
+    static void FreeTask(void* ptr);
+
+    // Empty vectors that keep the capacity of a previously released buffer
+    static std::vector<uint8_t> AcquirePayload();
+    static void ReleasePayload(std::vector<uint8_t>&& buffer);
+    static std::vector<int16_t> AcquirePcm();
+    static void ReleasePcm(std::vector<int16_t>&& buffer);
+
+    static AudioPoolStats GetPacketStats();
+    static AudioPoolStats GetTaskStats();
+    static AudioPoolStats GetPayloadStats();
+    static AudioPoolStats GetPcmStats();
+    static void PrintStats();
+};
+
+#endif // AUDIO_POOL_H
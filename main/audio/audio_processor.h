@@ -19,7 +19,11 @@ public:
     virtual bool IsRunning() = 0;
     virtual void OnOutput(std::function<void(std::vector<int16_t>&& data)> callback) = 0;
     virtual void OnVadStateChange(std::function<void(bool speaking)> callback) = 0;
+    // False while no VAD runs (e.g. disabled for device AEC), speech is then never reported
+    virtual bool IsVadRunning() = 0;
     virtual size_t GetFeedSize() = 0;
+    // Output frame size, only changed while the processor is stopped
+    virtual void SetFrameDuration(int frame_duration_ms) = 0;
     virtual void EnableDeviceAec(bool enable) = 0;
 };
 
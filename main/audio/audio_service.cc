@@ -1,6 +1,11 @@
 #include "audio_service.h"
 #include <esp_log.h>
+#include <esp_heap_caps.h>
 #include <cstring>
+#include <algorithm>
+
+#include "pcm_view.h"
+#include "pcm_kernels.h"
 
 #if CONFIG_USE_AUDIO_PROCESSOR
 #include "processors/afe_audio_processor.h"
@@ -17,6 +22,24 @@
 
 #define TAG "AudioService"
 
+#if CONFIG_FREERTOS_UNICORE || CONFIG_AUDIO_ENCODER_TASK_CORE < 0
+#define AUDIO_ENCODER_TASK_CORE tskNO_AFFINITY
+#else
+#define AUDIO_ENCODER_TASK_CORE CONFIG_AUDIO_ENCODER_TASK_CORE
+#endif
+
+#if CONFIG_FREERTOS_UNICORE || CONFIG_AUDIO_DECODER_TASK_CORE < 0
+#define AUDIO_DECODER_TASK_CORE tskNO_AFFINITY
+#else
+#define AUDIO_DECODER_TASK_CORE CONFIG_AUDIO_DECODER_TASK_CORE
+#endif
+
+#if CONFIG_USE_SOUND_PCM_CACHE
+#define SOUND_PCM_CACHE_SIZE (CONFIG_SOUND_PCM_CACHE_SIZE_KB * 1024)
+#else
+#define SOUND_PCM_CACHE_SIZE 0
+#endif
+
 
 AudioService::AudioService() {
     event_group_ = xEventGroupCreate();
@@ -35,12 +58,23 @@ void AudioService::Initialize(AudioCodec* codec) {
 
     /* Setup the audio codec */
     opus_decoder_ = std::make_unique<OpusDecoderWrapper>(codec->output_sample_rate(), 1, OPUS_FRAME_DURATION_MS);
-    opus_encoder_ = std::make_unique<OpusEncoderWrapper>(16000, 1, OPUS_FRAME_DURATION_MS);
-    opus_encoder_->SetComplexity(0);
+    opus_encoder_ = std::make_unique<OpusEncoderWrapper>(16000, 1, uplink_frame_duration_ms_);
+    opus_encoder_->SetComplexity(opus_complexity_.complexity());
+#if CONFIG_USE_UPLINK_SILENCE_SUPPRESSION
+    opus_encoder_->SetDtx(true);
+#endif
+    encoder_frame_duration_ms_ = uplink_frame_duration_ms_;
+    audio_send_queue_.set_limit(MAX_SEND_QUEUE_MS / uplink_frame_duration_ms_);
+    audio_testing_queue_.set_limit(AUDIO_TESTING_MAX_DURATION_MS / uplink_frame_duration_ms_);
+    audio_decode_queue_.set_limit(MAX_DECODE_QUEUE_MS / OPUS_FRAME_DURATION_MS);
+
+    mixer_.SetDucking(kAudioMixerCue, CUE_DUCKING_PERCENT);
 
     if (codec->input_sample_rate() != 16000) {
-        input_resampler_.Configure(codec->input_sample_rate(), 16000);
-        reference_resampler_.Configure(codec->input_sample_rate(), 16000);
+        if (!input_resampler_.Configure(codec->input_sample_rate(), 16000) ||
+            !reference_resampler_.Configure(codec->input_sample_rate(), 16000)) {
+            ESP_LOGE(TAG, "Cannot resample input from %d Hz", codec->input_sample_rate());
+        }
     }
 
 #if CONFIG_USE_AUDIO_PROCESSOR
@@ -109,12 +143,18 @@ void AudioService::Start() {
     }, "audio_output", 2048, this, 4, &audio_output_task_handle_);
 #endif
 
-    /* Start the opus codec task */
-    xTaskCreate([](void* arg) {
+    /* Start the opus encoder and decoder tasks, each owns its codec instance */
+    xTaskCreatePinnedToCore([](void* arg) {
+        AudioService* audio_service = (AudioService*)arg;
+        audio_service->OpusEncoderTask();
+        vTaskDelete(NULL);
+    }, "opus_encoder", 2048 * 12, this, CONFIG_AUDIO_ENCODER_TASK_PRIORITY, &opus_encoder_task_handle_, AUDIO_ENCODER_TASK_CORE);
+
+    xTaskCreatePinnedToCore([](void* arg) {
         AudioService* audio_service = (AudioService*)arg;
-        audio_service->OpusCodecTask();
+        audio_service->OpusDecoderTask();
         vTaskDelete(NULL);
-    }, "opus_codec", 2048 * 13, this, 2, &opus_codec_task_handle_);
+    }, "opus_decoder", 2048 * 6, this, CONFIG_AUDIO_DECODER_TASK_PRIORITY, &opus_decoder_task_handle_, AUDIO_DECODER_TASK_CORE);
 }
 
 void AudioService::Stop() {
@@ -124,12 +164,16 @@ void AudioService::Stop() {
         AS_EVENT_WAKE_WORD_RUNNING |
         AS_EVENT_AUDIO_PROCESSOR_RUNNING);
 
-    std::lock_guard<std::mutex> lock(audio_queue_mutex_);
-    audio_encode_queue_.clear();
-    audio_decode_queue_.clear();
-    audio_playback_queue_.clear();
-    audio_testing_queue_.clear();
-    audio_queue_cv_.notify_all();
+    audio_encode_queue_.Clear();
+    audio_decode_queue_.Clear();
+    audio_sound_queue_.Clear();
+    audio_cached_sound_queue_.Clear();
+    audio_cue_queue_.Clear();
+    audio_playback_queue_.Clear();
+    audio_testing_queue_.Clear();
+    NotifyTask(audio_output_task_handle_);
+    NotifyTask(opus_encoder_task_handle_);
+    NotifyTask(opus_decoder_task_handle_);
 }
 
 bool AudioService::ReadAudioData(std::vector<int16_t>& data, int sample_rate, int samples) {
@@ -140,30 +184,27 @@ bool AudioService::ReadAudioData(std::vector<int16_t>& data, int sample_rate, in
     }
 
     if (codec_->input_sample_rate() != sample_rate) {
-        data.resize(samples * codec_->input_sample_rate() / sample_rate * codec_->input_channels());
-        if (!codec_->InputData(data)) {
+        /* Scratch buffers persist across calls, nothing is allocated once they have grown */
+        capture_buffer_.resize(samples * codec_->input_sample_rate() / sample_rate * codec_->input_channels());
+        if (!codec_->InputData(capture_buffer_)) {
             return false;
         }
         if (codec_->input_channels() == 2) {
-            auto mic_channel = std::vector<int16_t>(data.size() / 2);
-            auto reference_channel = std::vector<int16_t>(data.size() / 2);
-            for (size_t i = 0, j = 0; i < mic_channel.size(); ++i, j += 2) {
-                mic_channel[i] = data[j];
-                reference_channel[i] = data[j + 1];
-            }
-            auto resampled_mic = std::vector<int16_t>(input_resampler_.GetOutputSamples(mic_channel.size()));
-            auto resampled_reference = std::vector<int16_t>(reference_resampler_.GetOutputSamples(reference_channel.size()));
-            input_resampler_.Process(mic_channel.data(), mic_channel.size(), resampled_mic.data());
-            reference_resampler_.Process(reference_channel.data(), reference_channel.size(), resampled_reference.data());
-            data.resize(resampled_mic.size() + resampled_reference.size());
-            for (size_t i = 0, j = 0; i < resampled_mic.size(); ++i, j += 2) {
-                data[j] = resampled_mic[i];
-                data[j + 1] = resampled_reference[i];
-            }
+            /* Resample each channel and write it straight back interleaved */
+            size_t frames = capture_buffer_.size() / 2;
+            size_t output_samples = input_resampler_.GetOutputSamples(frames);
+            mic_scratch_[0].resize(frames);
+            reference_scratch_[0].resize(frames);
+            mic_scratch_[1].resize(output_samples);
+            reference_scratch_[1].resize(output_samples);
+            pcm::Deinterleave(capture_buffer_.data(), mic_scratch_[0].data(), reference_scratch_[0].data(), frames);
+            input_resampler_.Process(mic_scratch_[0].data(), frames, mic_scratch_[1].data());
+            reference_resampler_.Process(reference_scratch_[0].data(), frames, reference_scratch_[1].data());
+            data.resize(output_samples * 2);
+            pcm::Interleave(mic_scratch_[1].data(), reference_scratch_[1].data(), data.data(), output_samples);
         } else {
-            auto resampled = std::vector<int16_t>(input_resampler_.GetOutputSamples(data.size()));
-            input_resampler_.Process(data.data(), data.size(), resampled.data());
-            data = std::move(resampled);
+            data.resize(input_resampler_.GetOutputSamples(capture_buffer_.size()));
+            input_resampler_.Process(capture_buffer_.data(), capture_buffer_.size(), data.data());
         }
     } else {
         data.resize(samples * codec_->input_channels());
@@ -188,7 +229,12 @@ bool AudioService::ReadAudioData(std::vector<int16_t>& data, int sample_rate, in
 }
 
 void AudioService::AudioInputTask() {
+    /* Reused for every read, refilled from the pool when a consumer takes it */
+    std::vector<int16_t> data;
     while (true) {
+        if (data.capacity() == 0) {
+            data = AudioPool::AcquirePcm();
+        }
         EventBits_t bits = xEventGroupWaitBits(event_group_, AS_EVENT_AUDIO_TESTING_RUNNING |
             AS_EVENT_WAKE_WORD_RUNNING | AS_EVENT_AUDIO_PROCESSOR_RUNNING,
             pdFALSE, pdFALSE, portMAX_DELAY);
@@ -204,22 +250,15 @@ void AudioService::AudioInputTask() {
 
         /* Used for audio testing in NetworkConfiguring mode by clicking the BOOT button */
         if (bits & AS_EVENT_AUDIO_TESTING_RUNNING) {
-            if (audio_testing_queue_.size() >= AUDIO_TESTING_MAX_DURATION_MS / OPUS_FRAME_DURATION_MS) {
+            if (audio_testing_queue_.full()) {
                 ESP_LOGW(TAG, "Audio testing queue is full, stopping audio testing");
                 EnableAudioTesting(false);
                 continue;
             }
-            std::vector<int16_t> data;
-            int samples = OPUS_FRAME_DURATION_MS * 16000 / 1000;
+            int samples = uplink_frame_duration_ms_ * 16000 / 1000;
             if (ReadAudioData(data, 16000, samples)) {
                 // If input channels is 2, we need to fetch the left channel data
-                if (codec_->input_channels() == 2) {
-                    auto mono_data = std::vector<int16_t>(data.size() / 2);
-                    for (size_t i = 0, j = 0; i < mono_data.size(); ++i, j += 2) {
-                        mono_data[i] = data[j];
-                    }
-                    data = std::move(mono_data);
-                }
+                KeepChannelInPlace(data, codec_->input_channels(), 0);
                 PushTaskToEncodeQueue(kAudioTaskTypeEncodeToTestingQueue, std::move(data));
                 continue;
             }
@@ -227,7 +266,6 @@ void AudioService::AudioInputTask() {
 
         /* Feed the wake word */
         if (bits & AS_EVENT_WAKE_WORD_RUNNING) {
-            std::vector<int16_t> data;
             int samples = wake_word_->GetFeedSize();
             if (samples > 0) {
                 if (ReadAudioData(data, 16000, samples)) {
@@ -239,10 +277,12 @@ void AudioService::AudioInputTask() {
 
         /* Feed the audio processor */
         if (bits & AS_EVENT_AUDIO_PROCESSOR_RUNNING) {
-            std::vector<int16_t> data;
             int samples = audio_processor_->GetFeedSize();
             if (samples > 0) {
                 if (ReadAudioData(data, 16000, samples)) {
+#if CONFIG_USE_AUDIO_LATENCY_TRACE
+                    TraceProcessorFeed(samples);
+#endif
                     audio_processor_->Feed(std::move(data));
                     continue;
                 }
@@ -257,118 +297,518 @@ void AudioService::AudioInputTask() {
 }
 
 void AudioService::AudioOutputTask() {
-    while (true) {
-        std::unique_lock<std::mutex> lock(audio_queue_mutex_);
-        audio_queue_cv_.wait(lock, [this]() { return !audio_playback_queue_.empty() || service_stopped_; });
-        if (service_stopped_) {
-            break;
+    /* Short slices let a cue start mid frame and bound how long an abort waits for the codec write in progress */
+    const size_t slice = codec_->output_sample_rate() * PLAYBACK_SLICE_MS / 1000;
+
+    while (!service_stopped_) {
+        if (int64_t requested = playback_abort_us_.exchange(0)) {
+            /* Ramp the frames being played down to zero behind the DMA ring, the queued audio is already dropped */
+            if (MixSlice(codec_->output_sample_rate() * PLAYBACK_FADE_MS / 1000) > 0) {
+                pcm::FadeOut(output_slice_.data(), output_slice_.size());
+                codec_->OutputData(output_slice_);
+                last_output_us_ = esp_timer_get_time();
+            }
+            FinishPlaybackAbort(requested);
+            continue;
         }
 
-        auto task = std::move(audio_playback_queue_.front());
-        audio_playback_queue_.pop_front();
-        audio_queue_cv_.notify_all();
-        lock.unlock();
+        if (output_warm_up_requested_.exchange(false) && !codec_->output_enabled()) {
+            EnableOutputPower();
+        }
 
-        if (!codec_->output_enabled()) {
-            esp_timer_stop(audio_power_timer_);
-            esp_timer_start_periodic(audio_power_timer_, AUDIO_POWER_CHECK_INTERVAL_MS * 1000);
-            codec_->EnableOutput(true);
+        RefillMixerInputs();
+        bool speech_playing = mixer_inputs_[kAudioMixerSpeech].remaining() > 0;
+        if (speech_playing_ && !speech_playing) {
+            /* Nothing decoded is left behind the frame that just finished */
+            speech_starved_ = true;
+            NotifyTask(opus_decoder_task_handle_);
         }
-        codec_->OutputData(task->pcm);
+        speech_playing_ = speech_playing;
 
-        /* Update the last output time */
-        last_output_time_ = std::chrono::steady_clock::now();
-        debug_statistics_.playback_count++;
+        size_t samples = MixSlice(slice);
+        if (samples == 0) {
+            ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+            continue;
+        }
 
-#if CONFIG_USE_SERVER_AEC
-        /* Record the timestamp for server AEC */
-        if (task->timestamp > 0) {
-            lock.lock();
-            timestamp_queue_.push_back(task->timestamp);
+        if (!codec_->output_enabled()) {
+            EnableOutputPower();
         }
+        codec_->OutputData(output_slice_);
+        last_output_us_ = esp_timer_get_time();
+        NoteOutputDemand(last_output_us_);
+
+        if (mixer_inputs_[kAudioMixerSpeech].remaining() > 0) {
+            if (int64_t requested = speech_requested_us_.exchange(0)) {
+                ESP_LOGI(TAG, "Speech output started %lld ms after tts start (output was %s)",
+                    (last_output_us_ - requested) / 1000, speech_requested_warm_ ? "already on" : "off");
+#if CONFIG_USE_AUDIO_LATENCY_TRACE
+                AudioLatency::Record(kLatencyFirstSample, requested, last_output_us_);
 #endif
+            }
+        }
+        if (mixer_inputs_[kAudioMixerCue].remaining() > 0) {
+            if (int64_t requested = sound_requested_us_.exchange(0)) {
+                ESP_LOGI(TAG, "Sound output started %lld ms after request (%s)",
+                    (last_output_us_ - requested) / 1000, cue_from_cache_ ? "cached" : "decoded");
+            }
+        }
+        for (int i = 0; i < kAudioMixerSourceCount; i++) {
+            auto& input = mixer_inputs_[i];
+            if (input.remaining() == 0) {
+                continue;
+            }
+            input.offset += samples;
+            if (i == kAudioMixerSpeech && input.remaining() == 0) {
+                CompleteSpeechFrame(*input.task);
+            }
+        }
     }
 
     ESP_LOGW(TAG, "Audio output task stopped");
 }
 
-void AudioService::OpusCodecTask() {
-    while (true) {
-        std::unique_lock<std::mutex> lock(audio_queue_mutex_);
-        audio_queue_cv_.wait(lock, [this]() {
-            return service_stopped_ ||
-                (!audio_encode_queue_.empty() && audio_send_queue_.size() < MAX_SEND_PACKETS_IN_QUEUE) ||
-                (!audio_decode_queue_.empty() && audio_playback_queue_.size() < MAX_PLAYBACK_TASKS_IN_QUEUE);
-        });
-        if (service_stopped_) {
+void AudioService::RefillMixerInputs() {
+    /* Busy while frames move from the queues into the mixer, settled below */
+    mixer_busy_ = true;
+    auto& speech = mixer_inputs_[kAudioMixerSpeech];
+    while (speech.remaining() == 0) {
+        speech.offset = 0;
+        bool was_full = audio_playback_queue_.full();
+        bool popped = audio_playback_queue_.Pop(speech.task);
+        if (was_full) {
+            /* The decoder task may be waiting for room in the playback queue */
+            NotifyTask(opus_decoder_task_handle_);
+        }
+        if (!popped) {
+            speech.task.reset();
+            break;
+        }
+    }
+
+    auto& cue = mixer_inputs_[kAudioMixerCue];
+    while (cue.remaining() == 0) {
+        cue.offset = 0;
+        if (PopCachedSoundChunk(cue.task)) {
+            cue_from_cache_ = true;
+            continue;
+        }
+        bool was_full = audio_cue_queue_.full();
+        bool popped = audio_cue_queue_.Pop(cue.task);
+        if (was_full) {
+            NotifyTask(opus_decoder_task_handle_);
+        }
+        if (!popped) {
+            cue.task.reset();
             break;
         }
+        cue_from_cache_ = false;
+    }
+    mixer_busy_ = speech.remaining() > 0 || cue.remaining() > 0;
+}
 
-        /* Decode the audio from decode queue */
-        if (!audio_decode_queue_.empty() && audio_playback_queue_.size() < MAX_PLAYBACK_TASKS_IN_QUEUE) {
-            auto packet = std::move(audio_decode_queue_.front());
-            audio_decode_queue_.pop_front();
-            audio_queue_cv_.notify_all();
-            lock.unlock();
+size_t AudioService::MixSlice(size_t max_samples) {
+    const int16_t* inputs[kAudioMixerSourceCount] = {};
+    size_t samples = max_samples;
+    bool active = false;
+    for (int i = 0; i < kAudioMixerSourceCount; i++) {
+        auto& input = mixer_inputs_[i];
+        if (input.remaining() > 0) {
+            inputs[i] = input.task->pcm.data() + input.offset;
+            samples = std::min(samples, input.remaining());
+            active = true;
+        }
+    }
+    if (!active) {
+        return 0;
+    }
+    output_slice_.resize(samples);
+    mixer_.Mix(inputs, output_slice_.data(), samples);
+    return samples;
+}
 
-            auto task = std::make_unique<AudioTask>();
-            task->type = kAudioTaskTypeDecodeToPlaybackQueue;
-            task->timestamp = packet->timestamp;
+void AudioService::CompleteSpeechFrame(const AudioTask& task) {
+    /* The first frame of a marked sentence, or a later one if that packet was lost, starts it */
+    if (task.decode_index != 0) {
+        uint64_t mark = sentence_mark_.load();
+        uint32_t sentence = uint32_t(mark >> 32);
+        if (sentence != started_sentence_.load() && task.decode_index >= uint32_t(mark)) {
+            sentence_start_ms_ = playback_position_ms_.load();
+            started_sentence_ = sentence;
+        }
+    }
+    playback_position_ms_ += task.pcm.size() * 1000 / codec_->output_sample_rate();
+    debug_statistics_.playback_count++;
+#if CONFIG_USE_AUDIO_LATENCY_TRACE
+    if (task.trace.origin_us != 0) {
+        AudioLatency::Record(kLatencyPlayback, task.trace.stage_us, last_output_us_);
+        AudioLatency::Record(kLatencyDownlink, task.trace.origin_us, last_output_us_);
+    }
+#endif
 
-            SetDecodeSampleRate(packet->sample_rate, packet->frame_duration);
-            if (opus_decoder_->Decode(std::move(packet->payload), task->pcm)) {
-                // Resample if the sample rate is different
-                if (opus_decoder_->sample_rate() != codec_->output_sample_rate()) {
-                    int target_size = output_resampler_.GetOutputSamples(task->pcm.size());
-                    std::vector<int16_t> resampled(target_size);
-                    output_resampler_.Process(task->pcm.data(), task->pcm.size(), resampled.data());
-                    task->pcm = std::move(resampled);
-                }
+#if CONFIG_USE_SERVER_AEC
+    /* Record the timestamp for server AEC */
+    if (task.timestamp > 0) {
+        std::lock_guard<std::mutex> lock(timestamp_mutex_);
+        timestamp_queue_.push_back(task.timestamp);
+    }
+#endif
+}
 
-                lock.lock();
-                audio_playback_queue_.push_back(std::move(task));
-                audio_queue_cv_.notify_all();
-            } else {
-                ESP_LOGE(TAG, "Failed to decode audio");
-                lock.lock();
+void AudioService::FinishPlaybackAbort(int64_t requested_us) {
+    /* Frames in progress, a cached sound included, are dropped with the rest */
+    for (auto& input : mixer_inputs_) {
+        input.task.reset();
+        input.offset = 0;
+    }
+    playing_cached_sound_ = nullptr;
+    mixer_.Reset();
+    speech_playing_ = false;
+    mixer_busy_ = false;
+
+    /* The last written sample is heard once the DMA ring ahead of it drains */
+    int64_t dma_us = int64_t(AUDIO_CODEC_DMA_DESC_NUM) * AUDIO_CODEC_DMA_FRAME_NUM * 1000000 / codec_->output_sample_rate();
+    int64_t silent_us = std::max(esp_timer_get_time(), last_output_us_ + dma_us);
+    ESP_LOGI(TAG, "Playback aborted, silent %lld ms after request", (silent_us - requested_us) / 1000);
+#if CONFIG_USE_AUDIO_LATENCY_TRACE
+    AudioLatency::Record(kLatencyAbort, requested_us, silent_us);
+#endif
+}
+
+void AudioService::AbortPlayback() {
+    int64_t requested = esp_timer_get_time();
+    ResetDecoder();
+    /* Raised after the queues are dropped, so the output task cannot pick up old audio once it acted on it */
+    int64_t idle = 0;
+    playback_abort_us_.compare_exchange_strong(idle, requested);
+    NotifyTask(audio_output_task_handle_);
+}
+
+void AudioService::OpusDecoderTask() {
+    while (!service_stopped_) {
+        if (decoder_reset_pending_.exchange(false)) {
+            opus_decoder_->ResetState();
+            jitter_buffer_.Reset();
+            playing_sound_ = nullptr;
+            if (cue_decoder_) {
+                cue_decoder_->ResetState();
+            }
+            auto stats = jitter_buffer_.stats();
+            if (stats.underruns || stats.late || stats.concealed) {
+                ESP_LOGI(TAG, "Jitter buffer: underruns %lu, late %lu, concealed %lu, jitter %lums, depth %lu",
+                    stats.underruns, stats.late, stats.concealed, stats.jitter_ms, stats.target_depth);
             }
-            debug_statistics_.decode_count++;
         }
-        
-        /* Encode the audio to send queue */
-        if (!audio_encode_queue_.empty() && audio_send_queue_.size() < MAX_SEND_PACKETS_IN_QUEUE) {
-            auto task = std::move(audio_encode_queue_.front());
-            audio_encode_queue_.pop_front();
-            audio_queue_cv_.notify_all();
-            lock.unlock();
-
-            auto packet = std::make_unique<AudioStreamPacket>();
-            packet->frame_duration = OPUS_FRAME_DURATION_MS;
-            packet->sample_rate = 16000;
-            packet->timestamp = task->timestamp;
-            if (!opus_encoder_->Encode(std::move(task->pcm), packet->payload)) {
-                ESP_LOGE(TAG, "Failed to encode audio");
+        /* An empty jitter buffer is only an underrun once playback has nothing left either */
+        if (speech_starved_.exchange(false) && audio_playback_queue_.empty()) {
+            jitter_buffer_.Underrun();
+        }
+
+        /* Local sounds have their own decoder, so they never disturb the speech decoder state */
+        bool cue_decoded = DecodeCueFrame();
+
+        /* Move arrivals into the jitter buffer as soon as they come, the arrival time feeds the jitter estimate */
+        std::unique_ptr<AudioStreamPacket> packet;
+        /* Counted as held before a packet leaves the decode queue, so IsIdle() never misses it in between */
+        decoder_held_ = jitter_buffer_.size() + 1;
+        while (!jitter_buffer_.full() && PopPacketToDecode(packet)) {
+            jitter_buffer_.Push(std::move(packet), esp_timer_get_time() / 1000);
+            decoder_held_ = jitter_buffer_.size() + 1;
+        }
+        decoder_held_ = jitter_buffer_.size();
+        if (audio_playback_queue_.full()) {
+            if (!cue_decoded) {
+                ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+            }
+            continue;
+        }
+
+        auto status = jitter_buffer_.Pop(esp_timer_get_time() / 1000, packet);
+        if (status == kJitterBufferEmpty) {
+            if (!cue_decoded) {
+                ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+            }
+            continue;
+        } else if (status == kJitterBufferBuffering) {
+            /* Woken early by a push, otherwise re-check when a missing frame may be overdue */
+            if (!cue_decoded) {
+                ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(10));
+            }
+            continue;
+        }
+
+        /* The frame being decoded stays counted until it is in the playback queue */
+        decoder_held_ = jitter_buffer_.size() + 1;
+
+        auto task = std::make_unique<AudioTask>();
+        task->type = kAudioTaskTypeDecodeToPlaybackQueue;
+        task->pcm = AudioPool::AcquirePcm();
+
+        bool decoded;
+#if CONFIG_USE_AUDIO_LATENCY_TRACE
+        int64_t decode_start_us = esp_timer_get_time();
+#endif
+        if (status == kJitterBufferPacket) {
+            task->timestamp = packet->timestamp;
+            task->decode_index = packet->decode_index;
+#if CONFIG_USE_AUDIO_LATENCY_TRACE
+            task->trace.origin_us = packet->trace.origin_us;
+            AudioLatency::Record(kLatencyJitter, packet->trace.origin_us, decode_start_us);
+#endif
+            SetDecodeSampleRate(packet->sample_rate, packet->frame_duration);
+            decoded = opus_decoder_->Decode(std::move(packet->payload), task->pcm);
+        } else {
+            task->timestamp = 0;
+            decoded = ConcealLostFrame(task->pcm);
+        }
+
+        if (decoded) {
+#if CONFIG_USE_AUDIO_LATENCY_TRACE
+            int64_t resample_start_us = esp_timer_get_time();
+            AudioLatency::Record(kLatencyDecode, decode_start_us, resample_start_us);
+#endif
+            // Resample if the sample rate is different
+            if (opus_decoder_->sample_rate() != codec_->output_sample_rate()) {
+                int target_size = output_resampler_.GetOutputSamples(task->pcm.size());
+                auto resampled = AudioPool::AcquirePcm();
+                resampled.resize(target_size);
+                output_resampler_.Process(task->pcm.data(), task->pcm.size(), resampled.data());
+                task->pcm.swap(resampled);
+                AudioPool::ReleasePcm(std::move(resampled));
+            }
+#if CONFIG_USE_AUDIO_LATENCY_TRACE
+            task->trace.stage_us = esp_timer_get_time();
+            AudioLatency::Record(kLatencyResample, resample_start_us, task->trace.stage_us);
+#endif
+
+            /* A reset requested while decoding drops the frame, it belongs to the old stream */
+            if (decoder_reset_pending_) {
                 continue;
             }
+            /* Cannot fail, this task is the only producer and checked for room */
+            audio_playback_queue_.Push(task);
+            NotifyTask(audio_output_task_handle_);
+        } else {
+            ESP_LOGE(TAG, "Failed to decode audio");
+        }
+        debug_statistics_.decode_count++;
+    }
 
-            if (task->type == kAudioTaskTypeEncodeToSendQueue) {
-                {
-                    std::lock_guard<std::mutex> lock(audio_queue_mutex_);
-                    audio_send_queue_.push_back(std::move(packet));
-                }
-                if (callbacks_.on_send_queue_available) {
-                    callbacks_.on_send_queue_available();
-                }
-            } else if (task->type == kAudioTaskTypeEncodeToTestingQueue) {
-                std::lock_guard<std::mutex> lock(audio_queue_mutex_);
-                audio_testing_queue_.push_back(std::move(packet));
+    ESP_LOGW(TAG, "Opus decoder task stopped");
+}
+
+bool AudioService::DecodeCueFrame() {
+    std::unique_ptr<AudioStreamPacket> packet;
+    bool new_sound;
+    if (audio_cue_queue_.full() || !PopSoundPacket(packet, new_sound)) {
+        return false;
+    }
+
+    if (!cue_decoder_ || cue_decoder_->sample_rate() != packet->sample_rate ||
+            cue_decoder_->duration_ms() != packet->frame_duration) {
+        cue_decoder_ = std::make_unique<OpusDecoderWrapper>(packet->sample_rate, 1, packet->frame_duration);
+        if (packet->sample_rate != codec_->output_sample_rate()) {
+            cue_resampler_.Configure(packet->sample_rate, codec_->output_sample_rate());
+        }
+    } else if (new_sound) {
+        /* The previous sound's decoder and filter state would bleed into this one's first samples */
+        cue_decoder_->ResetState();
+        cue_resampler_.Reset();
+    }
+
+    auto task = std::make_unique<AudioTask>();
+    task->type = kAudioTaskTypeDecodeToPlaybackQueue;
+    task->timestamp = 0;
+    task->pcm = AudioPool::AcquirePcm();
+    if (!cue_decoder_->Decode(std::move(packet->payload), task->pcm)) {
+        ESP_LOGE(TAG, "Failed to decode sound");
+        return true;
+    }
+    if (cue_decoder_->sample_rate() != codec_->output_sample_rate()) {
+        auto resampled = AudioPool::AcquirePcm();
+        resampled.resize(cue_resampler_.GetOutputSamples(task->pcm.size()));
+        cue_resampler_.Process(task->pcm.data(), task->pcm.size(), resampled.data());
+        task->pcm.swap(resampled);
+        AudioPool::ReleasePcm(std::move(resampled));
+    }
+
+    if (decoder_reset_pending_) {
+        return true;
+    }
+    /* Cannot fail, this task is the only producer and checked for room */
+    audio_cue_queue_.Push(task);
+    NotifyTask(audio_output_task_handle_);
+    return true;
+}
+
+bool AudioService::ConcealLostFrame(std::vector<int16_t>& pcm) {
+    /* An empty packet asks Opus for packet loss concealment */
+    if (opus_decoder_->Decode(std::vector<uint8_t>(), pcm) && !pcm.empty()) {
+        return true;
+    }
+    /* Keep the timeline with a silent frame if the decoder cannot conceal */
+    pcm.assign(opus_decoder_->sample_rate() * opus_decoder_->duration_ms() / 1000, 0);
+    return true;
+}
+
+void AudioService::OpusEncoderTask() {
+    while (!service_stopped_) {
+        /* Encode the audio to send queue */
+        std::unique_ptr<AudioTask> task;
+        if (audio_send_queue_.full() || !audio_encode_queue_.Pop(task)) {
+            ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+            continue;
+        }
+        if (auto waiter = encode_waiter_.exchange(nullptr)) {
+            xTaskNotifyGive(waiter);
+        }
+
+        int frame_duration = uplink_frame_duration_ms_;
+        if (encoder_frame_duration_ms_ != frame_duration) {
+            opus_encoder_ = std::make_unique<OpusEncoderWrapper>(16000, 1, frame_duration);
+            opus_encoder_->SetComplexity(opus_complexity_.complexity());
+#if CONFIG_USE_UPLINK_SILENCE_SUPPRESSION
+            opus_encoder_->SetDtx(true);
+#endif
+            encoder_frame_duration_ms_ = frame_duration;
+        }
+
+        auto packet = std::make_unique<AudioStreamPacket>();
+        packet->frame_duration = frame_duration;
+        packet->sample_rate = 16000;
+        packet->timestamp = task->timestamp;
+        packet->payload = AudioPool::AcquirePayload();
+        int64_t encode_start_us = esp_timer_get_time();
+        if (!opus_encoder_->Encode(std::move(task->pcm), packet->payload)) {
+            ESP_LOGE(TAG, "Failed to encode audio");
+            continue;
+        }
+        if (opus_complexity_.Update(esp_timer_get_time() - encode_start_us, frame_duration)) {
+            ESP_LOGI(TAG, "Opus encoder complexity set to %d, average encode time %lld us per %d ms frame",
+                opus_complexity_.complexity(), opus_complexity_.average_us(), frame_duration);
+            opus_encoder_->SetComplexity(opus_complexity_.complexity());
+        }
+#if CONFIG_USE_AUDIO_LATENCY_TRACE
+        packet->trace.origin_us = task->trace.origin_us;
+        packet->trace.stage_us = esp_timer_get_time();
+        AudioLatency::Record(kLatencyEncode, task->trace.stage_us, packet->trace.stage_us);
+#endif
+
+        if (task->type == kAudioTaskTypeEncodeToSendQueue) {
+            audio_send_queue_.Push(packet);
+            if (callbacks_.on_send_queue_available) {
+                callbacks_.on_send_queue_available();
             }
-            debug_statistics_.encode_count++;
-            lock.lock();
+        } else if (task->type == kAudioTaskTypeEncodeToTestingQueue) {
+            audio_testing_queue_.Push(packet);
         }
+        debug_statistics_.encode_count++;
     }
 
-    ESP_LOGW(TAG, "Opus codec task stopped");
+    ESP_LOGW(TAG, "Opus encoder task stopped");
+}
+
+bool AudioService::PopPacketToDecode(std::unique_ptr<AudioStreamPacket>& packet) {
+    if (audio_decode_queue_.Pop(packet)) {
+        if (auto waiter = decode_waiter_.exchange(nullptr)) {
+            xTaskNotifyGive(waiter);
+        }
+        return true;
+    }
+    /* Play back the recording once audio testing has stopped */
+    if (!(xEventGroupGetBits(event_group_) & AS_EVENT_AUDIO_TESTING_RUNNING)) {
+        return audio_testing_queue_.Pop(packet);
+    }
+    return false;
+}
+
+bool AudioService::PopSoundPacket(std::unique_ptr<AudioStreamPacket>& packet, bool& new_sound) {
+    const OggOpusIndex* sound = playing_sound_;
+    new_sound = false;
+    while (sound == nullptr || playing_sound_packet_ >= sound->size()) {
+        if (!audio_sound_queue_.Pop(sound)) {
+            playing_sound_ = nullptr;
+            return false;
+        }
+        playing_sound_packet_ = 0;
+        new_sound = true;
+    }
+    playing_sound_ = sound;
+
+    /* The decoder takes an owned payload, a pooled buffer keeps the copy off the heap */
+    const uint8_t* data = sound->packet_data(playing_sound_packet_);
+    packet = std::make_unique<AudioStreamPacket>();
+    packet->sample_rate = sound->sample_rate();
+    packet->frame_duration = sound->frame_duration_ms();
+    packet->payload = AudioPool::AcquirePayload();
+    packet->payload.assign(data, data + sound->packet_size(playing_sound_packet_));
+    playing_sound_packet_++;
+    return true;
+}
+
+bool AudioService::PopCachedSoundChunk(std::unique_ptr<AudioTask>& task) {
+    const CachedSound* sound = playing_cached_sound_;
+    while (sound == nullptr || playing_cached_sound_offset_ >= sound->samples) {
+        if (!audio_cached_sound_queue_.Pop(sound)) {
+            playing_cached_sound_ = nullptr;
+            return false;
+        }
+        playing_cached_sound_offset_ = 0;
+    }
+    playing_cached_sound_ = sound;
+
+    size_t chunk = codec_->output_sample_rate() * CACHED_SOUND_CHUNK_MS / 1000;
+    size_t samples = std::min(chunk, sound->samples - playing_cached_sound_offset_);
+    const int16_t* data = sound->pcm + playing_cached_sound_offset_;
+    task = std::make_unique<AudioTask>();
+    task->type = kAudioTaskTypeDecodeToPlaybackQueue;
+    task->timestamp = 0;
+    task->pcm = AudioPool::AcquirePcm();
+    task->pcm.assign(data, data + samples);
+    playing_cached_sound_offset_ += samples;
+    return true;
+}
+
+#if CONFIG_USE_AUDIO_LATENCY_TRACE
+void AudioService::TraceProcessorFeed(size_t samples) {
+    std::lock_guard<std::mutex> lock(trace_mutex_);
+    trace_fed_samples_ += samples;
+    trace_feeds_[trace_feed_index_] = { trace_fed_samples_, esp_timer_get_time() };
+    trace_feed_index_ = (trace_feed_index_ + 1) % (sizeof(trace_feeds_) / sizeof(trace_feeds_[0]));
+}
+
+int64_t AudioService::TraceProcessorOutput(size_t samples) {
+    /* Capture time of the feed holding the last output sample, 0 if it is no longer tracked */
+    std::lock_guard<std::mutex> lock(trace_mutex_);
+    trace_output_samples_ += samples;
+    int64_t capture_us = 0;
+    uint64_t best_end = UINT64_MAX;
+    for (const auto& feed : trace_feeds_) {
+        if (feed.capture_us != 0 && feed.end_sample >= trace_output_samples_ && feed.end_sample < best_end) {
+            best_end = feed.end_sample;
+            capture_us = feed.capture_us;
+        }
+    }
+    return capture_us;
+}
+#endif
+
+void AudioService::NotifyTask(TaskHandle_t task) {
+    if (task != nullptr) {
+        xTaskNotifyGive(task);
+    }
+}
+
+void AudioService::WaitForSpace(std::atomic<TaskHandle_t>& waiter, const std::function<bool()>& has_space) {
+    while (!has_space() && !service_stopped_) {
+        waiter.store(xTaskGetCurrentTaskHandle());
+        /* Check again, the consumer may have popped before we registered */
+        if (has_space()) {
+            waiter.store(nullptr);
+            break;
+        }
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(100));
+    }
 }
 
 void AudioService::SetDecodeSampleRate(int sample_rate, int frame_duration) {
@@ -390,53 +830,157 @@ void AudioService::PushTaskToEncodeQueue(AudioTaskType type, std::vector<int16_t
     auto task = std::make_unique<AudioTask>();
     task->type = type;
     task->pcm = std::move(pcm);
-    
-    /* Push the task to the encode queue */
-    std::unique_lock<std::mutex> lock(audio_queue_mutex_);
 
     /* If the task is to send queue, we need to set the timestamp */
-    if (type == kAudioTaskTypeEncodeToSendQueue && !timestamp_queue_.empty()) {
-        if (timestamp_queue_.size() <= MAX_TIMESTAMPS_IN_QUEUE) {
-            task->timestamp = timestamp_queue_.front();
-        } else {
-            ESP_LOGW(TAG, "Timestamp queue (%u) is full, dropping timestamp", timestamp_queue_.size());
+    if (type == kAudioTaskTypeEncodeToSendQueue) {
+        std::lock_guard<std::mutex> lock(timestamp_mutex_);
+        if (!timestamp_queue_.empty()) {
+            if (timestamp_queue_.size() <= MAX_TIMESTAMPS_IN_QUEUE) {
+                task->timestamp = timestamp_queue_.front();
+            } else {
+                ESP_LOGW(TAG, "Timestamp queue (%u) is full, dropping timestamp", timestamp_queue_.size());
+            }
+            timestamp_queue_.pop_front();
+        }
+#if CONFIG_USE_AUDIO_LATENCY_TRACE
+        task->trace.origin_us = TraceProcessorOutput(task->pcm.size());
+        task->trace.stage_us = esp_timer_get_time();
+        AudioLatency::Record(kLatencyProcess, task->trace.origin_us, task->trace.stage_us);
+#endif
+#if CONFIG_USE_UPLINK_SILENCE_SUPPRESSION
+        if (SuppressUplinkFrame(task)) {
+            return;
         }
-        timestamp_queue_.pop_front();
+        FlushUplinkPreroll();
+#else
+        uplink_stats_.sent++;
+#endif
+    }
+
+    PushEncodeTask(task);
+}
+
+void AudioService::PushEncodeTask(std::unique_ptr<AudioTask>& task) {
+    WaitForSpace(encode_waiter_, [this]() { return !audio_encode_queue_.full(); });
+    if (audio_encode_queue_.Push(task)) {
+        NotifyTask(opus_encoder_task_handle_);
+    }
+}
+
+#if CONFIG_USE_UPLINK_SILENCE_SUPPRESSION
+bool AudioService::SuppressUplinkFrame(std::unique_ptr<AudioTask>& task) {
+    int frame_ms = task->pcm.size() * 1000 / 16000;
+    /* Server side AEC aligns every frame with its playback timestamps, nothing is dropped then.
+     * Without a running VAD (device AEC turns it off) speech is never reported, so nothing is either */
+    if (voice_detected_ || task->timestamp != 0 || !audio_processor_->IsVadRunning()) {
+        uplink_silent_ms_ = 0;
+        uplink_keepalive_ms_ = 0;
+        uplink_stats_.sent += 1 + uplink_preroll_count_;
+        uplink_stats_.suppressed -= uplink_preroll_count_;
+        return false;
+    }
+
+    uplink_silent_ms_ += frame_ms;
+    uplink_keepalive_ms_ += frame_ms;
+    if (uplink_silent_ms_ <= UPLINK_SILENCE_TAIL_MS || uplink_keepalive_ms_ >= CONFIG_UPLINK_KEEPALIVE_MS) {
+        if (uplink_silent_ms_ > UPLINK_SILENCE_TAIL_MS) {
+            uplink_stats_.keepalives++;
+        }
+        uplink_keepalive_ms_ = 0;
+        uplink_stats_.sent++;
+        /* Older audio would follow this frame out of order */
+        ClearUplinkPreroll();
+        return false;
+    }
+
+    /* Not encoded at all, the latest UPLINK_PREROLL_MS are kept as pre-roll for a speech onset */
+    uplink_stats_.suppressed++;
+    size_t limit = std::max(1, UPLINK_PREROLL_MS / frame_ms);
+    while (uplink_preroll_count_ >= limit) {
+        uplink_preroll_[uplink_preroll_head_].reset();
+        uplink_preroll_head_ = (uplink_preroll_head_ + 1) % UPLINK_PREROLL_FRAMES;
+        uplink_preroll_count_--;
+    }
+    uplink_preroll_[(uplink_preroll_head_ + uplink_preroll_count_) % UPLINK_PREROLL_FRAMES] = std::move(task);
+    uplink_preroll_count_++;
+    return true;
+}
+
+void AudioService::FlushUplinkPreroll() {
+    while (uplink_preroll_count_ > 0) {
+        auto& task = uplink_preroll_[uplink_preroll_head_];
+        PushEncodeTask(task);
+        task.reset();
+        uplink_preroll_head_ = (uplink_preroll_head_ + 1) % UPLINK_PREROLL_FRAMES;
+        uplink_preroll_count_--;
     }
+}
 
-    audio_queue_cv_.wait(lock, [this]() { return audio_encode_queue_.size() < MAX_ENCODE_TASKS_IN_QUEUE; });
-    audio_encode_queue_.push_back(std::move(task));
-    audio_queue_cv_.notify_all();
+void AudioService::ClearUplinkPreroll() {
+    for (auto& task : uplink_preroll_) {
+        task.reset();
+    }
+    uplink_preroll_head_ = 0;
+    uplink_preroll_count_ = 0;
 }
+#endif
 
 bool AudioService::PushPacketToDecodeQueue(std::unique_ptr<AudioStreamPacket> packet, bool wait) {
-    std::unique_lock<std::mutex> lock(audio_queue_mutex_);
-    if (audio_decode_queue_.size() >= MAX_DECODE_PACKETS_IN_QUEUE) {
-        if (wait) {
-            audio_queue_cv_.wait(lock, [this]() { return audio_decode_queue_.size() < MAX_DECODE_PACKETS_IN_QUEUE; });
-        } else {
+#if CONFIG_USE_AUDIO_LATENCY_TRACE
+    packet->trace.origin_us = esp_timer_get_time();
+#endif
+    std::lock_guard<std::mutex> lock(decode_push_mutex_);
+    if (audio_decode_queue_.full()) {
+        if (!wait) {
             return false;
         }
+        WaitForSpace(decode_waiter_, [this]() { return !audio_decode_queue_.full(); });
     }
-    audio_decode_queue_.push_back(std::move(packet));
-    audio_queue_cv_.notify_all();
+    packet->decode_index = decode_packets_pushed_ + 1;
+    if (!audio_decode_queue_.Push(packet)) {
+        return false;
+    }
+    decode_packets_pushed_++;
+    NotifyTask(opus_decoder_task_handle_);
     return true;
 }
 
+uint32_t AudioService::MarkSentenceStart() {
+    std::lock_guard<std::mutex> lock(decode_push_mutex_);
+    uint32_t sentence = last_sentence() + 1;
+    sentence_mark_ = (uint64_t(sentence) << 32) | (decode_packets_pushed_ + 1);
+    return sentence;
+}
+
+bool AudioService::GetSentenceStartMs(uint32_t sentence, uint32_t& start_ms) const {
+    if (sentence == 0 || started_sentence_.load() != sentence) {
+        return false;
+    }
+    start_ms = sentence_start_ms_.load();
+    /* A later sentence may have started meanwhile, its position is not this one's */
+    return started_sentence_.load() == sentence;
+}
+
 std::unique_ptr<AudioStreamPacket> AudioService::PopPacketFromSendQueue() {
-    std::lock_guard<std::mutex> lock(audio_queue_mutex_);
-    if (audio_send_queue_.empty()) {
-        return nullptr;
+    std::unique_ptr<AudioStreamPacket> packet;
+    bool was_full = audio_send_queue_.full();
+    audio_send_queue_.Pop(packet);
+    if (was_full) {
+        NotifyTask(opus_encoder_task_handle_);
+    }
+#if CONFIG_USE_AUDIO_LATENCY_TRACE
+    if (packet) {
+        int64_t now = esp_timer_get_time();
+        AudioLatency::Record(kLatencySend, packet->trace.stage_us, now);
+        AudioLatency::Record(kLatencyUplink, packet->trace.origin_us, now);
     }
-    auto packet = std::move(audio_send_queue_.front());
-    audio_send_queue_.pop_front();
-    audio_queue_cv_.notify_all();
+#endif
     return packet;
 }
 
 void AudioService::EncodeWakeWord() {
     if (wake_word_) {
-        wake_word_->EncodeWakeWordData();
+        wake_word_->EncodeWakeWordData(uplink_frame_duration_ms_);
     }
 }
 
@@ -478,18 +1022,39 @@ void AudioService::EnableVoiceProcessing(bool enable) {
     ESP_LOGD(TAG, "%s voice processing", enable ? "Enabling" : "Disabling");
     if (enable) {
         if (!audio_processor_initialized_) {
-            audio_processor_->Initialize(codec_, OPUS_FRAME_DURATION_MS, models_list_);
+            audio_processor_->Initialize(codec_, uplink_frame_duration_ms_, models_list_);
             audio_processor_initialized_ = true;
         }
+        audio_processor_->SetFrameDuration(uplink_frame_duration_ms_);
 
         /* We should make sure no audio is playing */
         ResetDecoder();
         audio_input_need_warmup_ = true;
+#if CONFIG_USE_UPLINK_SILENCE_SUPPRESSION
+        /* The processor callback is idle until Start() */
+        ClearUplinkPreroll();
+        uplink_silent_ms_ = 0;
+        uplink_keepalive_ms_ = 0;
+#endif
+#if CONFIG_USE_AUDIO_LATENCY_TRACE
+        {
+            std::lock_guard<std::mutex> lock(trace_mutex_);
+            trace_fed_samples_ = 0;
+            trace_output_samples_ = 0;
+            for (auto& feed : trace_feeds_) {
+                feed = {};
+            }
+        }
+#endif
         audio_processor_->Start();
         xEventGroupSetBits(event_group_, AS_EVENT_AUDIO_PROCESSOR_RUNNING);
     } else {
         audio_processor_->Stop();
         xEventGroupClearBits(event_group_, AS_EVENT_AUDIO_PROCESSOR_RUNNING);
+#if CONFIG_USE_UPLINK_SILENCE_SUPPRESSION
+        ESP_LOGI(TAG, "Uplink frames: %lu sent (%lu keepalives), %lu suppressed",
+            uplink_stats_.sent, uplink_stats_.keepalives, uplink_stats_.suppressed);
+#endif
     }
 }
 
@@ -499,17 +1064,15 @@ void AudioService::EnableAudioTesting(bool enable) {
         xEventGroupSetBits(event_group_, AS_EVENT_AUDIO_TESTING_RUNNING);
     } else {
         xEventGroupClearBits(event_group_, AS_EVENT_AUDIO_TESTING_RUNNING);
-        /* Copy audio_testing_queue_ to audio_decode_queue_ */
-        std::lock_guard<std::mutex> lock(audio_queue_mutex_);
-        audio_decode_queue_ = std::move(audio_testing_queue_);
-        audio_queue_cv_.notify_all();
+        /* The decoder task plays audio_testing_queue_ back once the bit is cleared */
+        NotifyTask(opus_decoder_task_handle_);
     }
 }
 
 void AudioService::EnableDeviceAec(bool enable) {
     ESP_LOGI(TAG, "%s device AEC", enable ? "Enabling" : "Disabling");
     if (!audio_processor_initialized_) {
-        audio_processor_->Initialize(codec_, OPUS_FRAME_DURATION_MS, models_list_);
+        audio_processor_->Initialize(codec_, uplink_frame_duration_ms_, models_list_);
         audio_processor_initialized_ = true;
     }
 
@@ -522,126 +1085,177 @@ void AudioService::SetCallbacks(AudioServiceCallbacks& callbacks) {
 
 void AudioService::PlaySound(const std::string_view& ogg) {
     if (!codec_->output_enabled()) {
-        esp_timer_stop(audio_power_timer_);
-        esp_timer_start_periodic(audio_power_timer_, AUDIO_POWER_CHECK_INTERVAL_MS * 1000);
-        codec_->EnableOutput(true);
+        EnableOutputPower();
     }
 
-    const uint8_t* buf = reinterpret_cast<const uint8_t*>(ogg.data());
-    size_t size = ogg.size();
-    size_t offset = 0;
+    int64_t idle = 0;
+    sound_requested_us_.compare_exchange_strong(idle, esp_timer_get_time());
 
-    auto find_page = [&](size_t start)->size_t {
-        for (size_t i = start; i + 4 <= size; ++i) {
-            if (buf[i] == 'O' && buf[i+1] == 'g' && buf[i+2] == 'g' && buf[i+3] == 'S') return i;
+    {
+        std::lock_guard<std::mutex> lock(sound_push_mutex_);
+        auto it = cached_sounds_.find(ogg.data());
+        if (it != cached_sounds_.end()) {
+            const CachedSound* cached = &it->second;
+            if (!audio_cached_sound_queue_.Push(cached)) {
+                ESP_LOGW(TAG, "Cached sound queue is full, dropping sound");
+                return;
+            }
+            NotifyTask(audio_output_task_handle_);
+            return;
         }
-        return static_cast<size_t>(-1);
-    };
+    }
 
-    bool seen_head = false;
-    bool seen_tags = false;
-    int sample_rate = 16000; // 默认值
+    const OggOpusIndex* sound = OggOpusIndex::Get(ogg);
+    if (sound->empty()) {
+        return;
+    }
 
-    while (true) {
-        size_t pos = find_page(offset);
-        if (pos == static_cast<size_t>(-1)) break;
-        offset = pos;
-        if (offset + 27 > size) break;
-
-        const uint8_t* page = buf + offset;
-        uint8_t page_segments = page[26];
-        size_t seg_table_off = offset + 27;
-        if (seg_table_off + page_segments > size) break;
-
-        size_t body_size = 0;
-        for (size_t i = 0; i < page_segments; ++i) body_size += page[27 + i];
-
-        size_t body_off = seg_table_off + page_segments;
-        if (body_off + body_size > size) break;
-
-        // Parse packets using lacing
-        size_t cur = body_off;
-        size_t seg_idx = 0;
-        while (seg_idx < page_segments) {
-            size_t pkt_len = 0;
-            size_t pkt_start = cur;
-            bool continued = false;
-            do {
-                uint8_t l = page[27 + seg_idx++];
-                pkt_len += l;
-                cur += l;
-                continued = (l == 255);
-            } while (continued && seg_idx < page_segments);
-
-            if (pkt_len == 0) continue;
-            const uint8_t* pkt_ptr = buf + pkt_start;
-
-            if (!seen_head) {
-                // 解析OpusHead包
-                if (pkt_len >= 19 && std::memcmp(pkt_ptr, "OpusHead", 8) == 0) {
-                    seen_head = true;
-                    
-                    // OpusHead结构：[0-7] "OpusHead", [8] version, [9] channel_count, [10-11] pre_skip
-                    // [12-15] input_sample_rate, [16-17] output_gain, [18] mapping_family
-                    if (pkt_len >= 12) {
-                        uint8_t version = pkt_ptr[8];
-                        uint8_t channel_count = pkt_ptr[9];
-                        
-                        if (pkt_len >= 16) {
-                            // 读取输入采样率 (little-endian)
-                            sample_rate = pkt_ptr[12] | (pkt_ptr[13] << 8) | 
-                                        (pkt_ptr[14] << 16) | (pkt_ptr[15] << 24);
-                            ESP_LOGI(TAG, "OpusHead: version=%d, channels=%d, sample_rate=%d", 
-                                   version, channel_count, sample_rate);
-                        }
-                    }
-                }
-                continue;
-            }
-            if (!seen_tags) {
-                // Expect OpusTags in second packet
-                if (pkt_len >= 8 && std::memcmp(pkt_ptr, "OpusTags", 8) == 0) {
-                    seen_tags = true;
-                }
-                continue;
-            }
+    /* Never blocks the caller, the decoder task streams the packets from flash */
+    std::lock_guard<std::mutex> lock(sound_push_mutex_);
+    if (!audio_sound_queue_.Push(sound)) {
+        ESP_LOGW(TAG, "Sound queue is full, dropping sound");
+        return;
+    }
+    NotifyTask(opus_decoder_task_handle_);
+}
 
-            // Audio packet (Opus)
-            auto packet = std::make_unique<AudioStreamPacket>();
-            packet->sample_rate = sample_rate;
-            packet->frame_duration = 60;
-            packet->payload.resize(pkt_len);
-            std::memcpy(packet->payload.data(), pkt_ptr, pkt_len);
-            PushPacketToDecodeQueue(std::move(packet), true);
+bool AudioService::CacheSound(const std::string_view& ogg) {
+    if (SOUND_PCM_CACHE_SIZE == 0) {
+        return false;
+    }
+    {
+        std::lock_guard<std::mutex> lock(sound_push_mutex_);
+        if (cached_sounds_.count(ogg.data()) > 0) {
+            return true;
+        }
+    }
+
+    const OggOpusIndex* sound = OggOpusIndex::Get(ogg);
+    if (sound->empty()) {
+        return false;
+    }
+
+    /* A private decoder and resampler, the service ones belong to the decoder task */
+    OpusDecoderWrapper decoder(sound->sample_rate(), 1, sound->frame_duration_ms());
+    PcmResampler resampler;
+    bool resample = sound->sample_rate() != codec_->output_sample_rate();
+    if (resample) {
+        resampler.Configure(sound->sample_rate(), codec_->output_sample_rate());
+    }
+
+    std::vector<int16_t> pcm;
+    std::vector<int16_t> frame;
+    std::vector<int16_t> resampled;
+    for (size_t i = 0; i < sound->size(); i++) {
+        const uint8_t* data = sound->packet_data(i);
+        if (!decoder.Decode(std::vector<uint8_t>(data, data + sound->packet_size(i)), frame)) {
+            ESP_LOGE(TAG, "Failed to decode sound %p", ogg.data());
+            return false;
         }
+        if (resample) {
+            resampled.resize(resampler.GetOutputSamples(frame.size()));
+            resampler.Process(frame.data(), frame.size(), resampled.data());
+            frame.swap(resampled);
+        }
+        pcm.insert(pcm.end(), frame.begin(), frame.end());
+    }
 
-        offset = body_off + body_size;
+    size_t bytes = pcm.size() * sizeof(int16_t);
+    std::lock_guard<std::mutex> lock(sound_push_mutex_);
+    if (cached_sounds_bytes_ + bytes > SOUND_PCM_CACHE_SIZE) {
+        ESP_LOGW(TAG, "Sound PCM cache is full, %u bytes used, %u more needed", cached_sounds_bytes_, bytes);
+        return false;
+    }
+    auto buffer = static_cast<int16_t*>(heap_caps_malloc(bytes, MALLOC_CAP_SPIRAM));
+    if (buffer == nullptr) {
+        ESP_LOGE(TAG, "Failed to allocate %u bytes for sound PCM cache", bytes);
+        return false;
     }
+    std::memcpy(buffer, pcm.data(), bytes);
+    cached_sounds_[ogg.data()] = { buffer, pcm.size() };
+    cached_sounds_bytes_ += bytes;
+    ESP_LOGI(TAG, "Cached sound %p: %u ms of PCM, %u bytes in use", ogg.data(),
+        pcm.size() * 1000 / codec_->output_sample_rate(), cached_sounds_bytes_);
+    return true;
 }
 
 bool AudioService::IsIdle() {
-    std::lock_guard<std::mutex> lock(audio_queue_mutex_);
-    return audio_encode_queue_.empty() && audio_decode_queue_.empty() && audio_playback_queue_.empty() && audio_testing_queue_.empty();
+    return audio_encode_queue_.empty() && audio_decode_queue_.empty() && audio_playback_queue_.empty() && audio_testing_queue_.empty() &&
+        audio_sound_queue_.empty() && playing_sound_ == nullptr && audio_cue_queue_.empty() &&
+        audio_cached_sound_queue_.empty() && playing_cached_sound_ == nullptr &&
+        decoder_held_ == 0 && !mixer_busy_;
 }
 
 void AudioService::ResetDecoder() {
-    std::lock_guard<std::mutex> lock(audio_queue_mutex_);
-    opus_decoder_->ResetState();
-    timestamp_queue_.clear();
-    audio_decode_queue_.clear();
-    audio_playback_queue_.clear();
-    audio_testing_queue_.clear();
-    audio_queue_cv_.notify_all();
+    {
+        std::lock_guard<std::mutex> lock(timestamp_mutex_);
+        timestamp_queue_.clear();
+    }
+    audio_decode_queue_.Clear();
+    audio_sound_queue_.Clear();
+    audio_cached_sound_queue_.Clear();
+    audio_cue_queue_.Clear();
+    audio_playback_queue_.Clear();
+    audio_testing_queue_.Clear();
+    sound_requested_us_ = 0;
+    /* The decoder state belongs to the decoder task, it resets before the next decode */
+    decoder_reset_pending_ = true;
+    NotifyTask(opus_decoder_task_handle_);
+    NotifyTask(audio_output_task_handle_);
+}
+
+uint32_t AudioService::GetPlaybackPositionMs() const {
+    return playback_position_ms_.load();
+}
+
+bool AudioService::SetUplinkFrameDuration(int frame_duration_ms) {
+    if (frame_duration_ms != 20 && frame_duration_ms != 40 && frame_duration_ms != 60) {
+        ESP_LOGW(TAG, "Unsupported uplink frame duration %d ms", frame_duration_ms);
+        return false;
+    }
+    if (uplink_frame_duration_ms_.exchange(frame_duration_ms) == frame_duration_ms) {
+        return true;
+    }
+    ESP_LOGI(TAG, "Uplink frame duration set to %d ms", frame_duration_ms);
+
+    /* Queues hold the same amount of audio whatever the frame size */
+    audio_send_queue_.set_limit(MAX_SEND_QUEUE_MS / frame_duration_ms);
+    audio_testing_queue_.set_limit(AUDIO_TESTING_MAX_DURATION_MS / frame_duration_ms);
+    /* Frames of the old size cannot be encoded any more, the encoder task picks the new size up */
+    audio_encode_queue_.Clear();
+    NotifyTask(opus_encoder_task_handle_);
+    return true;
+}
+
+void AudioService::SetDownlinkFrameDuration(int frame_duration_ms) {
+    frame_duration_ms = std::clamp(frame_duration_ms, OPUS_MIN_FRAME_DURATION_MS, 120);
+    audio_decode_queue_.set_limit(MAX_DECODE_QUEUE_MS / frame_duration_ms);
+}
+
+JitterBufferStats AudioService::GetJitterBufferStats() const {
+    /* Counters are written by the decoder task only, a torn read just skews one value */
+    return jitter_buffer_.stats();
+}
+
+UplinkStats AudioService::GetUplinkStats() const {
+    return uplink_stats_;
 }
 
 void AudioService::CheckAndUpdateAudioPowerState() {
     auto now = std::chrono::steady_clock::now();
     auto input_elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(now - last_input_time_).count();
-    auto output_elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(now - last_output_time_).count();
     if (input_elapsed > AUDIO_POWER_TIMEOUT_MS && codec_->input_enabled()) {
         codec_->EnableInput(false);
     }
-    if (output_elapsed > AUDIO_POWER_TIMEOUT_MS && codec_->output_enabled()) {
+
+    std::lock_guard<std::mutex> lock(power_mutex_);
+    int timeout_ms = LearnedOutputTimeoutMs();
+    if (timeout_ms != output_power_timeout_ms_) {
+        ESP_LOGI(TAG, "Output power-down delay set to %d ms", timeout_ms);
+        output_power_timeout_ms_ = timeout_ms;
+    }
+    int64_t output_elapsed_ms = (esp_timer_get_time() - output_demand_us_) / 1000;
+    if (output_elapsed_ms > timeout_ms && codec_->output_enabled()) {
         codec_->EnableOutput(false);
     }
     if (!codec_->input_enabled() && !codec_->output_enabled()) {
@@ -649,6 +1263,78 @@ void AudioService::CheckAndUpdateAudioPowerState() {
     }
 }
 
+void AudioService::EnableOutputPower() {
+    std::lock_guard<std::mutex> lock(power_mutex_);
+    if (codec_->output_enabled()) {
+        return;
+    }
+    esp_timer_stop(audio_power_timer_);
+    esp_timer_start_periodic(audio_power_timer_, AUDIO_POWER_CHECK_INTERVAL_MS * 1000);
+    int64_t start_us = esp_timer_get_time();
+    codec_->EnableOutput(true);
+    ESP_LOGI(TAG, "Output powered up in %lld ms", (esp_timer_get_time() - start_us) / 1000);
+}
+
+void AudioService::WarmUpOutput(bool measure) {
+    if (measure) {
+        speech_requested_warm_ = codec_->output_enabled();
+        speech_requested_us_ = esp_timer_get_time();
+    }
+    NoteOutputDemand(esp_timer_get_time());
+    /* Callers include the network receive thread, the codec's I2C power-up must not hold it up */
+    if (!codec_->output_enabled()) {
+        output_warm_up_requested_ = true;
+        NotifyTask(audio_output_task_handle_);
+    }
+}
+
+void AudioService::NoteOutputDemand(int64_t now_us) {
+    int64_t previous_us = output_demand_us_.exchange(now_us);
+    int64_t gap_ms = (now_us - previous_us) / 1000;
+    if (previous_us == 0 || gap_ms < AUDIO_POWER_GAP_MIN_MS) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(power_mutex_);
+    int bucket = std::min<int64_t>(gap_ms / 1000, AUDIO_POWER_GAP_BUCKETS - 1);
+    output_gap_buckets_[bucket]++;
+    /* Halve the history now and then, so the delay follows how the device is used lately */
+    int total = 0;
+    for (auto count : output_gap_buckets_) {
+        total += count;
+    }
+    if (total >= 64) {
+        for (auto& count : output_gap_buckets_) {
+            count /= 2;
+        }
+    }
+}
+
+int AudioService::LearnedOutputTimeoutMs() {
+    /* Keep the output powered through 90% of the idle gaps that ended within AUDIO_POWER_TIMEOUT_MS.
+     * When most gaps are longer than that, staying on rarely pays off, power down early */
+    int total = 0;
+    for (auto count : output_gap_buckets_) {
+        total += count;
+    }
+    int short_gaps = total - output_gap_buckets_[AUDIO_POWER_GAP_BUCKETS - 1];
+    if (total < AUDIO_POWER_GAP_SAMPLES) {
+        return AUDIO_POWER_TIMEOUT_MS;
+    }
+    if (short_gaps * 4 < total) {
+        return AUDIO_POWER_MIN_TIMEOUT_MS;
+    }
+    int target = (short_gaps * 9 + 9) / 10;
+    int seen = 0;
+    for (int i = 0; i < AUDIO_POWER_GAP_BUCKETS - 1; i++) {
+        seen += output_gap_buckets_[i];
+        if (seen >= target) {
+            return std::max((i + 1) * 1000, AUDIO_POWER_MIN_TIMEOUT_MS);
+        }
+    }
+    return AUDIO_POWER_TIMEOUT_MS;
+}
+
 void AudioService::SetModelsList(srmodel_list_t* models_list) {
     models_list_ = models_list;
 
@@ -3,9 +3,10 @@
 
 #include <memory>
 #include <deque>
-#include <condition_variable>
 #include <chrono>
 #include <mutex>
+#include <atomic>
+#include <map>
 
 #include <freertos/FreeRTOS.h>
 #include <freertos/task.h>
@@ -15,36 +16,81 @@
 
 #include <opus_encoder.h>
 #include <opus_decoder.h>
-#include <opus_resampler.h>
 
 #include "audio_codec.h"
 #include "audio_processor.h"
 #include "processors/audio_debugger.h"
 #include "wake_word.h"
 #include "protocol.h"
+#include "spsc_ring.h"
+#include "audio_pool.h"
+#include "audio_latency.h"
+#include "jitter_buffer.h"
+#include "ogg_opus_index.h"
+#include "audio_mixer.h"
+#include "pcm_resampler.h"
+#include "opus_complexity.h"
 
 
 /*
  * There are two types of audio data flow:
  * 1. (MIC) -> [Processors] -> {Encode Queue} -> [Opus Encoder] -> {Send Queue} -> (Server)
- * 2. (Server) -> {Decode Queue} -> [Opus Decoder] -> {Playback Queue} -> (Speaker)
+ * 2. (Server) -> {Decode Queue} -> {Jitter Buffer} -> [Opus Decoder] -> {Playback Queue} -> [Mixer] -> (Speaker)
+ *    (PlaySound) -> {Sound Queue} -> [Cue Decoder] -> {Cue Queue} -> [Mixer]
  *
- * We use one task for MIC / Speaker / Processors, and one task for Opus Encoder / Opus Decoder.
+ * We use one task each for MIC / Processors and Speaker, and one task each for the Opus Encoder
+ * and the Opus Decoder. opus_encoder_ is only used by the encoder task and opus_decoder_ (with
+ * output_resampler_, cue_decoder_ and cue_resampler_) only by the decoder task once Start() returns;
+ * other threads request a decoder reset through decoder_reset_pending_. Speech and local sounds
+ * are mixed by the output task, so a sound can play over speech without resetting its decoder.
  * 
  * Decode Queue and Send Queue are the main queues, because Opus packets are quite smaller than PCM packets.
+ *
+ * Every queue is a lock-free SPSC ring. A push or pop only notifies the one task
+ * that can make progress from it (FreeRTOS task notification), instead of waking
+ * every stage. The decode queue and the sound queue have several producers, so
+ * their producers are serialized by a mutex the consumer never takes.
+ *
+ * PlaySound() only queues the cached packet index of the sound and returns; the
+ * decoder task reads the packets from flash after the decode queue is drained.
  * 
  */
 
+/* Default uplink frame duration, the one in use is negotiated per audio channel (20 / 40 / 60 ms) */
 #define OPUS_FRAME_DURATION_MS 60
+#define OPUS_MIN_FRAME_DURATION_MS 20
 #define MAX_ENCODE_TASKS_IN_QUEUE 2
 #define MAX_PLAYBACK_TASKS_IN_QUEUE 2
-#define MAX_DECODE_PACKETS_IN_QUEUE (2400 / OPUS_FRAME_DURATION_MS)
-#define MAX_SEND_PACKETS_IN_QUEUE (2400 / OPUS_FRAME_DURATION_MS)
+#define MAX_CUE_TASKS_IN_QUEUE 2
+/* The decode queue holds a fixed amount of downlink audio, its storage fits the shortest frames */
+#define MAX_DECODE_QUEUE_MS 2400
+#define MAX_DECODE_PACKETS_IN_QUEUE (MAX_DECODE_QUEUE_MS / OPUS_MIN_FRAME_DURATION_MS)
+#define MAX_SOUNDS_IN_QUEUE 16
+/* Cached UI sounds are handed to the codec in chunks of this duration */
+#define CACHED_SOUND_CHUNK_MS 20
+/* Playback is written to the codec in slices, an abort fades out over PLAYBACK_FADE_MS */
+#define PLAYBACK_SLICE_MS 10
+#define PLAYBACK_FADE_MS 5
+/* Speech level while a local sound plays over it */
+#define CUE_DUCKING_PERCENT 30
+/* Uplink queues hold a fixed amount of audio, their storage fits the shortest frames */
+#define MAX_SEND_QUEUE_MS 2400
+#define MAX_SEND_PACKETS_IN_QUEUE (MAX_SEND_QUEUE_MS / OPUS_MIN_FRAME_DURATION_MS)
 #define AUDIO_TESTING_MAX_DURATION_MS 10000
+/* Silence suppression keeps sending this long after speech, so the server VAD sees the pause */
+#define UPLINK_SILENCE_TAIL_MS 1000
+/* and keeps this much of the suppressed audio to send ahead of speech, the VAD fires after the onset */
+#define UPLINK_PREROLL_MS 300
+#define UPLINK_PREROLL_FRAMES (UPLINK_PREROLL_MS / OPUS_MIN_FRAME_DURATION_MS)
 #define MAX_TIMESTAMPS_IN_QUEUE 3
 
 #define AUDIO_POWER_TIMEOUT_MS 15000
 #define AUDIO_POWER_CHECK_INTERVAL_MS 1000
+/* The output power-down delay is learned from past idle gaps, within these bounds */
+#define AUDIO_POWER_MIN_TIMEOUT_MS 2000
+#define AUDIO_POWER_GAP_MIN_MS 1000      // Shorter gaps are pauses within one reply
+#define AUDIO_POWER_GAP_BUCKETS (AUDIO_POWER_TIMEOUT_MS / 1000 + 1)
+#define AUDIO_POWER_GAP_SAMPLES 8        // Gaps needed before the learned delay is used
 
 
 #define AS_EVENT_AUDIO_TESTING_RUNNING      (1 << 0)
@@ -70,6 +116,27 @@ struct AudioTask {
     AudioTaskType type;
     std::vector<int16_t> pcm;
     uint32_t timestamp;
+    uint32_t decode_index = 0;  // Of the packet decoded into it, 0 for concealed frames
+#if CONFIG_USE_AUDIO_LATENCY_TRACE
+    AudioTrace trace;
+#endif
+
+    ~AudioTask() { AudioPool::ReleasePcm(std::move(pcm)); }
+    static void* operator new(size_t size) { return AudioPool::AllocateTask(size); }
+    static void operator delete(void* ptr) { AudioPool::FreeTask(ptr); }
+};
+
+// Output-rate PCM of a sound decoded ahead of time, kept in PSRAM
+struct CachedSound {
+    int16_t* pcm;
+    size_t samples;
+};
+
+// Uplink frames while listening, see CONFIG_USE_UPLINK_SILENCE_SUPPRESSION
+struct UplinkStats {
+    uint32_t sent = 0;
+    uint32_t suppressed = 0;
+    uint32_t keepalives = 0;  // Silent frames sent to keep the server stream alive, counted in sent too
 };
 
 struct DebugStatistics {
@@ -106,8 +173,30 @@ public:
     bool PushPacketToDecodeQueue(std::unique_ptr<AudioStreamPacket> packet, bool wait = false);
     std::unique_ptr<AudioStreamPacket> PopPacketFromSendQueue();
     void PlaySound(const std::string_view& sound);
+    // Decodes a short sound once so PlaySound() can skip the decoder, see CONFIG_USE_SOUND_PCM_CACHE
+    bool CacheSound(const std::string_view& sound);
     bool ReadAudioData(std::vector<int16_t>& data, int sample_rate, int samples);
     void ResetDecoder();
+    // Asks the output task to power the speaker path up ahead of a reply, without waiting for it.
+    // With measure set (tts start), the time until the first speech sample reaches the codec is logged
+    void WarmUpOutput(bool measure = false);
+    // Local barge-in: drops queued speech and fades the frame being played out within one slice
+    void AbortPlayback();
+    // Milliseconds of decoded audio handed to the codec so far, stalls with playback
+    uint32_t GetPlaybackPositionMs() const;
+    // Marks the next packet pushed for decoding as the first of a TTS sentence and returns the
+    // sentence's id. Once that packet reaches the codec, GetSentenceStartMs() gives the playback
+    // position it started at
+    uint32_t MarkSentenceStart();
+    uint32_t last_sentence() const { return uint32_t(sentence_mark_.load() >> 32); }
+    bool GetSentenceStartMs(uint32_t sentence, uint32_t& start_ms) const;
+    JitterBufferStats GetJitterBufferStats() const;
+    UplinkStats GetUplinkStats() const;
+    // Uplink Opus frame duration (20, 40 or 60 ms), apply before the audio channel is opened
+    bool SetUplinkFrameDuration(int frame_duration_ms);
+    // Frame duration of the server audio, sets how many packets the decode queue takes
+    void SetDownlinkFrameDuration(int frame_duration_ms);
+    int uplink_frame_duration() const { return uplink_frame_duration_ms_; }
     void SetModelsList(srmodel_list_t* models_list);
 
 private:
@@ -118,9 +207,15 @@ private:
     std::unique_ptr<AudioDebugger> audio_debugger_;
     std::unique_ptr<OpusEncoderWrapper> opus_encoder_;
     std::unique_ptr<OpusDecoderWrapper> opus_decoder_;
-    OpusResampler input_resampler_;
-    OpusResampler reference_resampler_;
-    OpusResampler output_resampler_;
+    PcmResampler input_resampler_;
+    PcmResampler reference_resampler_;
+    PcmResampler output_resampler_;
+    std::unique_ptr<OpusDecoderWrapper> cue_decoder_;
+    PcmResampler cue_resampler_;
+    // Capture scratch, owned by the input task
+    std::vector<int16_t> capture_buffer_;
+    std::vector<int16_t> mic_scratch_[2];        // Resampler input, output
+    std::vector<int16_t> reference_scratch_[2];
     DebugStatistics debug_statistics_;
     srmodel_list_t* models_list_ = nullptr;
 
@@ -129,33 +224,140 @@ private:
     // Audio encode / decode
     TaskHandle_t audio_input_task_handle_ = nullptr;
     TaskHandle_t audio_output_task_handle_ = nullptr;
-    TaskHandle_t opus_codec_task_handle_ = nullptr;
-    std::mutex audio_queue_mutex_;
-    std::condition_variable audio_queue_cv_;
-    std::deque<std::unique_ptr<AudioStreamPacket>> audio_decode_queue_;
-    std::deque<std::unique_ptr<AudioStreamPacket>> audio_send_queue_;
-    std::deque<std::unique_ptr<AudioStreamPacket>> audio_testing_queue_;
-    std::deque<std::unique_ptr<AudioTask>> audio_encode_queue_;
-    std::deque<std::unique_ptr<AudioTask>> audio_playback_queue_;
+    TaskHandle_t opus_encoder_task_handle_ = nullptr;
+    TaskHandle_t opus_decoder_task_handle_ = nullptr;
+    SpscRing<std::unique_ptr<AudioStreamPacket>, MAX_DECODE_PACKETS_IN_QUEUE> audio_decode_queue_;
+    SpscRing<std::unique_ptr<AudioStreamPacket>, MAX_SEND_PACKETS_IN_QUEUE> audio_send_queue_;
+    SpscRing<std::unique_ptr<AudioStreamPacket>, AUDIO_TESTING_MAX_DURATION_MS / OPUS_MIN_FRAME_DURATION_MS> audio_testing_queue_;
+    SpscRing<std::unique_ptr<AudioTask>, MAX_ENCODE_TASKS_IN_QUEUE> audio_encode_queue_;
+    SpscRing<std::unique_ptr<AudioTask>, MAX_PLAYBACK_TASKS_IN_QUEUE> audio_playback_queue_;
+    SpscRing<std::unique_ptr<AudioTask>, MAX_CUE_TASKS_IN_QUEUE> audio_cue_queue_;
+    SpscRing<const OggOpusIndex*, MAX_SOUNDS_IN_QUEUE> audio_sound_queue_;
+    std::mutex decode_push_mutex_;
+    std::mutex sound_push_mutex_;
+    // Sound being played and its next packet, advanced by the decoder task
+    std::atomic<const OggOpusIndex*> playing_sound_ = nullptr;
+    size_t playing_sound_packet_ = 0;
+    // Decoded UI sounds keyed by their data pointer, queued straight to the output task
+    std::map<const char*, CachedSound> cached_sounds_;
+    size_t cached_sounds_bytes_ = 0;
+    SpscRing<const CachedSound*, MAX_SOUNDS_IN_QUEUE> audio_cached_sound_queue_;
+    std::atomic<const CachedSound*> playing_cached_sound_ = nullptr;
+    size_t playing_cached_sound_offset_ = 0;
+    // When the oldest sound not yet heard was requested, for the latency log
+    std::atomic<int64_t> sound_requested_us_ = 0;
+    // When the current reply was announced, 0 once its first sample was played
+    std::atomic<int64_t> speech_requested_us_ = 0;
+    std::atomic<bool> speech_requested_warm_ = false;
+    // Set by WarmUpOutput(), the output task does the power-up
+    std::atomic<bool> output_warm_up_requested_ = false;
+    // When AbortPlayback() was requested, 0 once the output task has acted on it
+    std::atomic<int64_t> playback_abort_us_ = 0;
+    // Owned by the output task: the frame each mixer source is playing and the mixed slice
+    struct MixerInput {
+        std::unique_ptr<AudioTask> task;
+        size_t offset = 0;
+        size_t remaining() const { return task ? task->pcm.size() - offset : 0; }
+    };
+    AudioMixer mixer_;
+    MixerInput mixer_inputs_[kAudioMixerSourceCount];
+    bool cue_from_cache_ = false;
+    std::vector<int16_t> output_slice_;
+    int64_t last_output_us_ = 0;
+    bool speech_playing_ = false;
+    // Raised by the output task when speech ran dry, the decoder task reports it to the jitter buffer
+    std::atomic<bool> speech_starved_ = false;
+    // Mirrors of task-owned state for IsIdle(): a mixer input holds audio, packets held by the decoder task
+    std::atomic<bool> mixer_busy_ = false;
+    std::atomic<size_t> decoder_held_ = 0;
+#if CONFIG_USE_AUDIO_LATENCY_TRACE
+    // Capture time of recent processor input, to map processor output back to it
+    struct TraceFeed {
+        uint64_t end_sample;
+        int64_t capture_us;
+    };
+    std::mutex trace_mutex_;
+    TraceFeed trace_feeds_[8] = {};
+    size_t trace_feed_index_ = 0;
+    uint64_t trace_fed_samples_ = 0;
+    uint64_t trace_output_samples_ = 0;
+#endif
+    JitterBuffer jitter_buffer_;
+    // Producers blocked on a full queue, woken by the consumer after a pop
+    std::atomic<TaskHandle_t> encode_waiter_ = nullptr;
+    std::atomic<TaskHandle_t> decode_waiter_ = nullptr;
     // For server AEC
+    std::mutex timestamp_mutex_;
     std::deque<uint32_t> timestamp_queue_;
+    // Written from the audio processor output callback only
+    UplinkStats uplink_stats_;
+#if CONFIG_USE_UPLINK_SILENCE_SUPPRESSION
+    // Last suppressed frames, a ring starting at uplink_preroll_head_, sent ahead of the next speech
+    std::unique_ptr<AudioTask> uplink_preroll_[UPLINK_PREROLL_FRAMES];
+    size_t uplink_preroll_head_ = 0;
+    size_t uplink_preroll_count_ = 0;
+    int uplink_silent_ms_ = 0;
+    int uplink_keepalive_ms_ = 0;
+#endif
 
     bool wake_word_initialized_ = false;
     bool audio_processor_initialized_ = false;
     bool voice_detected_ = false;
     bool service_stopped_ = true;
     bool audio_input_need_warmup_ = false;
+    std::atomic<bool> decoder_reset_pending_ = false;
+    std::atomic<int> uplink_frame_duration_ms_ = OPUS_FRAME_DURATION_MS;
+    int encoder_frame_duration_ms_ = OPUS_FRAME_DURATION_MS;  // Owned by the encoder task
+    OpusComplexity opus_complexity_{CONFIG_OPUS_ENCODER_MAX_COMPLEXITY, CONFIG_OPUS_ENCODER_LOAD_PERCENT};  // Owned by the encoder task
+    std::atomic<uint32_t> playback_position_ms_ = 0;
+    // Packets pushed for decoding so far, guarded by decode_push_mutex_
+    uint32_t decode_packets_pushed_ = 0;
+    // Latest sentence id in the high half, the decode index of its first packet in the low half
+    std::atomic<uint64_t> sentence_mark_ = 0;
+    // Last sentence whose audio reached the codec and the playback position it started at
+    std::atomic<uint32_t> started_sentence_ = 0;
+    std::atomic<uint32_t> sentence_start_ms_ = 0;
 
     esp_timer_handle_t audio_power_timer_ = nullptr;
     std::chrono::steady_clock::time_point last_input_time_;
-    std::chrono::steady_clock::time_point last_output_time_;
+    // Last time the output was written or warmed up
+    std::atomic<int64_t> output_demand_us_ = 0;
+    // Guards codec output power and the idle gap histogram
+    std::mutex power_mutex_;
+    uint16_t output_gap_buckets_[AUDIO_POWER_GAP_BUCKETS] = {};  // 1 s buckets, the last one is longer
+    int output_power_timeout_ms_ = AUDIO_POWER_TIMEOUT_MS;
 
     void AudioInputTask();
     void AudioOutputTask();
-    void OpusCodecTask();
+    void OpusEncoderTask();
+    void OpusDecoderTask();
+    bool ConcealLostFrame(std::vector<int16_t>& pcm);
     void PushTaskToEncodeQueue(AudioTaskType type, std::vector<int16_t>&& pcm);
+    void PushEncodeTask(std::unique_ptr<AudioTask>& task);
+#if CONFIG_USE_UPLINK_SILENCE_SUPPRESSION
+    bool SuppressUplinkFrame(std::unique_ptr<AudioTask>& task);
+    void FlushUplinkPreroll();
+    void ClearUplinkPreroll();
+#endif
+    bool PopPacketToDecode(std::unique_ptr<AudioStreamPacket>& packet);
+    bool PopSoundPacket(std::unique_ptr<AudioStreamPacket>& packet, bool& new_sound);
+    bool PopCachedSoundChunk(std::unique_ptr<AudioTask>& task);
+    void RefillMixerInputs();
+    size_t MixSlice(size_t max_samples);
+    void CompleteSpeechFrame(const AudioTask& task);
+    void FinishPlaybackAbort(int64_t requested_us);
+    bool DecodeCueFrame();
+    void NotifyTask(TaskHandle_t task);
+    void WaitForSpace(std::atomic<TaskHandle_t>& waiter, const std::function<bool()>& has_space);
     void SetDecodeSampleRate(int sample_rate, int frame_duration);
     void CheckAndUpdateAudioPowerState();
+    void EnableOutputPower();
+    void NoteOutputDemand(int64_t now_us);
+    int LearnedOutputTimeoutMs();
+#if CONFIG_USE_AUDIO_LATENCY_TRACE
+    void TraceProcessorFeed(size_t samples);
+    int64_t TraceProcessorOutput(size_t samples);
+#endif
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,171 @@
+#include "jitter_buffer.h"
+
+#include <algorithm>
+
+// Arrivals further apart than this start a new talk spurt, not a jitter sample
+#define JITTER_BUFFER_IDLE_MS 1000
+// A missing frame is concealed after waiting this long for it
+#define JITTER_BUFFER_LOSS_WAIT_DIVISOR 2
+// Frames played without an underrun before the underrun bonus shrinks by one
+#define JITTER_BUFFER_BONUS_DECAY_FRAMES 100
+
+JitterBuffer::JitterBuffer() {
+    Reset();
+}
+
+void JitterBuffer::Reset() {
+    for (auto& slot : slots_) {
+        slot.reset();
+    }
+    count_ = 0;
+    started_ = false;
+    playing_ = false;
+    starved_ = false;
+    buffering_since_ms_ = 0;
+    gap_since_ms_ = 0;
+}
+
+void JitterBuffer::Restart(uint32_t sequence) {
+    Reset();
+    started_ = true;
+    expected_ = sequence;
+    last_pushed_ = sequence - 1;
+}
+
+void JitterBuffer::Push(std::unique_ptr<AudioStreamPacket> packet, int64_t now_ms) {
+    if (packet->frame_duration > 0) {
+        frame_ms_ = packet->frame_duration;
+    }
+    if (packet->sequence == 0) {
+        packet->sequence = started_ ? std::max(last_pushed_ + 1, expected_) : 1;
+    }
+    uint32_t sequence = packet->sequence;
+    UpdateJitter(sequence, now_ms);
+
+    if (!started_) {
+        Restart(sequence);
+    }
+    int32_t ahead = static_cast<int32_t>(sequence - expected_);
+    if (ahead < -4 * JITTER_BUFFER_MAX_PACKETS || ahead >= 4 * JITTER_BUFFER_MAX_PACKETS) {
+        /* The sequence jumped, the server started a new stream */
+        Restart(sequence);
+        ahead = 0;
+    } else if (ahead < 0) {
+        stats_.late++;
+        return;
+    }
+    while (ahead >= JITTER_BUFFER_MAX_PACKETS) {
+        /* Make room in the window, whatever is skipped is too old to play */
+        if (Slot(expected_)) {
+            Slot(expected_).reset();
+            count_--;
+            stats_.late++;
+        }
+        expected_++;
+        gap_since_ms_ = 0;
+        ahead--;
+    }
+
+    auto& slot = Slot(sequence);
+    if (slot) {
+        stats_.late++;
+        return;
+    }
+    if (starved_ && sequence == expected_) {
+        /* The stream continued after the buffer ran dry */
+        stats_.underruns++;
+        underrun_bonus_ = std::min(underrun_bonus_ + 1, JITTER_BUFFER_MAX_DEPTH);
+        played_since_underrun_ = 0;
+    }
+    starved_ = false;
+    slot = std::move(packet);
+    count_++;
+    if (static_cast<int32_t>(sequence - last_pushed_) > 0) {
+        last_pushed_ = sequence;
+    }
+}
+
+JitterBufferStatus JitterBuffer::Pop(int64_t now_ms, std::unique_ptr<AudioStreamPacket>& packet) {
+    if (!started_ || count_ == 0) {
+        /* Not an underrun by itself, decoded audio may still be playing, see Underrun() */
+        buffering_since_ms_ = 0;
+        gap_since_ms_ = 0;
+        return kJitterBufferEmpty;
+    }
+
+    int target = TargetDepth();
+    if (!playing_) {
+        if (buffering_since_ms_ == 0) {
+            buffering_since_ms_ = now_ms;
+        }
+        /* Hold audio back until the target depth is reached, or the stream tail would never play */
+        if (BufferedSpan() < static_cast<uint32_t>(target) && now_ms - buffering_since_ms_ < target * frame_ms_) {
+            return kJitterBufferBuffering;
+        }
+        playing_ = true;
+        buffering_since_ms_ = 0;
+    }
+
+    auto& slot = Slot(expected_);
+    if (slot) {
+        packet = std::move(slot);
+        count_--;
+        expected_++;
+        gap_since_ms_ = 0;
+        if (underrun_bonus_ > 0 && ++played_since_underrun_ >= JITTER_BUFFER_BONUS_DECAY_FRAMES) {
+            underrun_bonus_--;
+            played_since_underrun_ = 0;
+        }
+        return kJitterBufferPacket;
+    }
+
+    if (gap_since_ms_ == 0) {
+        gap_since_ms_ = now_ms;
+    }
+    /* Only more than the target waiting behind the gap gives up on it early, so a
+       packet overtaken by the next one still plays at the minimum depth */
+    if (count_ > static_cast<size_t>(target) ||
+        now_ms - gap_since_ms_ >= frame_ms_ / JITTER_BUFFER_LOSS_WAIT_DIVISOR) {
+        gap_since_ms_ = 0;
+        expected_++;
+        stats_.concealed++;
+        return kJitterBufferLost;
+    }
+    return kJitterBufferBuffering;
+}
+
+void JitterBuffer::Underrun() {
+    if (playing_) {
+        starved_ = true;
+        playing_ = false;
+    }
+}
+
+JitterBufferStats JitterBuffer::stats() const {
+    JitterBufferStats stats = stats_;
+    stats.jitter_ms = jitter_q4_ / 16;
+    stats.target_depth = TargetDepth();
+    return stats;
+}
+
+uint32_t JitterBuffer::BufferedSpan() const {
+    return count_ == 0 ? 0 : last_pushed_ - expected_ + 1;
+}
+
+int JitterBuffer::TargetDepth() const {
+    /* Cover three mean deviations of lateness, plus what recent underruns asked for */
+    int jitter_frames = (3 * static_cast<int>(jitter_q4_ / 16) + frame_ms_ - 1) / frame_ms_;
+    return std::clamp(JITTER_BUFFER_MIN_DEPTH + jitter_frames + underrun_bonus_,
+        JITTER_BUFFER_MIN_DEPTH, JITTER_BUFFER_MAX_DEPTH);
+}
+
+void JitterBuffer::UpdateJitter(uint32_t sequence, int64_t now_ms) {
+    /* RFC 3550 estimator, but only lateness counts: a burst of early packets is harmless */
+    int64_t transit = now_ms - static_cast<int64_t>(sequence) * frame_ms_;
+    if (last_arrival_ms_ != 0 && now_ms - last_arrival_ms_ < JITTER_BUFFER_IDLE_MS) {
+        int64_t d = std::clamp<int64_t>(transit - last_transit_ms_, 0, JITTER_BUFFER_MAX_DEPTH * frame_ms_);
+        jitter_q4_ = jitter_q4_ + d - jitter_q4_ / 16;
+    }
+    last_transit_ms_ = transit;
+    last_arrival_ms_ = now_ms;
+}
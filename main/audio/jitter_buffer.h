@@ -0,0 +1,87 @@
+#ifndef JITTER_BUFFER_H
+#define JITTER_BUFFER_H
+
+#include <array>
+#include <memory>
+#include <cstdint>
+
+#include "protocol.h"
+
+/*
+ * Reordering jitter buffer in front of the Opus decoder.
+ *
+ * Packets are keyed on AudioStreamPacket::sequence (0 means unsequenced, e.g.
+ * websocket or the audio testing playback, and gets the next sequence). The target depth
+ * follows the measured inter-arrival jitter (RFC 3550 estimator) and grows
+ * after an underrun. Running empty is normal for a stream paced in real time,
+ * the decoded audio queued downstream covers the wait, so only the caller can
+ * tell an underrun: it calls Underrun() when playback itself ran dry. A
+ * missing frame is reported as lost once enough later audio is buffered or
+ * it is overdue, so the caller can conceal it.
+ *
+ * Owned by the decoder task, not thread safe.
+ */
+
+#define JITTER_BUFFER_MAX_PACKETS 16
+#define JITTER_BUFFER_MIN_DEPTH 1
+#define JITTER_BUFFER_MAX_DEPTH 8
+
+enum JitterBufferStatus {
+    kJitterBufferEmpty,      // Nothing buffered, wait for a push
+    kJitterBufferBuffering,  // Holding audio back to reach the target depth
+    kJitterBufferPacket,     // Next packet in sequence
+    kJitterBufferLost,       // Next packet is missing, conceal one frame
+};
+
+struct JitterBufferStats {
+    uint32_t underruns = 0;
+    uint32_t late = 0;
+    uint32_t concealed = 0;
+    uint32_t jitter_ms = 0;
+    uint32_t target_depth = 0;
+};
+
+class JitterBuffer {
+public:
+    JitterBuffer();
+
+    void Reset();
+    void Push(std::unique_ptr<AudioStreamPacket> packet, int64_t now_ms);
+    JitterBufferStatus Pop(int64_t now_ms, std::unique_ptr<AudioStreamPacket>& packet);
+    // Playback ran out of audio: rebuffer, and count an underrun if the stream goes on
+    void Underrun();
+
+    bool full() const { return count_ == JITTER_BUFFER_MAX_PACKETS; }
+    bool empty() const { return count_ == 0; }
+    size_t size() const { return count_; }
+    JitterBufferStats stats() const;
+
+private:
+    std::array<std::unique_ptr<AudioStreamPacket>, JITTER_BUFFER_MAX_PACKETS> slots_;
+    size_t count_ = 0;
+    bool started_ = false;       // expected_ is valid
+    bool playing_ = false;       // false while (re)buffering
+    bool starved_ = false;       // playback ran dry mid stream, an in-order push counts an underrun
+    uint32_t expected_ = 0;      // next sequence to play
+    uint32_t last_pushed_ = 0;   // for numbering unsequenced packets
+    int frame_ms_ = 60;
+    int64_t buffering_since_ms_ = 0;
+    int64_t gap_since_ms_ = 0;   // when the expected packet was first found missing, 0 if none
+
+    // Jitter estimator state, jitter in 1/16 ms
+    int64_t last_arrival_ms_ = 0;
+    int64_t last_transit_ms_ = 0;
+    uint32_t jitter_q4_ = 0;
+    int underrun_bonus_ = 0;     // extra frames of depth after underruns, decays while playing
+    int played_since_underrun_ = 0;
+
+    JitterBufferStats stats_;
+
+    std::unique_ptr<AudioStreamPacket>& Slot(uint32_t sequence) { return slots_[sequence % JITTER_BUFFER_MAX_PACKETS]; }
+    uint32_t BufferedSpan() const;
+    int TargetDepth() const;
+    void Restart(uint32_t sequence);
+    void UpdateJitter(uint32_t sequence, int64_t now_ms);
+};
+
+#endif // JITTER_BUFFER_H
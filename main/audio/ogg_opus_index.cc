@@ -0,0 +1,155 @@
+#include "ogg_opus_index.h"
+
+#include <cstring>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <esp_log.h>
+
+#define TAG "OggOpusIndex"
+
+OggOpusIndex::OggOpusIndex(std::string_view ogg)
+    : data_(reinterpret_cast<const uint8_t*>(ogg.data())) {
+    const uint8_t* buf = data_;
+    size_t size = ogg.size();
+    size_t offset = 0;
+
+    auto find_page = [&](size_t start)->size_t {
+        for (size_t i = start; i + 4 <= size; ++i) {
+            if (buf[i] == 'O' && buf[i+1] == 'g' && buf[i+2] == 'g' && buf[i+3] == 'S') return i;
+        }
+        return static_cast<size_t>(-1);
+    };
+
+    bool seen_head = false;
+    bool seen_tags = false;
+    bool continuing = false;  // the page starts with the tail of a packet we skipped
+    int skipped = 0;
+
+    while (true) {
+        size_t pos = find_page(offset);
+        if (pos == static_cast<size_t>(-1)) break;
+        offset = pos;
+        if (offset + 27 > size) break;
+
+        const uint8_t* page = buf + offset;
+        uint8_t page_segments = page[26];
+        size_t seg_table_off = offset + 27;
+        if (seg_table_off + page_segments > size) break;
+
+        size_t body_size = 0;
+        for (size_t i = 0; i < page_segments; ++i) body_size += page[27 + i];
+
+        size_t body_off = seg_table_off + page_segments;
+        if (body_off + body_size > size) break;
+
+        // Parse packets using lacing
+        size_t cur = body_off;
+        size_t seg_idx = 0;
+        while (seg_idx < page_segments) {
+            size_t pkt_len = 0;
+            size_t pkt_start = cur;
+            bool continued = false;
+            do {
+                uint8_t l = page[27 + seg_idx++];
+                pkt_len += l;
+                cur += l;
+                continued = (l == 255);
+            } while (continued && seg_idx < page_segments);
+
+            bool tail = continuing;
+            continuing = continued;
+            if (tail || continued) {
+                skipped++;
+                continue;
+            }
+            if (pkt_len == 0) continue;
+            const uint8_t* pkt_ptr = buf + pkt_start;
+
+            if (!seen_head) {
+                // OpusHead: [0-7] "OpusHead", [8] version, [9] channel_count, [10-11] pre_skip
+                // [12-15] input_sample_rate (little-endian), [16-17] output_gain, [18] mapping_family
+                if (pkt_len >= 19 && std::memcmp(pkt_ptr, "OpusHead", 8) == 0) {
+                    seen_head = true;
+                    sample_rate_ = pkt_ptr[12] | (pkt_ptr[13] << 8) | (pkt_ptr[14] << 16) | (pkt_ptr[15] << 24);
+                }
+                continue;
+            }
+            if (!seen_tags) {
+                // Expect OpusTags in second packet
+                if (pkt_len >= 8 && std::memcmp(pkt_ptr, "OpusTags", 8) == 0) {
+                    seen_tags = true;
+                }
+                continue;
+            }
+
+            if (pkt_len > UINT16_MAX) {
+                skipped++;
+                continue;
+            }
+            packets_.push_back({ static_cast<uint32_t>(pkt_start), static_cast<uint16_t>(pkt_len) });
+        }
+
+        offset = body_off + body_size;
+    }
+
+    packets_.shrink_to_fit();
+    if (!packets_.empty()) {
+        int duration_ms = PacketDurationMs(packet_data(0), packet_size(0));
+        if (duration_ms > 0) {
+            frame_duration_ms_ = duration_ms;
+        }
+    }
+    if (skipped > 0) {
+        ESP_LOGW(TAG, "Skipped %d packets split across pages or too large", skipped);
+    }
+}
+
+int OggOpusIndex::PacketDurationMs(const uint8_t* packet, size_t size) {
+    if (size == 0) {
+        return 0;
+    }
+    /* Frame size in 1/10 ms from the configuration number: SILK 10/20/40/60, hybrid 10/20, CELT 2.5/5/10/20 */
+    int config = packet[0] >> 3;
+    int frame_tenths;
+    if (config < 12) {
+        static const int kSilk[] = {100, 200, 400, 600};
+        frame_tenths = kSilk[config & 3];
+    } else if (config < 16) {
+        frame_tenths = config & 1 ? 200 : 100;
+    } else {
+        frame_tenths = 25 << (config & 3);
+    }
+
+    int frames;
+    switch (packet[0] & 3) {
+    case 0:
+        frames = 1;
+        break;
+    case 1:
+    case 2:
+        frames = 2;
+        break;
+    default:
+        if (size < 2) {
+            return 0;
+        }
+        frames = packet[1] & 0x3F;
+        break;
+    }
+    return frames * frame_tenths / 10;
+}
+
+const OggOpusIndex* OggOpusIndex::Get(std::string_view ogg) {
+    static std::mutex mutex;
+    static std::map<const char*, std::unique_ptr<OggOpusIndex>> cache;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    auto& index = cache[ogg.data()];
+    if (!index) {
+        index = std::make_unique<OggOpusIndex>(ogg);
+        ESP_LOGI(TAG, "Indexed sound %p: %u packets, sample_rate=%d, frame_duration=%dms", ogg.data(), index->size(),
+            index->sample_rate(), index->frame_duration_ms());
+    }
+    return index.get();
+}
@@ -0,0 +1,50 @@
+#ifndef OGG_OPUS_INDEX_H
+#define OGG_OPUS_INDEX_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+/*
+ * Packet index of an Ogg/Opus sound.
+ *
+ * The container is parsed once into (offset, length) pairs of the audio
+ * packets, after the OpusHead and OpusTags headers. Packets are read straight
+ * from the sound data, which must outlive the index; the Lang::Sounds blobs
+ * live in flash for the lifetime of the firmware, and Get() caches one index
+ * per blob. A packet continued across pages is not contiguous and is skipped.
+ * The frame duration is read from the TOC byte of the first audio packet; the
+ * sounds are encoded with one frame size throughout.
+ */
+
+struct OggOpusPacket {
+    uint32_t offset;
+    uint16_t length;
+};
+
+class OggOpusIndex {
+public:
+    explicit OggOpusIndex(std::string_view ogg);
+
+    // Parsed once per sound data pointer, thread safe
+    static const OggOpusIndex* Get(std::string_view ogg);
+
+    // Duration of an Opus packet from its TOC byte (RFC 6716, 3.1), 0 if it is malformed
+    static int PacketDurationMs(const uint8_t* packet, size_t size);
+
+    int sample_rate() const { return sample_rate_; }
+    int frame_duration_ms() const { return frame_duration_ms_; }
+    size_t size() const { return packets_.size(); }
+    bool empty() const { return packets_.empty(); }
+    const uint8_t* packet_data(size_t index) const { return data_ + packets_[index].offset; }
+    size_t packet_size(size_t index) const { return packets_[index].length; }
+
+private:
+    const uint8_t* data_;
+    int sample_rate_ = 16000;
+    int frame_duration_ms_ = 60;
+    std::vector<OggOpusPacket> packets_;
+};
+
+#endif // OGG_OPUS_INDEX_H
@@ -0,0 +1,44 @@
+#include "opus_complexity.h"
+
+#include <algorithm>
+
+OpusComplexity::OpusComplexity(int max_complexity, int load_percent)
+    : max_complexity_(std::clamp(max_complexity, 0, 10)), load_percent_(std::clamp(load_percent, 1, 100)) {
+}
+
+void OpusComplexity::Reset() {
+    complexity_ = 0;
+    average_us_ = 0;
+    frames_ = 0;
+    calm_frames_ = 0;
+}
+
+bool OpusComplexity::Update(int64_t encode_us, int frame_duration_ms) {
+    if (max_complexity_ == 0) {
+        return false;
+    }
+
+    int64_t budget_us = int64_t(frame_duration_ms) * 10 * load_percent_;
+    average_us_ = frames_ == 0 ? encode_us : average_us_ + (encode_us - average_us_) / 8;
+    frames_++;
+
+    int next = complexity_;
+    if (complexity_ > 0 && (encode_us > budget_us ||
+            (frames_ >= OPUS_COMPLEXITY_SETTLE_FRAMES && average_us_ * 4 > budget_us * 3))) {
+        next = complexity_ - 1;
+    } else if (frames_ >= OPUS_COMPLEXITY_SETTLE_FRAMES && average_us_ * 3 < budget_us) {
+        if (++calm_frames_ >= OPUS_COMPLEXITY_RAISE_FRAMES && complexity_ < max_complexity_) {
+            next = complexity_ + 1;
+        }
+    } else {
+        calm_frames_ = 0;
+    }
+
+    if (next == complexity_) {
+        return false;
+    }
+    complexity_ = next;
+    frames_ = 0;
+    calm_frames_ = 0;
+    return true;
+}
@@ -0,0 +1,42 @@
+#ifndef OPUS_COMPLEXITY_H
+#define OPUS_COMPLEXITY_H
+
+#include <cstdint>
+
+/*
+ * Picks the Opus encoder complexity from measured encode times.
+ *
+ * The budget is load_percent of the frame duration. Encode times are wall
+ * clock, so preemption by busier tasks on the same core counts against the
+ * budget too. Complexity drops one step as soon as a frame overruns the whole
+ * budget or the average passes 3/4 of it, and rises one step only after the
+ * average stayed under 1/3 of it for OPUS_COMPLEXITY_RAISE_FRAMES frames.
+ * Every change restarts the measurement.
+ *
+ * Plain C++, owned by the encoder task, not thread safe.
+ */
+
+#define OPUS_COMPLEXITY_SETTLE_FRAMES 8
+#define OPUS_COMPLEXITY_RAISE_FRAMES 50
+
+class OpusComplexity {
+public:
+    OpusComplexity(int max_complexity, int load_percent);
+
+    // Returns true if complexity() changed
+    bool Update(int64_t encode_us, int frame_duration_ms);
+    void Reset();
+
+    int complexity() const { return complexity_; }
+    int64_t average_us() const { return average_us_; }
+
+private:
+    int max_complexity_;
+    int load_percent_;
+    int complexity_ = 0;
+    int64_t average_us_ = 0;  // Moving average, 1/8 weight per frame
+    int frames_ = 0;          // Frames measured since the last change
+    int calm_frames_ = 0;     // Consecutive frames with a low average
+};
+
+#endif // OPUS_COMPLEXITY_H
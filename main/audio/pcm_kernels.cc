@@ -0,0 +1,115 @@
+#include "pcm_kernels.h"
+
+#include <climits>
+
+namespace pcm {
+
+namespace {
+
+inline int16_t SaturateInt16(int32_t value) {
+    return value > INT16_MAX ? INT16_MAX : value < -INT16_MAX ? -INT16_MAX : static_cast<int16_t>(value);
+}
+
+inline int32_t SaturateInt32(int64_t value) {
+    return value > INT32_MAX ? INT32_MAX : value < INT32_MIN ? INT32_MIN : static_cast<int32_t>(value);
+}
+
+} // namespace
+
+/*
+ * Loops are branch free per sample and use restrict pointers so the compiler
+ * can unroll and vectorize them.
+ */
+
+void ScaleToInt32(const int16_t* __restrict in, int32_t* __restrict out, size_t samples, int32_t factor) {
+    for (size_t i = 0; i < samples; i++) {
+        out[i] = SaturateInt32(int64_t(in[i]) * factor);
+    }
+}
+
+void ShiftToInt16(const int32_t* __restrict in, int16_t* __restrict out, size_t samples, int shift) {
+    for (size_t i = 0; i < samples; i++) {
+        out[i] = SaturateInt16(in[i] >> shift);
+    }
+}
+
+void ApplyGain(int16_t* data, size_t samples, int gain) {
+    for (size_t i = 0; i < samples; i++) {
+        data[i] = SaturateInt16(int32_t(data[i]) * gain);
+    }
+}
+
+void MixInto(int16_t* __restrict dst, const int16_t* __restrict src, size_t samples) {
+    for (size_t i = 0; i < samples; i++) {
+        dst[i] = SaturateInt16(int32_t(dst[i]) + src[i]);
+    }
+}
+
+void FadeOut(int16_t* data, size_t samples) {
+    int32_t length = samples;
+    for (int32_t i = 0; i < length; i++) {
+        data[i] = int32_t(data[i]) * (length - 1 - i) / length;
+    }
+}
+
+void Deinterleave(const int16_t* __restrict in, int16_t* __restrict left, int16_t* __restrict right, size_t frames) {
+    for (size_t i = 0; i < frames; i++) {
+        left[i] = in[i * 2];
+        right[i] = in[i * 2 + 1];
+    }
+}
+
+void Interleave(const int16_t* __restrict left, const int16_t* __restrict right, int16_t* __restrict out, size_t frames) {
+    for (size_t i = 0; i < frames; i++) {
+        out[i * 2] = left[i];
+        out[i * 2 + 1] = right[i];
+    }
+}
+
+int32_t DotProduct(const int16_t* __restrict a, const int16_t* __restrict b, size_t samples) {
+    /* Four independent accumulators keep the multiply-accumulate pipeline busy */
+    int32_t sum0 = 0, sum1 = 0, sum2 = 0, sum3 = 0;
+    size_t i = 0;
+    for (; i + 4 <= samples; i += 4) {
+        sum0 += int32_t(a[i]) * b[i];
+        sum1 += int32_t(a[i + 1]) * b[i + 1];
+        sum2 += int32_t(a[i + 2]) * b[i + 2];
+        sum3 += int32_t(a[i + 3]) * b[i + 3];
+    }
+    for (; i < samples; i++) {
+        sum0 += int32_t(a[i]) * b[i];
+    }
+    return sum0 + sum1 + sum2 + sum3;
+}
+
+uint16_t Peak(const int16_t* data, size_t samples) {
+    int32_t peak = 0;
+    for (size_t i = 0; i < samples; i++) {
+        int32_t value = data[i] < 0 ? -int32_t(data[i]) : data[i];
+        peak = value > peak ? value : peak;
+    }
+    return peak > UINT16_MAX ? UINT16_MAX : peak;
+}
+
+uint16_t Rms(const int16_t* data, size_t samples) {
+    if (samples == 0) {
+        return 0;
+    }
+    uint64_t sum = 0;
+    for (size_t i = 0; i < samples; i++) {
+        sum += uint32_t(int32_t(data[i]) * data[i]);
+    }
+    uint32_t mean = sum / samples;
+
+    /* Integer square root, the result fits 16 bits */
+    uint32_t root = 0;
+    for (uint32_t bit = 1u << 15; bit != 0; bit >>= 1) {
+        uint32_t candidate = root | bit;
+        if (candidate * candidate <= mean) {
+            root = candidate;
+        }
+    }
+    return root;
+}
+
+} // namespace pcm
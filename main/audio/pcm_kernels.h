@@ -0,0 +1,40 @@
+#ifndef PCM_KERNELS_H
+#define PCM_KERNELS_H
+
+#include <cstddef>
+#include <cstdint>
+
+/*
+ * Inner loops shared by the codecs and the audio service.
+ *
+ * Plain C++ with no ESP-IDF dependency, so it also builds on a host. Buffers
+ * must not overlap unless noted. The int16 saturating kernels clamp to
+ * [-32767, 32767], as the I2S codecs always did.
+ */
+namespace pcm {
+
+// out = clamp(in * factor), factor in Q16 (65536 = unity), for 32-bit I2S slots
+void ScaleToInt32(const int16_t* in, int32_t* out, size_t samples, int32_t factor);
+// out = clamp(in >> shift), 32-bit I2S slots to 16-bit samples
+void ShiftToInt16(const int32_t* in, int16_t* out, size_t samples, int shift);
+// data = clamp(data * gain), in place
+void ApplyGain(int16_t* data, size_t samples, int gain);
+// dst = clamp(dst + src), in place
+void MixInto(int16_t* dst, const int16_t* src, size_t samples);
+// Linear ramp from unity gain down to silence across the buffer, in place
+void FadeOut(int16_t* data, size_t samples);
+
+void Deinterleave(const int16_t* in, int16_t* left, int16_t* right, size_t frames);
+void Interleave(const int16_t* left, const int16_t* right, int16_t* out, size_t frames);
+
+// sum(a[i] * b[i]) with 32-bit accumulators, the caller keeps the sum in range
+int32_t DotProduct(const int16_t* a, const int16_t* b, size_t samples);
+
+// Largest absolute sample value
+uint16_t Peak(const int16_t* data, size_t samples);
+// Root mean square, rounded down
+uint16_t Rms(const int16_t* data, size_t samples);
+
+} // namespace pcm
+
+#endif // PCM_KERNELS_H
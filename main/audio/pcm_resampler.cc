@@ -0,0 +1,129 @@
+#include "pcm_resampler.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <numeric>
+
+#include "pcm_kernels.h"
+
+// Taps per phase for every input sample period the output is wider than the input
+#define RESAMPLER_BASE_TAPS 24
+// Passband edge relative to the lower of the two Nyquist frequencies
+#define RESAMPLER_CUTOFF 0.9
+#define RESAMPLER_KAISER_BETA 7.0
+// Input samples filtered per pass, bounds history_
+#define RESAMPLER_CHUNK_SAMPLES 256
+
+namespace {
+
+double BesselI0(double x) {
+    double sum = 1.0, term = 1.0;
+    for (int k = 1; k < 32; k++) {
+        term *= (x / (2 * k)) * (x / (2 * k));
+        sum += term;
+    }
+    return sum;
+}
+
+} // namespace
+
+bool PcmResampler::Configure(int input_sample_rate, int output_sample_rate) {
+    if (input_sample_rate <= 0 || output_sample_rate <= 0) {
+        return false;
+    }
+    int divisor = std::gcd(input_sample_rate, output_sample_rate);
+    int up = output_sample_rate / divisor;
+    int down = input_sample_rate / divisor;
+    if (up > PCM_RESAMPLER_MAX_PHASES) {
+        return false;
+    }
+
+    input_sample_rate_ = input_sample_rate;
+    output_sample_rate_ = output_sample_rate;
+    up_ = up;
+    down_ = down;
+    taps_ = RESAMPLER_BASE_TAPS * ((std::max(up, down) + up - 1) / up);
+
+    /* Prototype lowpass at up * input rate, cutoff in cycles per upsampled sample */
+    size_t length = taps_ * up_;
+    double cutoff = 0.5 * RESAMPLER_CUTOFF / std::max(up_, down_);
+    double center = (length - 1) / 2.0;
+    double window_norm = BesselI0(RESAMPLER_KAISER_BETA);
+    std::vector<double> prototype(length);
+    for (size_t i = 0; i < length; i++) {
+        double t = i - center;
+        double sinc = t == 0 ? 2 * cutoff : std::sin(2 * M_PI * cutoff * t) / (M_PI * t);
+        double ratio = t / (center + 1);
+        double window = BesselI0(RESAMPLER_KAISER_BETA * std::sqrt(1 - ratio * ratio)) / window_norm;
+        prototype[i] = sinc * window * up_;
+    }
+
+    /* Every phase is rounded to unity DC gain, the rounding error goes to its largest tap */
+    coefficients_.assign(taps_ * up_, 0);
+    for (int phase = 0; phase < up_; phase++) {
+        double sum = 0;
+        for (size_t k = 0; k < taps_; k++) {
+            sum += prototype[phase + k * up_];
+        }
+        int16_t* taps = &coefficients_[phase * taps_];
+        int32_t total = 0;
+        size_t largest = 0;
+        for (size_t k = 0; k < taps_; k++) {
+            int16_t value = std::lround(prototype[phase + k * up_] / sum * 32768);
+            taps[taps_ - 1 - k] = value;
+            total += value;
+            if (std::abs(value) > std::abs(taps[largest])) {
+                largest = taps_ - 1 - k;
+            }
+        }
+        taps[largest] += 32768 - total;
+    }
+
+    history_.assign(taps_ - 1 + RESAMPLER_CHUNK_SAMPLES, 0);
+    Reset();
+    return true;
+}
+
+void PcmResampler::Reset() {
+    std::fill(history_.begin(), history_.end(), 0);
+    next_position_ = 0;
+}
+
+size_t PcmResampler::GetOutputSamples(size_t input_samples) const {
+    size_t end = input_samples * up_;
+    if (up_ == 0 || end <= next_position_) {
+        return 0;
+    }
+    return (end - next_position_ + down_ - 1) / down_;
+}
+
+size_t PcmResampler::Process(const int16_t* input, size_t input_samples, int16_t* output) {
+    if (up_ == 0) {
+        return 0;
+    }
+
+    size_t produced = 0;
+    size_t keep = taps_ - 1;
+    while (input_samples > 0) {
+        size_t chunk = std::min<size_t>(input_samples, RESAMPLER_CHUNK_SAMPLES);
+        std::memcpy(history_.data() + keep, input, chunk * sizeof(int16_t));
+
+        /* Output at upsampled position u uses input u / up_ and phase u % up_, the taps
+         * start keep samples before that input, which is history_[u / up_] */
+        size_t end = chunk * up_;
+        size_t position = next_position_;
+        for (; position < end; position += down_) {
+            const int16_t* taps = &coefficients_[(position % up_) * taps_];
+            int32_t sum = pcm::DotProduct(taps, history_.data() + position / up_, taps_);
+            sum = (sum + (1 << 14)) >> 15;
+            output[produced++] = sum > INT16_MAX ? INT16_MAX : sum < -INT16_MAX ? -INT16_MAX : sum;
+        }
+        next_position_ = position - end;
+
+        std::memmove(history_.data(), history_.data() + chunk, keep * sizeof(int16_t));
+        input += chunk;
+        input_samples -= chunk;
+    }
+    return produced;
+}
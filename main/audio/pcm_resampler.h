@@ -0,0 +1,51 @@
+#ifndef PCM_RESAMPLER_H
+#define PCM_RESAMPLER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/*
+ * Streaming fixed-point polyphase resampler for 16-bit mono PCM.
+ *
+ * The rate ratio is reduced to up / down (24k -> 16k is 2 / 3). Configure()
+ * designs one Kaiser windowed sinc lowpass for the ratio and splits it into
+ * `up` phases of Q15 taps, stored reversed so every output sample is one
+ * contiguous pcm::DotProduct over the input history. The table is built once
+ * per Configure(), the per-sample path is integer only. Ratios up to
+ * PCM_RESAMPLER_MAX_PHASES phases are supported, which covers 44.1k to 16k
+ * (160 / 441) with a table of about 20 KB; the common 16k / 24k / 48k ratios
+ * need at most 3 phases.
+ *
+ * Filter state is kept across calls, so frames of any size resample without
+ * seams. Process() writes exactly GetOutputSamples(samples) into the caller's
+ * buffer. Plain C++, not thread safe.
+ */
+
+#define PCM_RESAMPLER_MAX_PHASES 160
+
+class PcmResampler {
+public:
+    bool Configure(int input_sample_rate, int output_sample_rate);
+    void Reset();
+    bool configured() const { return up_ > 0; }
+
+    // Output samples the next Process() call with this many input samples produces
+    size_t GetOutputSamples(size_t input_samples) const;
+    size_t Process(const int16_t* input, size_t input_samples, int16_t* output);
+
+    int input_sample_rate() const { return input_sample_rate_; }
+    int output_sample_rate() const { return output_sample_rate_; }
+
+private:
+    int input_sample_rate_ = 0;
+    int output_sample_rate_ = 0;
+    int up_ = 0;
+    int down_ = 0;
+    size_t taps_ = 0;                  // Per phase
+    std::vector<int16_t> coefficients_; // up_ phases of taps_, reversed
+    std::vector<int16_t> history_;     // Last taps_ - 1 input samples, then the chunk being filtered
+    size_t next_position_ = 0;         // Next output, in input samples * up_ from the chunk start
+};
+
+#endif // PCM_RESAMPLER_H
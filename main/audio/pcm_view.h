@@ -0,0 +1,54 @@
+#ifndef PCM_VIEW_H
+#define PCM_VIEW_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/*
+ * Non-owning, stride-aware view of one channel of interleaved PCM, so the mic
+ * channel of a mic + reference capture can be read without copying it out.
+ * Only valid while the underlying buffer is alive and not resized.
+ */
+class PcmView {
+public:
+    PcmView(const int16_t* data, size_t frames, size_t stride = 1)
+        : data_(data), frames_(frames), stride_(stride) {}
+
+    static PcmView Channel(const std::vector<int16_t>& interleaved, int channels, int channel) {
+        return PcmView(interleaved.data() + channel, interleaved.size() / channels, channels);
+    }
+
+    size_t size() const { return frames_; }
+    bool contiguous() const { return stride_ == 1; }
+    // Sample pointer, only meaningful when contiguous()
+    const int16_t* data() const { return data_; }
+    int16_t operator[](size_t i) const { return data_[i * stride_]; }
+
+    // Copies the channel out, allocation free once out has the capacity
+    void CopyTo(std::vector<int16_t>& out) const {
+        out.resize(frames_);
+        for (size_t i = 0; i < frames_; i++) {
+            out[i] = data_[i * stride_];
+        }
+    }
+
+private:
+    const int16_t* data_;
+    size_t frames_;
+    size_t stride_;
+};
+
+// Keeps one channel of interleaved PCM, compacted in place
+inline void KeepChannelInPlace(std::vector<int16_t>& pcm, int channels, int channel) {
+    if (channels <= 1) {
+        return;
+    }
+    size_t frames = pcm.size() / channels;
+    for (size_t i = 0; i < frames; i++) {
+        pcm[i] = pcm[i * channels + channel];
+    }
+    pcm.resize(frames);
+}
+
+#endif // PCM_VIEW_H
@@ -0,0 +1,89 @@
+#include "pre_roll_buffer.h"
+
+#include <algorithm>
+#include <cstring>
+#include <esp_heap_caps.h>
+#include <esp_log.h>
+
+#define TAG "PreRollBuffer"
+
+PreRollBuffer::PreRollBuffer(size_t capacity_samples) {
+    size_t bytes = capacity_samples * sizeof(int16_t);
+    buffer_ = static_cast<int16_t*>(heap_caps_malloc(bytes, MALLOC_CAP_SPIRAM));
+    if (buffer_ == nullptr) {
+        buffer_ = static_cast<int16_t*>(heap_caps_malloc(bytes, MALLOC_CAP_DEFAULT));
+    }
+    if (buffer_ == nullptr) {
+        ESP_LOGE(TAG, "Failed to allocate %u bytes, wake word audio is not kept", bytes);
+        return;
+    }
+    capacity_ = capacity_samples;
+}
+
+PreRollBuffer::~PreRollBuffer() {
+    heap_caps_free(buffer_);
+}
+
+void PreRollBuffer::Write(const int16_t* data, size_t samples) {
+    if (capacity_ == 0 || state_.load(std::memory_order_acquire) != kWriting) {
+        return;
+    }
+    if (samples > capacity_) {
+        data += samples - capacity_;
+        samples = capacity_;
+    }
+    size_t first = std::min(samples, capacity_ - head_);
+    std::memcpy(buffer_ + head_, data, first * sizeof(int16_t));
+    std::memcpy(buffer_, data + first, (samples - first) * sizeof(int16_t));
+    head_ = (head_ + samples) % capacity_;
+    size_ = std::min(size_ + samples, capacity_);
+}
+
+void PreRollBuffer::Write(const PcmView& data) {
+    if (data.contiguous()) {
+        Write(data.data(), data.size());
+        return;
+    }
+    if (capacity_ == 0 || state_.load(std::memory_order_acquire) != kWriting) {
+        return;
+    }
+    for (size_t i = 0; i < data.size(); i++) {
+        buffer_[head_] = data[i];
+        head_ = head_ + 1 == capacity_ ? 0 : head_ + 1;
+    }
+    size_ = std::min(size_ + data.size(), capacity_);
+}
+
+void PreRollBuffer::Snapshot() {
+    int expected = kWriting;
+    state_.compare_exchange_strong(expected, kFrozen, std::memory_order_acq_rel);
+}
+
+void PreRollBuffer::Thaw() {
+    int expected = kFrozen;
+    if (state_.compare_exchange_strong(expected, kReading, std::memory_order_acq_rel)) {
+        EndRead();
+    }
+}
+
+bool PreRollBuffer::BeginRead() {
+    // Only the writer may freeze the ring; taking it from kWriting would race a
+    // Write() in progress, and a Thaw() could hand it back to the writer mid-read
+    int expected = kFrozen;
+    return state_.compare_exchange_strong(expected, kReading, std::memory_order_acq_rel);
+}
+
+size_t PreRollBuffer::Read(size_t offset, size_t max_samples, const int16_t** data) const {
+    if (offset >= size_) {
+        return 0;
+    }
+    size_t start = (head_ + capacity_ - size_ + offset) % capacity_;
+    *data = buffer_ + start;
+    return std::min({max_samples, size_ - offset, capacity_ - start});
+}
+
+void PreRollBuffer::EndRead() {
+    head_ = 0;
+    size_ = 0;
+    state_.store(kWriting, std::memory_order_release);
+}
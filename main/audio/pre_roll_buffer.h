@@ -0,0 +1,55 @@
+#ifndef PRE_ROLL_BUFFER_H
+#define PRE_ROLL_BUFFER_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#include "pcm_view.h"
+
+/*
+ * The last few seconds of mono microphone PCM, kept for the wake word.
+ *
+ * One block is allocated up front (PSRAM when there is some) and written as
+ * a ring, so feeding audio never allocates. At a detection the writer calls
+ * Snapshot(): later writes are dropped and the audio stays as it was. The
+ * encoder then takes it with BeginRead(), walks it through Read(), which
+ * returns pointers into the ring rather than copies, and hands it back with
+ * EndRead(). Thaw() drops a snapshot nobody read, e.g. when detection is
+ * re-armed after a wake word that was not sent.
+ *
+ * One writer thread; the state hand-off orders it with the reader.
+ */
+class PreRollBuffer {
+public:
+    explicit PreRollBuffer(size_t capacity_samples);
+    ~PreRollBuffer();
+    PreRollBuffer(const PreRollBuffer&) = delete;
+    PreRollBuffer& operator=(const PreRollBuffer&) = delete;
+
+    // Overwrites the oldest samples, ignored while a snapshot is held
+    void Write(const int16_t* data, size_t samples);
+    void Write(const PcmView& data);
+    void Snapshot();
+    void Thaw();
+
+    // Takes a snapshot for reading, false if there is none or another read holds it
+    bool BeginRead();
+    // Contiguous run of at most max_samples, offset samples after the oldest one held, 0 at the end
+    size_t Read(size_t offset, size_t max_samples, const int16_t** data) const;
+    // Drops the audio and accepts writes again
+    void EndRead();
+
+    size_t size() const { return size_; }
+
+private:
+    enum State { kWriting, kFrozen, kReading };
+
+    int16_t* buffer_ = nullptr;
+    size_t capacity_ = 0;
+    size_t head_ = 0;  // Next write position
+    size_t size_ = 0;
+    std::atomic<int> state_ = kWriting;
+};
+
+#endif // PRE_ROLL_BUFFER_H
@@ -63,6 +63,8 @@ void AfeAudioProcessor::Initialize(AudioCodec* codec, int frame_duration_ms, srm
     afe_config->aec_init = false;
     afe_config->vad_init = true;
 #endif
+    vad_available_ = afe_config->vad_init;
+    vad_running_ = vad_available_;
 
     afe_iface_ = esp_afe_handle_from_config(afe_config);
     afe_data_ = afe_iface_->create_from_config(afe_config);
@@ -118,6 +120,10 @@ void AfeAudioProcessor::OnVadStateChange(std::function<void(bool speaking)> call
     vad_state_change_callback_ = callback;
 }
 
+bool AfeAudioProcessor::IsVadRunning() {
+    return vad_running_;
+}
+
 void AfeAudioProcessor::AudioProcessorTask() {
     auto fetch_size = afe_iface_->get_fetch_chunksize(afe_data_);
     auto feed_size = afe_iface_->get_feed_chunksize(afe_data_);
@@ -150,6 +156,13 @@ void AfeAudioProcessor::AudioProcessorTask() {
         }
 
         if (output_callback_) {
+            /* Pick up a new frame size here, this task owns output_buffer_ */
+            int pending = pending_frame_samples_.exchange(0);
+            if (pending > 0 && pending != frame_samples_) {
+                frame_samples_ = pending;
+                output_buffer_.clear();
+                output_buffer_.reserve(frame_samples_);
+            }
             size_t samples = res->data_size / sizeof(int16_t);
             
             // Add data to buffer
@@ -172,10 +185,15 @@ void AfeAudioProcessor::AudioProcessorTask() {
     }
 }
 
+void AfeAudioProcessor::SetFrameDuration(int frame_duration_ms) {
+    pending_frame_samples_ = frame_duration_ms * 16000 / 1000;
+}
+
 void AfeAudioProcessor::EnableDeviceAec(bool enable) {
     if (enable) {
 #if CONFIG_USE_DEVICE_AEC
         afe_iface_->disable_vad(afe_data_);
+        vad_running_ = false;
         afe_iface_->enable_aec(afe_data_);
 #else
         ESP_LOGE(TAG, "Device AEC is not supported");
@@ -183,5 +201,6 @@ void AfeAudioProcessor::EnableDeviceAec(bool enable) {
     } else {
         afe_iface_->disable_aec(afe_data_);
         afe_iface_->enable_vad(afe_data_);
+        vad_running_ = vad_available_;
     }
 }
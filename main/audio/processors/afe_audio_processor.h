@@ -9,6 +9,7 @@
 #include <string>
 #include <vector>
 #include <functional>
+#include <atomic>
 
 #include "audio_processor.h"
 #include "audio_codec.h"
@@ -25,7 +26,9 @@ public:
     bool IsRunning() override;
     void OnOutput(std::function<void(std::vector<int16_t>&& data)> callback) override;
     void OnVadStateChange(std::function<void(bool speaking)> callback) override;
+    bool IsVadRunning() override;
     size_t GetFeedSize() override;
+    void SetFrameDuration(int frame_duration_ms) override;
     void EnableDeviceAec(bool enable) override;
 
 private:
@@ -36,7 +39,10 @@ private:
     std::function<void(bool speaking)> vad_state_change_callback_;
     AudioCodec* codec_ = nullptr;
     int frame_samples_ = 0;
+    std::atomic<int> pending_frame_samples_ = 0;
     bool is_speaking_ = false;
+    bool vad_available_ = false;             // Built with a VAD, not the case with device AEC
+    std::atomic<bool> vad_running_ = false;  // Read by the audio service on the output callback
     std::vector<int16_t> output_buffer_;
 
     void AudioProcessorTask();
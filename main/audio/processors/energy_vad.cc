@@ -0,0 +1,101 @@
+#include "energy_vad.h"
+
+#include <algorithm>
+
+#define VAD_BLOCK_MS 10
+// Floor assumed until the first blocks have been measured, about 30 RMS
+#define VAD_INITIAL_FLOOR 1000
+// Blocks within 1/16 of the previous one's energy before a level counts as stationary
+#define VAD_STEADY_BLOCKS 10
+
+EnergyVad::EnergyVad(int sample_rate, const EnergyVadConfig& config)
+    : block_samples_(sample_rate * VAD_BLOCK_MS / 1000) {
+    Configure(config);
+    Reset();
+}
+
+void EnergyVad::Configure(const EnergyVadConfig& config) {
+    /* 10^(dB/10) in Q8, one dB at a time (322 / 256 ~ 1.2589) */
+    uint32_t snr = 256;
+    for (int i = 0; i < std::clamp(config.snr_db, 0, 30); i++) {
+        snr = snr * 322 / 256;
+    }
+    snr_q8_ = snr;
+
+    uint32_t min_rms = std::clamp(config.min_rms, 0, 32767);
+    min_energy_ = min_rms * min_rms;
+    max_crossings_q8_ = std::clamp(config.max_zcr, 1, 100) * 256 / 100;
+    onset_blocks_ = std::max(1, config.onset_ms / VAD_BLOCK_MS);
+    hangover_blocks_ = std::max(1, config.hangover_ms / VAD_BLOCK_MS);
+}
+
+void EnergyVad::Reset() {
+    noise_floor_ = VAD_INITIAL_FLOOR;
+    last_energy_ = 0;
+    steady_blocks_ = 0;
+    voiced_run_ = 0;
+    silent_run_ = 0;
+    speaking_ = false;
+}
+
+bool EnergyVad::Process(const int16_t* data, size_t samples) {
+    while (samples > 0) {
+        size_t block = std::min(samples, block_samples_);
+        Update(IsVoiced(data, block));
+        data += block;
+        samples -= block;
+    }
+    return speaking_;
+}
+
+bool EnergyVad::IsVoiced(const int16_t* block, size_t samples) {
+    uint64_t sum = 0;
+    uint32_t crossings = 0;
+    int16_t previous = block[0];
+    for (size_t i = 0; i < samples; i++) {
+        int32_t sample = block[i];
+        sum += uint32_t(sample * sample);
+        crossings += (sample ^ previous) < 0;
+        previous = sample;
+    }
+    uint32_t energy = sum / samples;
+
+    bool loud = energy >= min_energy_ && uint64_t(energy) * 256 >= uint64_t(noise_floor_) * snr_q8_;
+    bool tonal = crossings * 256 < max_crossings_q8_ * samples;
+    bool voiced = loud && tonal;
+
+    /* The floor drops quickly to quieter blocks and creeps up on louder ones: by 1/64
+     * of the gap per unvoiced block and by 1/1024 per voiced one. Speech rarely
+     * holds its level for VAD_STEADY_BLOCKS in a row, so until a voiced block has,
+     * it raises the floor by at most 1/128 of it. A steady hum that passes the
+     * checks is still absorbed after a second or two, while a long sentence
+     * barely moves the floor */
+    uint32_t change = energy > last_energy_ ? energy - last_energy_ : last_energy_ - energy;
+    steady_blocks_ = change <= last_energy_ >> 4 ? steady_blocks_ + 1 : 0;
+    last_energy_ = energy;
+    if (energy < noise_floor_) {
+        noise_floor_ -= (noise_floor_ - energy) >> 2;
+    } else if (voiced && steady_blocks_ < VAD_STEADY_BLOCKS) {
+        noise_floor_ += std::clamp<uint32_t>((energy - noise_floor_) >> 10, 1, std::max<uint32_t>(noise_floor_ >> 7, 1));
+    } else {
+        noise_floor_ += std::max<uint32_t>((energy - noise_floor_) >> (voiced ? 10 : 6), 1);
+    }
+    noise_floor_ = std::max<uint32_t>(noise_floor_, 1);
+    return voiced;
+}
+
+void EnergyVad::Update(bool voiced) {
+    if (voiced) {
+        voiced_run_++;
+        silent_run_ = 0;
+        if (!speaking_ && voiced_run_ >= onset_blocks_) {
+            speaking_ = true;
+        }
+    } else {
+        voiced_run_ = 0;
+        silent_run_++;
+        if (speaking_ && silent_run_ >= hangover_blocks_) {
+            speaking_ = false;
+        }
+    }
+}
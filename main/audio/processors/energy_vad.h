@@ -0,0 +1,59 @@
+#ifndef ENERGY_VAD_H
+#define ENERGY_VAD_H
+
+#include <cstddef>
+#include <cstdint>
+
+/*
+ * Energy plus zero-crossing voice activity detector for boards without the
+ * ESP-SR AFE.
+ *
+ * The input is cut into 10 ms blocks. A block is voiced when its mean square
+ * is snr_db above a tracked noise floor, above min_rms, and it crosses zero in
+ * fewer than max_zcr percent of its samples (hiss and fans cross far more
+ * often than speech). Speech starts after onset_ms of voiced blocks and ends
+ * after hangover_ms without one.
+ *
+ * Integer math only, plain C++ so it also builds on a host. Not thread safe.
+ */
+
+struct EnergyVadConfig {
+    int snr_db = 9;
+    int min_rms = 120;
+    int max_zcr = 40;
+    int onset_ms = 30;
+    int hangover_ms = 400;
+};
+
+class EnergyVad {
+public:
+    EnergyVad(int sample_rate = 16000, const EnergyVadConfig& config = EnergyVadConfig());
+
+    void Configure(const EnergyVadConfig& config);
+    void Reset();
+    // Mono samples of any length, returns the speaking state after them
+    bool Process(const int16_t* data, size_t samples);
+
+    bool speaking() const { return speaking_; }
+    uint32_t noise_floor() const { return noise_floor_; }
+
+private:
+    bool IsVoiced(const int16_t* block, size_t samples);
+    void Update(bool voiced);
+
+    size_t block_samples_;
+    uint32_t snr_q8_ = 0;           // Power ratio over the noise floor, Q8
+    uint32_t min_energy_ = 0;       // min_rms squared
+    uint32_t max_crossings_q8_ = 0; // Crossings per sample, Q8
+    int onset_blocks_ = 0;
+    int hangover_blocks_ = 0;
+
+    uint32_t noise_floor_ = 0;      // Mean square of the background
+    uint32_t last_energy_ = 0;      // Mean square of the previous block
+    int steady_blocks_ = 0;         // Blocks in a row with about that energy
+    int voiced_run_ = 0;
+    int silent_run_ = 0;
+    bool speaking_ = false;
+};
+
+#endif // ENERGY_VAD_H
@@ -1,11 +1,25 @@
 #include "no_audio_processor.h"
 #include <esp_log.h>
 
+#include "pcm_view.h"
+#include "settings.h"
+
 #define TAG "NoAudioProcessor"
 
 void NoAudioProcessor::Initialize(AudioCodec* codec, int frame_duration_ms, srmodel_list_t* models_list) {
     codec_ = codec;
     frame_samples_ = frame_duration_ms * 16000 / 1000;
+
+    Settings settings("vad", false);
+    EnergyVadConfig config;
+    config.snr_db = settings.GetInt("snr_db", config.snr_db);
+    config.min_rms = settings.GetInt("min_rms", config.min_rms);
+    config.max_zcr = settings.GetInt("max_zcr", config.max_zcr);
+    config.onset_ms = settings.GetInt("onset_ms", config.onset_ms);
+    config.hangover_ms = settings.GetInt("hangover_ms", config.hangover_ms);
+    vad_.Configure(config);
+    ESP_LOGI(TAG, "VAD snr=%ddB min_rms=%d max_zcr=%d%% onset=%dms hangover=%dms",
+        config.snr_db, config.min_rms, config.max_zcr, config.onset_ms, config.hangover_ms);
 }
 
 void NoAudioProcessor::Feed(std::vector<int16_t>&& data) {
@@ -13,19 +27,22 @@ void NoAudioProcessor::Feed(std::vector<int16_t>&& data) {
         return;
     }
 
-    if (codec_->input_channels() == 2) {
-        // If input channels is 2, we need to fetch the left channel data
-        auto mono_data = std::vector<int16_t>(data.size() / 2);
-        for (size_t i = 0, j = 0; i < mono_data.size(); ++i, j += 2) {
-            mono_data[i] = data[j];
-        }
-        output_callback_(std::move(mono_data));
-    } else {
-        output_callback_(std::move(data));
+    // If input channels is 2, we need to fetch the left channel data
+    KeepChannelInPlace(data, codec_->input_channels(), 0);
+
+    bool was_speaking = vad_.speaking();
+    if (vad_.Process(data.data(), data.size()) != was_speaking && vad_state_change_callback_) {
+        vad_state_change_callback_(!was_speaking);
     }
+    output_callback_(std::move(data));
 }
 
 void NoAudioProcessor::Start() {
+    /* Feed does not touch the VAD while stopped, a speech state left over from the last session ends here */
+    if (vad_.speaking() && vad_state_change_callback_) {
+        vad_state_change_callback_(false);
+    }
+    vad_.Reset();
     is_running_ = true;
 }
 
@@ -37,6 +54,10 @@ bool NoAudioProcessor::IsRunning() {
     return is_running_;
 }
 
+bool NoAudioProcessor::IsVadRunning() {
+    return true;
+}
+
 void NoAudioProcessor::OnOutput(std::function<void(std::vector<int16_t>&& data)> callback) {
     output_callback_ = callback;
 }
@@ -45,6 +66,10 @@ void NoAudioProcessor::OnVadStateChange(std::function<void(bool speaking)> callb
     vad_state_change_callback_ = callback;
 }
 
+void NoAudioProcessor::SetFrameDuration(int frame_duration_ms) {
+    frame_samples_ = frame_duration_ms * 16000 / 1000;
+}
+
 size_t NoAudioProcessor::GetFeedSize() {
     if (!codec_) {
         return 0;
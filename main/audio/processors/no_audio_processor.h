@@ -6,6 +6,7 @@
 
 #include "audio_processor.h"
 #include "audio_codec.h"
+#include "energy_vad.h"
 
 class NoAudioProcessor : public AudioProcessor {
 public:
@@ -19,7 +20,9 @@ public:
     bool IsRunning() override;
     void OnOutput(std::function<void(std::vector<int16_t>&& data)> callback) override;
     void OnVadStateChange(std::function<void(bool speaking)> callback) override;
+    bool IsVadRunning() override;
     size_t GetFeedSize() override;
+    void SetFrameDuration(int frame_duration_ms) override;
     void EnableDeviceAec(bool enable) override;
 
 private:
@@ -28,6 +31,7 @@ private:
     std::function<void(std::vector<int16_t>&& data)> output_callback_;
     std::function<void(bool speaking)> vad_state_change_callback_;
     bool is_running_ = false;
+    EnergyVad vad_;
 };
 
 #endif 
\ No newline at end of file
@@ -0,0 +1,96 @@
+#ifndef SPSC_RING_H
+#define SPSC_RING_H
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+/*
+ * Fixed-capacity lock-free single-producer / single-consumer ring.
+ *
+ * Push() may only be called by the producer and Pop() by the consumer.
+ * Clear() may be called from any thread: it marks everything pushed so far
+ * as discarded and the consumer drops those items on its next Pop(), so
+ * items pushed after Clear() returns are kept.
+ *
+ * Wakeups are not handled here; the owner notifies the peer task.
+ *
+ * set_limit() lowers the usable capacity at runtime (e.g. a queue sized in
+ * milliseconds of audio when the frame duration changes).
+ */
+template <typename T, size_t Capacity>
+class SpscRing {
+    static constexpr size_t RoundUpPow2(size_t n) {
+        size_t p = 1;
+        while (p < n) p <<= 1;
+        return p;
+    }
+    static constexpr size_t kStorage = RoundUpPow2(Capacity);
+    static constexpr uint32_t kMask = kStorage - 1;
+    static_assert(Capacity > 0, "SpscRing capacity must be positive");
+
+public:
+    static constexpr size_t capacity() { return Capacity; }
+    size_t limit() const { return limit_.load(std::memory_order_relaxed); }
+    void set_limit(size_t limit) { limit_.store(limit > 0 && limit < Capacity ? limit : Capacity, std::memory_order_relaxed); }
+
+    // Moves item in only on success, so the caller can retry
+    bool Push(T& item) {
+        uint32_t head = head_.load(std::memory_order_relaxed);
+        if (head - tail_.load(std::memory_order_acquire) >= limit()) {
+            return false;
+        }
+        slots_[head & kMask] = std::move(item);
+        head_.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool Pop(T& item) {
+        uint32_t tail = tail_.load(std::memory_order_relaxed);
+        uint32_t head = head_.load(std::memory_order_acquire);
+        uint32_t discard = discard_until_.load(std::memory_order_acquire);
+        while (static_cast<int32_t>(discard - tail) > 0 && tail != head) {
+            slots_[tail & kMask] = T();
+            tail++;
+        }
+        if (tail == head) {
+            tail_.store(tail, std::memory_order_release);
+            return false;
+        }
+        item = std::move(slots_[tail & kMask]);
+        tail_.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    void Clear() {
+        discard_until_.store(head_.load(std::memory_order_acquire), std::memory_order_release);
+    }
+
+    // Live items, discarded ones excluded. Exact only on the producer or consumer side.
+    size_t size() const {
+        uint32_t head = head_.load(std::memory_order_acquire);
+        uint32_t tail = tail_.load(std::memory_order_acquire);
+        uint32_t discard = discard_until_.load(std::memory_order_acquire);
+        if (static_cast<int32_t>(discard - tail) > 0) {
+            tail = discard;
+        }
+        return head - tail;
+    }
+
+    bool empty() const { return size() == 0; }
+    // Discarded items still hold their slot until the consumer drops them
+    bool full() const {
+        return head_.load(std::memory_order_acquire) - tail_.load(std::memory_order_acquire) >= limit();
+    }
+
+private:
+    std::array<T, kStorage> slots_{};
+    std::atomic<uint32_t> head_{0};
+    std::atomic<uint32_t> tail_{0};
+    std::atomic<uint32_t> discard_until_{0};
+    std::atomic<uint32_t> limit_{Capacity};
+};
+
+#endif // SPSC_RING_H
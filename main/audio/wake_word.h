@@ -8,6 +8,9 @@
 #include <model_path.h>
 #include "audio_codec.h"
 
+// Microphone audio kept ahead of a detection, sent to the server with the wake word
+#define WAKE_WORD_PRE_ROLL_MS 2000
+
 class WakeWord {
 public:
     virtual ~WakeWord() = default;
@@ -18,7 +21,7 @@ public:
     virtual void Start() = 0;
     virtual void Stop() = 0;
     virtual size_t GetFeedSize() = 0;
-    virtual void EncodeWakeWordData() = 0;
+    virtual void EncodeWakeWordData(int frame_duration_ms) = 0;
     virtual bool GetWakeWordOpus(std::vector<uint8_t>& opus) = 0;
     virtual const std::string& GetLastDetectedWakeWord() const = 0;
 };
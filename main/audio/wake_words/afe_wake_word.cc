@@ -10,7 +10,6 @@
 
 AfeWakeWord::AfeWakeWord()
     : afe_data_(nullptr),
-      wake_word_pcm_(),
       wake_word_opus_() {
 
     event_group_ = xEventGroupCreate();
@@ -95,6 +94,7 @@ void AfeWakeWord::OnWakeWordDetected(std::function<void(const std::string& wake_
 }
 
 void AfeWakeWord::Start() {
+    wake_word_pcm_.Thaw();
     xEventGroupSetBits(event_group_, DETECTION_RUNNING_EVENT);
 }
 
@@ -134,9 +134,10 @@ void AfeWakeWord::AudioDetectionTask() {
         }
 
         // Store the wake word data for voice recognition, like who is speaking
-        StoreWakeWordData(res->data, res->data_size / sizeof(int16_t));
+        wake_word_pcm_.Write(res->data, res->data_size / sizeof(int16_t));
 
         if (res->wakeup_state == WAKENET_DETECTED) {
+            wake_word_pcm_.Snapshot();
             Stop();
             last_detected_wake_word_ = wake_words_[res->wakenet_model_index - 1];
 
@@ -147,18 +148,10 @@ void AfeWakeWord::AudioDetectionTask() {
     }
 }
 
-void AfeWakeWord::StoreWakeWordData(const int16_t* data, size_t samples) {
-    // store audio data to wake_word_pcm_
-    wake_word_pcm_.emplace_back(std::vector<int16_t>(data, data + samples));
-    // keep about 2 seconds of data, detect duration is 30ms (sample_rate == 16000, chunksize == 512)
-    while (wake_word_pcm_.size() > 2000 / 30) {
-        wake_word_pcm_.pop_front();
-    }
-}
-
-void AfeWakeWord::EncodeWakeWordData() {
+void AfeWakeWord::EncodeWakeWordData(int frame_duration_ms) {
     const size_t stack_size = 4096 * 7;
     wake_word_opus_.clear();
+    wake_word_frame_duration_ms_ = frame_duration_ms;
     if (wake_word_encode_task_stack_ == nullptr) {
         wake_word_encode_task_stack_ = (StackType_t*)heap_caps_malloc(stack_size, MALLOC_CAP_SPIRAM);
         assert(wake_word_encode_task_stack_ != nullptr);
@@ -172,19 +165,26 @@ void AfeWakeWord::EncodeWakeWordData() {
         auto this_ = (AfeWakeWord*)arg;
         {
             auto start_time = esp_timer_get_time();
-            auto encoder = std::make_unique<OpusEncoderWrapper>(16000, 1, OPUS_FRAME_DURATION_MS);
+            auto encoder = std::make_unique<OpusEncoderWrapper>(16000, 1, this_->wake_word_frame_duration_ms_);
             encoder->SetComplexity(0); // 0 is the fastest
 
             int packets = 0;
-            for (auto& pcm: this_->wake_word_pcm_) {
-                encoder->Encode(std::move(pcm), [this_](std::vector<uint8_t>&& opus) {
-                    std::lock_guard<std::mutex> lock(this_->wake_word_mutex_);
-                    this_->wake_word_opus_.emplace_back(std::move(opus));
-                    this_->wake_word_cv_.notify_all();
-                });
-                packets++;
+            if (this_->wake_word_pcm_.BeginRead()) {
+                // Frame sized runs read in place from the ring, the encoder wants its own vector
+                const size_t frame_samples = 16000 * this_->wake_word_frame_duration_ms_ / 1000;
+                const int16_t* data;
+                size_t offset = 0;
+                while (size_t samples = this_->wake_word_pcm_.Read(offset, frame_samples, &data)) {
+                    encoder->Encode(std::vector<int16_t>(data, data + samples), [this_, &packets](std::vector<uint8_t>&& opus) {
+                        std::lock_guard<std::mutex> lock(this_->wake_word_mutex_);
+                        this_->wake_word_opus_.emplace_back(std::move(opus));
+                        this_->wake_word_cv_.notify_all();
+                        packets++;
+                    });
+                    offset += samples;
+                }
+                this_->wake_word_pcm_.EndRead();
             }
-            this_->wake_word_pcm_.clear();
 
             auto end_time = esp_timer_get_time();
             ESP_LOGI(TAG, "Encode wake word opus %d packets in %ld ms", packets, (long)((end_time - start_time) / 1000));
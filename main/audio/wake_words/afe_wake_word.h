@@ -18,6 +18,7 @@
 
 #include "audio_codec.h"
 #include "wake_word.h"
+#include "pre_roll_buffer.h"
 
 class AfeWakeWord : public WakeWord {
 public:
@@ -30,7 +31,7 @@ public:
     void Start();
     void Stop();
     size_t GetFeedSize();
-    void EncodeWakeWordData();
+    void EncodeWakeWordData(int frame_duration_ms);
     bool GetWakeWordOpus(std::vector<uint8_t>& opus);
     const std::string& GetLastDetectedWakeWord() const { return last_detected_wake_word_; }
 
@@ -48,12 +49,12 @@ private:
     TaskHandle_t wake_word_encode_task_ = nullptr;
     StaticTask_t* wake_word_encode_task_buffer_ = nullptr;
     StackType_t* wake_word_encode_task_stack_ = nullptr;
-    std::deque<std::vector<int16_t>> wake_word_pcm_;
+    PreRollBuffer wake_word_pcm_{16000 * WAKE_WORD_PRE_ROLL_MS / 1000};
+    int wake_word_frame_duration_ms_ = 60;
     std::deque<std::vector<uint8_t>> wake_word_opus_;
     std::mutex wake_word_mutex_;
     std::condition_variable wake_word_cv_;
 
-    void StoreWakeWordData(const int16_t* data, size_t size);
     void AudioDetectionTask();
 };
 
@@ -14,7 +14,7 @@
 
 
 CustomWakeWord::CustomWakeWord()
-    : wake_word_pcm_(), wake_word_opus_() {
+    : wake_word_opus_() {
 }
 
 CustomWakeWord::~CustomWakeWord() {
@@ -135,6 +135,7 @@ void CustomWakeWord::OnWakeWordDetected(std::function<void(const std::string& wa
 }
 
 void CustomWakeWord::Start() {
+    wake_word_pcm_.Thaw();
     running_ = true;
 }
 
@@ -149,17 +150,13 @@ void CustomWakeWord::Feed(const std::vector<int16_t>& data) {
 
     esp_mn_state_t mn_state;
     // If input channels is 2, we need to fetch the left channel data
-    if (codec_->input_channels() == 2) {
-        auto mono_data = std::vector<int16_t>(data.size() / 2);
-        for (size_t i = 0, j = 0; i < mono_data.size(); ++i, j += 2) {
-            mono_data[i] = data[j];
-        }
-
-        StoreWakeWordData(mono_data);
-        mn_state = multinet_->detect(multinet_model_data_, const_cast<int16_t*>(mono_data.data()));
+    auto mic = PcmView::Channel(data, codec_->input_channels(), 0);
+    wake_word_pcm_.Write(mic);
+    if (mic.contiguous()) {
+        mn_state = multinet_->detect(multinet_model_data_, const_cast<int16_t*>(mic.data()));
     } else {
-        StoreWakeWordData(data);
-        mn_state = multinet_->detect(multinet_model_data_, const_cast<int16_t*>(data.data()));
+        mic.CopyTo(mono_buffer_);
+        mn_state = multinet_->detect(multinet_model_data_, mono_buffer_.data());
     }
     
     if (mn_state == ESP_MN_STATE_DETECTING) {
@@ -172,6 +169,7 @@ void CustomWakeWord::Feed(const std::vector<int16_t>& data) {
             auto& command = commands_[mn_result->command_id[i] - 1];
             if (command.action == "wake") {
                 last_detected_wake_word_ = command.text;
+                wake_word_pcm_.Snapshot();
                 running_ = false;
                 
                 if (wake_word_detected_callback_) {
@@ -193,18 +191,10 @@ size_t CustomWakeWord::GetFeedSize() {
     return multinet_->get_samp_chunksize(multinet_model_data_);
 }
 
-void CustomWakeWord::StoreWakeWordData(const std::vector<int16_t>& data) {
-    // store audio data to wake_word_pcm_
-    wake_word_pcm_.push_back(data);
-    // keep about 2 seconds of data, detect duration is 30ms (sample_rate == 16000, chunksize == 512)
-    while (wake_word_pcm_.size() > 2000 / 30) {
-        wake_word_pcm_.pop_front();
-    }
-}
-
-void CustomWakeWord::EncodeWakeWordData() {
+void CustomWakeWord::EncodeWakeWordData(int frame_duration_ms) {
     const size_t stack_size = 4096 * 7;
     wake_word_opus_.clear();
+    wake_word_frame_duration_ms_ = frame_duration_ms;
     if (wake_word_encode_task_stack_ == nullptr) {
         wake_word_encode_task_stack_ = (StackType_t*)heap_caps_malloc(stack_size, MALLOC_CAP_SPIRAM);
         assert(wake_word_encode_task_stack_ != nullptr);
@@ -218,19 +208,26 @@ void CustomWakeWord::EncodeWakeWordData() {
         auto this_ = (CustomWakeWord*)arg;
         {
             auto start_time = esp_timer_get_time();
-            auto encoder = std::make_unique<OpusEncoderWrapper>(16000, 1, OPUS_FRAME_DURATION_MS);
+            auto encoder = std::make_unique<OpusEncoderWrapper>(16000, 1, this_->wake_word_frame_duration_ms_);
             encoder->SetComplexity(0); // 0 is the fastest
 
             int packets = 0;
-            for (auto& pcm: this_->wake_word_pcm_) {
-                encoder->Encode(std::move(pcm), [this_](std::vector<uint8_t>&& opus) {
-                    std::lock_guard<std::mutex> lock(this_->wake_word_mutex_);
-                    this_->wake_word_opus_.emplace_back(std::move(opus));
-                    this_->wake_word_cv_.notify_all();
-                });
-                packets++;
+            if (this_->wake_word_pcm_.BeginRead()) {
+                // Frame sized runs read in place from the ring, the encoder wants its own vector
+                const size_t frame_samples = 16000 * this_->wake_word_frame_duration_ms_ / 1000;
+                const int16_t* data;
+                size_t offset = 0;
+                while (size_t samples = this_->wake_word_pcm_.Read(offset, frame_samples, &data)) {
+                    encoder->Encode(std::vector<int16_t>(data, data + samples), [this_, &packets](std::vector<uint8_t>&& opus) {
+                        std::lock_guard<std::mutex> lock(this_->wake_word_mutex_);
+                        this_->wake_word_opus_.emplace_back(std::move(opus));
+                        this_->wake_word_cv_.notify_all();
+                        packets++;
+                    });
+                    offset += samples;
+                }
+                this_->wake_word_pcm_.EndRead();
             }
-            this_->wake_word_pcm_.clear();
 
             auto end_time = esp_timer_get_time();
             ESP_LOGI(TAG, "Encode wake word opus %d packets in %ld ms", packets, (long)((end_time - start_time) / 1000));
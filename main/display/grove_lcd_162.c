@@ -1,4 +1,5 @@
 #include "grove_lcd_162.h"
+#include "lcd1602_framebuffer.h"
 #include <freertos/FreeRTOS.h>
 #include <freertos/task.h>
 #include "driver/i2c_master.h"
@@ -6,26 +7,85 @@
 #include <ctype.h>
 #include "esp_log.h"
 #include "freertos/semphr.h"
+#include "esp_timer.h"
+#include "sdkconfig.h"
 
 #define LCD_ADDR 0x3E
 #define I2C_PORT 0   // I2C_NUM_0
+#define LCD_SCL_HZ 100000
 
 static const char *TAG = "GROVE_LCD";
 
 static i2c_master_bus_handle_t s_bus = NULL;
 static i2c_master_dev_handle_t s_lcd = NULL;
 static SemaphoreHandle_t s_lock = NULL;
-static char s_line1[17] = {0};
-static char s_line2[17] = {0};
+static lcd_fb_t s_fb = {0};
+static lcd_bus_stats_t s_stats = {0};
+
+// Control bytes: Co=1 -> another control byte follows, RS selects command/data
+#define LCD_CTRL_CMD_CONT  0x80
+#define LCD_CTRL_CMD_LAST  0x00
+#define LCD_CTRL_DATA_LAST 0x40
+
+// START + address byte + payload bytes (9 clocks each with ACK) + STOP
+static uint32_t lcd_bus_time_us(size_t len) {
+    uint32_t clocks = (uint32_t)(len + 1) * 9 + 2;
+    return (uint32_t)((uint64_t)clocks * 1000000 / LCD_SCL_HZ);
+}
+
+#if CONFIG_LCD1602_BUS_RECORDER
+// One line per transaction, parsed by scripts/lcd1602_emulator
+static void lcd_record(const uint8_t* buf, size_t len) {
+    char hex[2 * (3 + LCD_BURST_MAX) + 1];
+    size_t n = 0;
+    for (size_t i = 0; i < len && n + 2 < sizeof(hex); ++i) {
+        n += snprintf(hex + n, sizeof(hex) - n, "%02x", buf[i]);
+    }
+    hex[n] = '\0';
+    ESP_LOGI(TAG, "LCDTX %lld %s", (long long)esp_timer_get_time(), hex);
+}
+#endif
+
+// Callers hold lcd_lock, which also guards s_stats
+static esp_err_t lcd_transmit(const uint8_t* buf, size_t len) {
+    if (!s_lcd) return ESP_ERR_INVALID_STATE;
+    s_stats.transactions++;
+    s_stats.bytes += len;
+    s_stats.bus_time_us += lcd_bus_time_us(len);
+#if CONFIG_LCD1602_BUS_RECORDER
+    lcd_record(buf, len);
+#endif
+    return i2c_master_transmit(s_lcd, buf, len, 50);
+}
 
 static esp_err_t lcd_cmd(uint8_t cmd) {
-    uint8_t buf[2] = {0x80, cmd};
-    return i2c_master_transmit(s_lcd, buf, 2, 50);
+    uint8_t buf[2] = {LCD_CTRL_CMD_CONT, cmd};
+    return lcd_transmit(buf, 2);
 }
 
-static esp_err_t lcd_data(uint8_t data) {
-    uint8_t buf[2] = {0x40, data};
-    return i2c_master_transmit(s_lcd, buf, 2, 50);
+// One transaction: optional address command (DDRAM or CGRAM), then a run of data bytes
+static esp_err_t lcd_burst(int cmd, const uint8_t* data, size_t len) {
+    uint8_t buf[3 + LCD_BURST_MAX];
+    size_t n = 0;
+    if (cmd >= 0) {
+        buf[n++] = LCD_CTRL_CMD_CONT;
+        buf[n++] = (uint8_t)cmd;
+    }
+    if (len > LCD_BURST_MAX) len = LCD_BURST_MAX;
+    if (len == 0 && n == 0) return ESP_OK;
+    if (len == 0) {
+        buf[0] = LCD_CTRL_CMD_LAST;
+    } else {
+        buf[n++] = LCD_CTRL_DATA_LAST;
+        memcpy(buf + n, data, len);
+        n += len;
+    }
+    return lcd_transmit(buf, n);
+}
+
+static uint8_t lcd_ddram_cmd(uint8_t col, uint8_t row) {
+    if (row > 1) row = 1;
+    return 0x80 | (col + row * 0x40);
 }
 
 static void lcd_lock()  { if (s_lock) xSemaphoreTake(s_lock, portMAX_DELAY); }
@@ -33,22 +93,28 @@ static void lcd_unlock(){ if (s_lock) xSemaphoreGive(s_lock); }
 
 static void lcd_write_lines(const char* l1, const char* l2, bool erase_short) {
     lcd_lock();
-    char buf1[17]={0}, buf2[17]={0};
-    if (l1) strncpy(buf1, l1, 16);
-    if (l2) strncpy(buf2, l2, 16);
-
-    if (strncmp(buf1, s_line1, 16) != 0) {
-        lcd_set_cursor(0,0);
-        if (erase_short) lcd_print("                ");
-        lcd_set_cursor(0,0); lcd_print(buf1);
-        strncpy(s_line1, buf1, 16);
+    char next[LCD_FB_ROWS][LCD_FB_COLS];
+    const char* lines[LCD_FB_ROWS] = {l1, l2};
+    for (int r = 0; r < LCD_FB_ROWS; ++r) {
+        if (erase_short || !s_fb.valid) {
+            lcd_fb_fill_row(next[r], lines[r]);
+        } else {
+            // Overlay the text on what is already shown
+            memcpy(next[r], s_fb.cells[r], LCD_FB_COLS);
+            for (int c = 0; lines[r] && lines[r][c] && c < LCD_FB_COLS; ++c) {
+                next[r][c] = lines[r][c];
+            }
+        }
     }
-    if (strncmp(buf2, s_line2, 16) != 0) {
-        lcd_set_cursor(0,1);
-        if (erase_short) lcd_print("                ");
-        lcd_set_cursor(0,1); lcd_print(buf2);
-        strncpy(s_line2, buf2, 16);
+
+    // Only the changed runs go on the wire, one transaction each
+    lcd_fb_run_t runs[LCD_FB_MAX_RUNS];
+    size_t count = lcd_fb_diff(&s_fb, next, runs, LCD_FB_MAX_RUNS);
+    for (size_t i = 0; i < count; ++i) {
+        lcd_burst(lcd_ddram_cmd(runs[i].col, runs[i].row),
+                  (const uint8_t*)&next[runs[i].row][runs[i].col], runs[i].len);
     }
+    lcd_fb_commit(&s_fb, next);
     lcd_unlock();
 }
 
@@ -70,7 +136,7 @@ void lcd_init(void) {
     }
     if (!s_lcd) {
         i2c_device_config_t dev_cfg = {
-            .scl_speed_hz = 100000,
+            .scl_speed_hz = LCD_SCL_HZ,
             .device_address = LCD_ADDR,   // sửa từ dev_addr -> device_address
             .flags = {
                 .disable_ack_check = 0     // giữ kiểm tra ACK
@@ -84,6 +150,7 @@ void lcd_init(void) {
     }
 
     vTaskDelay(pdMS_TO_TICKS(60));
+    lcd_lock();
     lcd_cmd(0x38);
     lcd_cmd(0x39);
     lcd_cmd(0x14);
@@ -97,37 +164,88 @@ void lcd_init(void) {
     vTaskDelay(pdMS_TO_TICKS(3));
     lcd_cmd(0x02);
     vTaskDelay(pdMS_TO_TICKS(3));
+    lcd_unlock();
     ESP_LOGI(TAG, "LCD init done (driver_ng)");
     lcd_clear();
-    memset(s_line1,0,sizeof(s_line1));
-    memset(s_line2,0,sizeof(s_line2));
     lcd_write_lines("XiaoZhi","LCD1602",true);
 }
 
 void lcd_clear(void) {
+    lcd_lock();
     lcd_cmd(0x01);
+    lcd_fb_reset(&s_fb);
+    lcd_unlock();
     vTaskDelay(pdMS_TO_TICKS(3));
 }
 
 void lcd_set_cursor(uint8_t col, uint8_t row) {
-    if (row > 1) row = 1;
-    lcd_cmd(0x80 | (col + row * 0x40));
+    lcd_lock();
+    lcd_cmd(lcd_ddram_cmd(col, row));
+    lcd_unlock();
 }
 
 void lcd_print(const char *text) {
-    while (text && *text) {
-        lcd_data((uint8_t)*text++);
+    if (!text) return;
+    lcd_write(text, strlen(text));
+}
+
+void lcd_write(const char* data, size_t len) {
+    // Raw writes bypass the shadow, so the next line update repaints fully
+    lcd_lock();
+    lcd_fb_invalidate(&s_fb);
+    while (len > 0) {
+        size_t n = len > LCD_BURST_MAX ? LCD_BURST_MAX : len;
+        lcd_burst(-1, (const uint8_t*)data, n);
+        data += n;
+        len -= n;
     }
+    lcd_unlock();
+}
+
+void lcd_write_at(uint8_t col, uint8_t row, const char* data, size_t len) {
+    lcd_lock();
+    lcd_fb_invalidate(&s_fb);
+    if (len > LCD_BURST_MAX) len = LCD_BURST_MAX;
+    lcd_burst(lcd_ddram_cmd(col, row), (const uint8_t*)data, len);
+    lcd_unlock();
+}
+
+void lcd_upload_glyph(uint8_t slot, const uint8_t rows[8]) {
+    // Set CGRAM Address, then the 8 pattern rows in the same transaction.
+    // DDRAM cells are unaffected; every later line update re-addresses DDRAM.
+    lcd_lock();
+    lcd_burst(0x40 | ((slot & 0x07) << 3), rows, 8);
+    lcd_unlock();
+}
+
+void lcd_show_lines(const char* line1, const char* line2) {
+    lcd_write_lines(line1, line2, true);
+}
+
+void lcd_get_bus_stats(lcd_bus_stats_t* stats) {
+    if (!stats) return;
+    lcd_lock();
+    *stats = s_stats;
+    lcd_unlock();
+}
+
+void lcd_reset_bus_stats(void) {
+    lcd_lock();
+    memset(&s_stats, 0, sizeof(s_stats));
+    lcd_unlock();
 }
 
 // Thêm hàm chỉnh contrast (tùy chọn)
 void lcd_set_contrast(uint8_t val) {
     if (val < 0x70 || val > 0x74) return;
+    // The extended instruction set stays selected until 0x38, nothing may interleave
+    lcd_lock();
     lcd_cmd(0x39);
     lcd_cmd(0x14);
     lcd_cmd(val);   // contrast low bits
     lcd_cmd(0x56);  // power/icon/contrast high bits (keep)
     lcd_cmd(0x38);
+    lcd_unlock();
     vTaskDelay(pdMS_TO_TICKS(3));
 }
 
@@ -221,7 +339,5 @@ void lcd_scroll_text(const char* text, int offset) {
 void lcd_reinit(void) {
     lcd_init();
     lcd_clear();
-    memset(s_line1,0,sizeof(s_line1));
-    memset(s_line2,0,sizeof(s_line2));
     lcd_write_lines("LCD1602 Ready","",true);
 }
\ No newline at end of file
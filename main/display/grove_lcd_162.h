@@ -1,5 +1,6 @@
 #pragma once
 #include <stdint.h>
+#include <stddef.h>
 #include "esp_log.h"
 #ifdef __cplusplus
 extern "C" {
@@ -8,14 +9,28 @@ extern "C" {
 #define LCD_I2C_PORT I2C_NUM_0
 #define LCD_ADDR     0x3E
 
+/* Longest data run sent in one I2C transaction (one DDRAM line is 40 cells) */
+#define LCD_BURST_MAX 40
+
+typedef struct {
+    uint32_t transactions;  /* i2c_master_transmit calls */
+    uint32_t bytes;         /* bytes on the wire, control bytes included */
+    uint32_t bus_time_us;   /* estimated SCL time at the configured clock */
+} lcd_bus_stats_t;
+
 void lcd_init(void);
 void lcd_clear(void);
 void lcd_set_cursor(uint8_t col, uint8_t row);
 void lcd_print(const char *text);
+void lcd_write(const char* data, size_t len);
+void lcd_write_at(uint8_t col, uint8_t row, const char* data, size_t len);
 void lcd_set_contrast(uint8_t val);
+/* Custom 5x8 character, displayed through codes slot and slot + 8 */
+void lcd_upload_glyph(uint8_t slot, const uint8_t rows[8]);
 static inline void lcd_set_rgb(uint8_t r, uint8_t g, uint8_t b) { (void)r; (void)g; (void)b; }
 
 /* High-level helpers (thread-safe via internal mutex) */
+void lcd_show_lines(const char* line1, const char* line2);
 void lcd_show_status(const char* status);
 void lcd_show_verification_code(const char* code);
 void lcd_show_pairing_code(const char* code);
@@ -24,6 +39,10 @@ void lcd_show_emotion(const char* emotion);
 void lcd_scroll_text(const char* text, int offset);
 void lcd_reinit(void);
 
+/* Bus usage counters, for measuring redraw cost */
+void lcd_get_bus_stats(lcd_bus_stats_t* stats);
+void lcd_reset_bus_stats(void);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,297 @@
+#include "lcd1602_display.h"
+#include "grove_lcd_162.h"
+#include "lcd1602_vietnamese.h"
+#include "application.h"
+
+#include <cstring>
+#include <esp_log.h>
+
+#define TAG "Lcd1602Display"
+
+uint32_t Lcd1602Mailbox::Claim() {
+    uint32_t mask = free_mask_.load(std::memory_order_acquire);
+    while (true) {
+        if (mask == 0) {
+            // Every slot is in flight, only possible with several concurrent producers
+            taskYIELD();
+            mask = free_mask_.load(std::memory_order_acquire);
+            continue;
+        }
+        uint32_t slot = __builtin_ctz(mask);
+        if (free_mask_.compare_exchange_weak(mask, mask & ~(1u << slot), std::memory_order_acq_rel)) {
+            return slot;
+        }
+    }
+}
+
+void Lcd1602Mailbox::Publish(uint32_t slot) {
+    uint32_t previous = pending_.exchange(slot, std::memory_order_acq_rel);
+    if (previous != kNone) {
+        Release(previous);
+    }
+}
+
+uint32_t Lcd1602Mailbox::Take() {
+    return pending_.exchange(kNone, std::memory_order_acq_rel);
+}
+
+void Lcd1602Mailbox::Release(uint32_t slot) {
+    free_mask_.fetch_or(1u << slot, std::memory_order_release);
+}
+
+Lcd1602Display::Lcd1602Display()
+    : glyph_cache_([](uint8_t slot, const uint8_t rows[8]) { lcd_upload_glyph(slot, rows); }) {
+    width_ = LCD1602_COLS;
+    height_ = LCD1602_ROWS;
+    mutex_ = xSemaphoreCreateMutex();
+
+    esp_timer_create_args_t scroll_timer_args = {
+        .callback = [](void* arg) {
+            Lcd1602Display* display = (Lcd1602Display*)arg;
+            display->OnScrollTick();
+        },
+        .arg = this,
+        .dispatch_method = ESP_TIMER_TASK,
+        .name = "lcd_scroll",
+        .skip_unhandled_events = true,
+    };
+    esp_timer_create(&scroll_timer_args, &scroll_timer_);
+}
+
+Lcd1602Display::~Lcd1602Display() {
+    if (scroll_timer_ != nullptr) {
+        esp_timer_stop(scroll_timer_);
+        esp_timer_delete(scroll_timer_);
+    }
+    if (render_task_handle_ != nullptr) {
+        vTaskDelete(render_task_handle_);
+    }
+    if (mutex_ != nullptr) {
+        vSemaphoreDelete(mutex_);
+    }
+}
+
+void Lcd1602Display::Start() {
+    WriteLines("XiaoZhi Ready", "Xin Chao!");
+    xTaskCreate([](void* arg) {
+        Lcd1602Display* display = (Lcd1602Display*)arg;
+        display->RenderTask();
+        vTaskDelete(NULL);
+    }, "lcd_render", 3072, this, LCD1602_RENDER_TASK_PRIORITY, &render_task_handle_);
+}
+
+bool Lcd1602Display::Lock(int timeout_ms) {
+    return xSemaphoreTake(mutex_, timeout_ms ? pdMS_TO_TICKS(timeout_ms) : portMAX_DELAY) == pdTRUE;
+}
+
+void Lcd1602Display::Unlock() {
+    xSemaphoreGive(mutex_);
+}
+
+void Lcd1602Display::WriteLines(const char* line1, const char* line2) {
+    uint32_t slot = mailbox_.Claim();
+    auto& frame = mailbox_.frame(slot);
+    strlcpy(frame.lines[0], line1 ? line1 : "", sizeof(frame.lines[0]));
+    strlcpy(frame.lines[1], line2 ? line2 : "", sizeof(frame.lines[1]));
+#if CONFIG_LCD1602_BUS_RECORDER
+    // Replayed on the host by test/display/lcd1602_replay
+    ESP_LOGI(TAG, "LCDFRAME %lld %s\t%s", (long long)esp_timer_get_time(), frame.lines[0], frame.lines[1]);
+#endif
+    mailbox_.Publish(slot);
+    if (render_task_handle_ != nullptr) {
+        xTaskNotifyGive(render_task_handle_);
+    }
+}
+
+void Lcd1602Display::RenderTask() {
+    vTaskDelay(pdMS_TO_TICKS(300));
+    lcd_init();
+    lcd_clear();
+    glyph_cache_.Invalidate();
+    ESP_LOGI(TAG, "LCD init done");
+
+    while (true) {
+        uint32_t slot = mailbox_.Take();
+        if (slot != Lcd1602Mailbox::kNone) {
+            auto& frame = mailbox_.frame(slot);
+            char cells[LCD1602_ROWS][LCD1602_COLS + 1];
+            glyph_cache_.Render(frame.lines[0], frame.lines[1], cells);
+            mailbox_.Release(slot);
+            lcd_show_lines(cells[0], cells[1]);
+        }
+
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        // Let the rest of a burst (status + emotion + message) land before drawing
+        vTaskDelay(pdMS_TO_TICKS(LCD1602_FRAME_MS));
+    }
+}
+
+void Lcd1602Display::SetStatus(const char* status) {
+    if (!status) return;
+    StopScroll();
+    const char* nl = strchr(status, '\n');
+    if (nl) {
+        // Lines are UTF-8, the glyph cache clips them to 16 cells
+        char l1[sizeof(Lcd1602Frame::lines[0])] = {0};
+        size_t len1 = nl - status;
+        memcpy(l1, status, len1 < sizeof(l1) - 1 ? len1 : sizeof(l1) - 1);
+        WriteLines(l1, nl + 1);
+    } else {
+        WriteLines(status, nullptr);
+    }
+}
+
+void Lcd1602Display::SetEmotion(const char* emotion) {
+    if (!emotion) return;
+    StopScroll();
+
+    // Translate emotion to icon on LCD1602 with centered alignment
+    if (strcmp(emotion, "happy") == 0) {
+        WriteLines("     :-)     ", "    happy    ");
+    } else if (strcmp(emotion, "sad") == 0) {
+        WriteLines("     :-(     ", "     sad     ");
+    } else if (strcmp(emotion, "neutral") == 0) {
+        WriteLines("     :-|     ", "   neutral   ");
+    } else if (strcmp(emotion, "angry") == 0) {
+        WriteLines("     >:(     ", "    angry    ");
+    } else if (strcmp(emotion, "listening") == 0) {
+        WriteLines("     ^_^     ", "  listening  ");
+    } else if (strcmp(emotion, "speaking") == 0) {
+        WriteLines("     :-D     ", "   speaking  ");
+    } else if (strcmp(emotion, "thinking") == 0) {
+        WriteLines("     :-/     ", "   thinking  ");
+    } else {
+        WriteLines("     :-O     ", "    ????     "); // surprised or unknown
+    }
+}
+
+// Word-wrap UTF-8 text into rows of at most LCD1602_COLS cells; words longer
+// than a row are split. ends receives the running cell count after each row.
+static void WrapText(const char* text, std::vector<std::string>& lines, std::vector<int>& ends) {
+    std::string line, word;
+    int line_cells = 0, word_cells = 0, total = 0;
+
+    auto flush_line = [&]() {
+        total += line_cells;
+        lines.push_back(std::move(line));
+        ends.push_back(total);
+        line.clear();
+        line_cells = 0;
+    };
+    auto flush_word = [&]() {
+        if (word_cells == 0) return;
+        int needed = line_cells > 0 ? word_cells + 1 : word_cells;
+        if (line_cells + needed > LCD1602_COLS) {
+            flush_line();
+            needed = word_cells;
+        }
+        if (line_cells > 0) line += ' ';
+        line += word;
+        line_cells += needed;
+        word.clear();
+        word_cells = 0;
+    };
+
+    size_t remaining = strlen(text);
+    while (true) {
+        auto ch = vn::DecodeUtf8(text, remaining);
+        if (ch.length == 0) break;
+        if (ch.codepoint == U' ' || ch.codepoint == U'\n') {
+            flush_word();
+        } else {
+            if (word_cells == LCD1602_COLS) {
+                flush_word();
+            }
+            word.append(text, ch.length);
+            word_cells++;
+        }
+        text += ch.length;
+        remaining -= ch.length;
+    }
+    flush_word();
+    if (line_cells > 0) {
+        flush_line();
+    }
+}
+
+uint32_t Lcd1602Display::ScrollClockMs() const {
+    if (scroll_by_playback_) {
+        return Application::GetInstance().GetAudioService().GetPlaybackPositionMs();
+    }
+    return (uint32_t)(esp_timer_get_time() / 1000);
+}
+
+void Lcd1602Display::SetChatMessage(const char* role, const char* content) {
+    std::lock_guard<std::mutex> lock(scroll_mutex_);
+    esp_timer_stop(scroll_timer_);
+    scroll_lines_.clear();
+    scroll_line_ends_.clear();
+
+    if (content == nullptr || content[0] == '\0') {
+        // Blank the message if it is still showing; status/emotion drawn after it stay
+        if (message_shown_) {
+            message_shown_ = false;
+            WriteLines(nullptr, nullptr);
+        }
+        return;
+    }
+
+    WrapText(content, scroll_lines_, scroll_line_ends_);
+    scroll_top_ = 0;
+    message_shown_ = true;
+
+    const char* line2 = scroll_lines_.size() > 1 ? scroll_lines_[1].c_str() : nullptr;
+    WriteLines(scroll_lines_.empty() ? nullptr : scroll_lines_[0].c_str(), line2);
+
+    // Fits on screen: nothing to schedule
+    if (scroll_lines_.size() <= LCD1602_ROWS) {
+        return;
+    }
+    scroll_by_playback_ = role != nullptr && strcmp(role, "assistant") == 0;
+    if (scroll_by_playback_) {
+        // Starts when the sentence's first packet is played, not when its text arrives
+        scroll_sentence_ = Application::GetInstance().GetAudioService().last_sentence();
+        scroll_started_ = false;
+    } else {
+        scroll_start_ms_ = ScrollClockMs();
+        scroll_started_ = true;
+    }
+    esp_timer_start_periodic(scroll_timer_, LCD1602_SCROLL_TICK_MS * 1000);
+}
+
+void Lcd1602Display::StopScroll() {
+    std::lock_guard<std::mutex> lock(scroll_mutex_);
+    esp_timer_stop(scroll_timer_);
+    scroll_lines_.clear();
+    scroll_line_ends_.clear();
+    message_shown_ = false;
+}
+
+void Lcd1602Display::OnScrollTick() {
+    std::lock_guard<std::mutex> lock(scroll_mutex_);
+    int last_top = (int)scroll_lines_.size() - LCD1602_ROWS;
+    if (last_top <= 0) {
+        return;
+    }
+
+    if (!scroll_started_) {
+        if (!Application::GetInstance().GetAudioService().GetSentenceStartMs(scroll_sentence_, scroll_start_ms_)) {
+            return;
+        }
+        scroll_started_ = true;
+    }
+
+    // Keep the row being spoken on top and the next one below it
+    int spoken = (int)((ScrollClockMs() - scroll_start_ms_) * LCD1602_SCROLL_CHARS_PER_SEC / 1000);
+    int top = 0;
+    while (top < last_top && spoken >= scroll_line_ends_[top]) {
+        top++;
+    }
+    if (top != scroll_top_) {
+        scroll_top_ = top;
+        WriteLines(scroll_lines_[top].c_str(), scroll_lines_[top + 1].c_str());
+    }
+    if (top == last_top) {
+        esp_timer_stop(scroll_timer_);
+    }
+}
@@ -0,0 +1,96 @@
+#ifndef LCD1602_DISPLAY_H
+#define LCD1602_DISPLAY_H
+
+#include "display.h"
+#include "lcd1602_glyph_cache.h"
+
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <freertos/semphr.h>
+#include <esp_timer.h>
+
+// Intents arriving within one frame are coalesced into a single flush
+#define LCD1602_FRAME_MS 30
+#define LCD1602_RENDER_TASK_PRIORITY 1
+// Long chat messages scroll one line at a time at roughly the TTS speaking rate
+#define LCD1602_SCROLL_TICK_MS 100
+#define LCD1602_SCROLL_CHARS_PER_SEC 18
+
+struct Lcd1602Frame {
+    // UTF-8, large enough for a full row of 4-byte sequences
+    char lines[LCD1602_ROWS][LCD1602_COLS * 4 + 1];
+};
+
+/*
+ * Multi-producer / single-consumer "latest frame wins" mailbox.
+ * Producers claim a free slot, fill it and publish it. Publishing over a frame
+ * the render task has not picked up yet recycles the older one, so a burst of
+ * updates costs one redraw. Nothing here blocks, callers never wait on the bus.
+ */
+class Lcd1602Mailbox {
+public:
+    static constexpr uint32_t kSlots = 4;
+    static constexpr uint32_t kNone = kSlots;
+
+    uint32_t Claim();
+    void Publish(uint32_t slot);
+    uint32_t Take();
+    void Release(uint32_t slot);
+    Lcd1602Frame& frame(uint32_t slot) { return slots_[slot]; }
+
+private:
+    Lcd1602Frame slots_[kSlots];
+    std::atomic<uint32_t> free_mask_{(1u << kSlots) - 1};
+    std::atomic<uint32_t> pending_{kNone};
+};
+
+class Lcd1602Display : public Display {
+public:
+    Lcd1602Display();
+    ~Lcd1602Display();
+
+    // Starts the render task, which also brings up the panel
+    void Start();
+
+    virtual void SetStatus(const char* status) override;
+    virtual void SetEmotion(const char* emotion) override;
+    virtual void SetChatMessage(const char* role, const char* content) override;
+
+    void WriteLines(const char* line1, const char* line2);
+
+protected:
+    virtual bool Lock(int timeout_ms = 0) override;
+    virtual void Unlock() override;
+
+private:
+    SemaphoreHandle_t mutex_ = nullptr;
+    TaskHandle_t render_task_handle_ = nullptr;
+    Lcd1602Mailbox mailbox_;
+    Lcd1602GlyphCache glyph_cache_;
+
+    // Scrolling is paced by audio actually played for assistant messages, counted
+    // from where the sentence's audio begins, so a playback stall also holds the
+    // text; other roles use wall-clock time.
+    std::mutex scroll_mutex_;
+    esp_timer_handle_t scroll_timer_ = nullptr;
+    std::vector<std::string> scroll_lines_;
+    std::vector<int> scroll_line_ends_;     // cumulative cells up to the end of each line
+    int scroll_top_ = 0;
+    bool scroll_by_playback_ = false;
+    uint32_t scroll_sentence_ = 0;          // AudioService sentence id, assistant messages only
+    bool scroll_started_ = false;           // scroll_start_ms_ is known
+    uint32_t scroll_start_ms_ = 0;
+    bool message_shown_ = false;            // the last frame posted was a chat message
+
+    void RenderTask();
+    void StopScroll();
+    void OnScrollTick();
+    uint32_t ScrollClockMs() const;
+};
+
+#endif // LCD1602_DISPLAY_H
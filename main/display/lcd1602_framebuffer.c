@@ -0,0 +1,52 @@
+#include "lcd1602_framebuffer.h"
+#include <string.h>
+
+void lcd_fb_reset(lcd_fb_t* fb) {
+    memset(fb->cells, ' ', sizeof(fb->cells));
+    fb->valid = true;
+}
+
+void lcd_fb_invalidate(lcd_fb_t* fb) {
+    fb->valid = false;
+}
+
+void lcd_fb_fill_row(char row[LCD_FB_COLS], const char* text) {
+    size_t i = 0;
+    for (; text && text[i] && i < LCD_FB_COLS; ++i) {
+        row[i] = text[i];
+    }
+    memset(row + i, ' ', LCD_FB_COLS - i);
+}
+
+size_t lcd_fb_diff(const lcd_fb_t* fb, const char next[LCD_FB_ROWS][LCD_FB_COLS],
+                   lcd_fb_run_t* runs, size_t max_runs) {
+    size_t count = 0;
+    for (uint8_t r = 0; r < LCD_FB_ROWS; ++r) {
+        int start = -1;   // first cell of the open run
+        int last = -1;    // last dirty cell of the open run
+        for (int c = 0; c <= LCD_FB_COLS; ++c) {
+            bool dirty = c < LCD_FB_COLS && (!fb->valid || fb->cells[r][c] != next[r][c]);
+            if (dirty) {
+                if (start < 0) start = c;
+                last = c;
+                continue;
+            }
+            // Close the run once the clean gap is too long to be worth bridging
+            if (start >= 0 && (c == LCD_FB_COLS || c - last >= LCD_FB_MERGE_GAP)) {
+                if (count < max_runs) {
+                    runs[count].row = r;
+                    runs[count].col = (uint8_t)start;
+                    runs[count].len = (uint8_t)(last + 1 - start);
+                    count++;
+                }
+                start = -1;
+            }
+        }
+    }
+    return count;
+}
+
+void lcd_fb_commit(lcd_fb_t* fb, const char next[LCD_FB_ROWS][LCD_FB_COLS]) {
+    memcpy(fb->cells, next, sizeof(fb->cells));
+    fb->valid = true;
+}
@@ -0,0 +1,47 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define LCD_FB_COLS 16
+#define LCD_FB_ROWS 2
+
+/* Unchanged cells shorter than this between two dirty runs are resent rather
+ * than paying for a new transaction (I2C address + Set DDRAM Address + control). */
+#define LCD_FB_MERGE_GAP 4
+
+/* Worst case: one dirty cell followed by a full gap, repeated across every row */
+#define LCD_FB_MAX_RUNS (LCD_FB_ROWS * ((LCD_FB_COLS + LCD_FB_MERGE_GAP) / (LCD_FB_MERGE_GAP + 1)))
+
+typedef struct {
+    uint8_t row;
+    uint8_t col;
+    uint8_t len;
+} lcd_fb_run_t;
+
+/* Shadow copy of what the controller's DDRAM currently shows.
+ * Pure data, no bus access, so the diff logic can be exercised on a host. */
+typedef struct {
+    char cells[LCD_FB_ROWS][LCD_FB_COLS];
+    bool valid;     /* false until the panel content is known (e.g. after clear) */
+} lcd_fb_t;
+
+/* Mark the panel as cleared (all cells blank) */
+void lcd_fb_reset(lcd_fb_t* fb);
+/* Forget the panel content so the next diff repaints everything */
+void lcd_fb_invalidate(lcd_fb_t* fb);
+/* Render a NUL-terminated line into a blank-padded row buffer */
+void lcd_fb_fill_row(char row[LCD_FB_COLS], const char* text);
+/* Compute the minimal runs that turn fb into next, returns the run count.
+ * runs must hold at least LCD_FB_MAX_RUNS entries. */
+size_t lcd_fb_diff(const lcd_fb_t* fb, const char next[LCD_FB_ROWS][LCD_FB_COLS],
+                   lcd_fb_run_t* runs, size_t max_runs);
+/* Record that next is now on the panel */
+void lcd_fb_commit(lcd_fb_t* fb, const char next[LCD_FB_ROWS][LCD_FB_COLS]);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,108 @@
+#include "lcd1602_glyph_cache.h"
+#include "lcd1602_vietnamese.h"
+
+#include <cstring>
+
+int Lcd1602GlyphCache::FindSlot(char32_t codepoint) const {
+    for (int i = 0; i < LCD1602_CGRAM_SLOTS; ++i) {
+        if (slots_[i].codepoint == codepoint) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+void Lcd1602GlyphCache::Invalidate() {
+    slots_ = {};
+}
+
+void Lcd1602GlyphCache::Render(const char* line1, const char* line2, char out[LCD1602_ROWS][LCD1602_COLS + 1]) {
+    char32_t cells[LCD1602_ROWS][LCD1602_COLS];
+    const char* lines[LCD1602_ROWS] = {line1, line2};
+    for (int r = 0; r < LCD1602_ROWS; ++r) {
+        const char* p = lines[r] ? lines[r] : "";
+        size_t remaining = strlen(p);
+        for (int c = 0; c < LCD1602_COLS; ++c) {
+            auto ch = vn::DecodeUtf8(p, remaining);
+            p += ch.length;
+            remaining -= ch.length;
+            cells[r][c] = ch.length ? ch.codepoint : U' ';
+        }
+    }
+
+    // Distinct accented letters of this frame, most frequent first
+    struct Wanted {
+        char32_t codepoint;
+        uint8_t count;
+    };
+    Wanted wanted[LCD1602_ROWS * LCD1602_COLS];
+    int wanted_count = 0;
+    for (int r = 0; r < LCD1602_ROWS; ++r) {
+        for (int c = 0; c < LCD1602_COLS; ++c) {
+            char32_t cp = cells[r][c];
+            if (cp < 0x80 || vn::FindLetter(cp) == nullptr) {
+                continue;
+            }
+            int i = 0;
+            while (i < wanted_count && wanted[i].codepoint != cp) ++i;
+            if (i == wanted_count) {
+                wanted[wanted_count++] = {cp, 0};
+            }
+            wanted[i].count++;
+            // Stable bubble towards the front keeps first-seen order on ties
+            while (i > 0 && wanted[i - 1].count < wanted[i].count) {
+                std::swap(wanted[i - 1], wanted[i]);
+                --i;
+            }
+        }
+    }
+
+    frame_++;
+    stats_.frames++;
+    int budget = wanted_count < LCD1602_CGRAM_SLOTS ? wanted_count : LCD1602_CGRAM_SLOTS;
+
+    // Resident letters first, so they are never evicted by this frame
+    bool in_frame[LCD1602_CGRAM_SLOTS] = {};
+    for (int i = 0; i < budget; ++i) {
+        int slot = FindSlot(wanted[i].codepoint);
+        if (slot >= 0) {
+            slots_[slot].last_used = frame_;
+            in_frame[slot] = true;
+            stats_.hits++;
+        }
+    }
+    for (int i = 0; i < budget; ++i) {
+        if (FindSlot(wanted[i].codepoint) >= 0) {
+            continue;
+        }
+        int victim = -1;
+        for (int s = 0; s < LCD1602_CGRAM_SLOTS; ++s) {
+            if (!in_frame[s] && (victim < 0 || slots_[s].last_used < slots_[victim].last_used)) {
+                victim = s;
+            }
+        }
+        auto glyph = vn::ComposeGlyph(*vn::FindLetter(wanted[i].codepoint));
+        upload_(victim, glyph.data());
+        slots_[victim] = {wanted[i].codepoint, frame_};
+        in_frame[victim] = true;
+        stats_.uploads++;
+    }
+    stats_.fallbacks += wanted_count - budget;
+
+    for (int r = 0; r < LCD1602_ROWS; ++r) {
+        for (int c = 0; c < LCD1602_COLS; ++c) {
+            char32_t cp = cells[r][c];
+            char code;
+            if (cp < 0x20) {
+                code = ' ';
+            } else if (cp < 0x80) {
+                code = static_cast<char>(cp);
+            } else {
+                int slot = FindSlot(cp);
+                code = (slot >= 0 && in_frame[slot]) ? LCD1602_CGRAM_CODE_BASE + slot : vn::ToAscii(cp);
+            }
+            out[r][c] = code;
+        }
+        out[r][LCD1602_COLS] = '\0';
+    }
+}
@@ -0,0 +1,53 @@
+#ifndef LCD1602_GLYPH_CACHE_H
+#define LCD1602_GLYPH_CACHE_H
+
+#include <array>
+#include <cstdint>
+#include <functional>
+
+#define LCD1602_COLS 16
+#define LCD1602_ROWS 2
+#define LCD1602_CGRAM_SLOTS 8
+// CGRAM glyphs are addressed through the 0x08..0x0F mirror so a cell is never NUL
+#define LCD1602_CGRAM_CODE_BASE 0x08
+
+struct Lcd1602GlyphStats {
+    uint32_t frames = 0;
+    uint32_t hits = 0;          // accented glyphs already resident in CGRAM
+    uint32_t uploads = 0;       // glyphs written to CGRAM (8 data bytes each)
+    uint32_t fallbacks = 0;     // accented glyphs shown as their base letter
+};
+
+/*
+ * Turns UTF-8 lines into HD44780 cell codes. Accented Vietnamese letters are
+ * ranked by how often they appear in the frame and get one of the 8 CGRAM
+ * slots; letters already resident keep their slot, others evict the least
+ * recently used slot the frame does not need. Anything left over falls back
+ * to its base letter. No bus access happens here except through upload_.
+ */
+class Lcd1602GlyphCache {
+public:
+    using UploadCallback = std::function<void(uint8_t slot, const uint8_t rows[8])>;
+
+    explicit Lcd1602GlyphCache(UploadCallback upload) : upload_(std::move(upload)) {}
+
+    void Render(const char* line1, const char* line2, char out[LCD1602_ROWS][LCD1602_COLS + 1]);
+    // CGRAM content is undefined after a panel reset
+    void Invalidate();
+    const Lcd1602GlyphStats& stats() const { return stats_; }
+
+private:
+    struct Slot {
+        char32_t codepoint = 0;
+        uint32_t last_used = 0;
+    };
+
+    UploadCallback upload_;
+    std::array<Slot, LCD1602_CGRAM_SLOTS> slots_{};
+    uint32_t frame_ = 0;
+    Lcd1602GlyphStats stats_;
+
+    int FindSlot(char32_t codepoint) const;
+};
+
+#endif // LCD1602_GLYPH_CACHE_H
@@ -0,0 +1,347 @@
+#ifndef LCD1602_VIETNAMESE_H
+#define LCD1602_VIETNAMESE_H
+
+/*
+ * Vietnamese text support for HD44780-compatible character LCDs.
+ *
+ * The controller ROM only has ASCII, so every precomposed Vietnamese letter is
+ * described by its base letter, vowel modifier and tone mark. From that we can
+ * either fall back to the base letter or compose a 5x8 bitmap for one of the
+ * eight CGRAM slots. Everything here is constexpr and free of ESP-IDF
+ * dependencies.
+ */
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace vn {
+
+enum Modifier : uint8_t {
+    kModNone,
+    kModBreve,       // ă
+    kModCircumflex,  // â ê ô
+    kModHorn,        // ơ ư
+    kModStroke,      // đ
+};
+
+enum Tone : uint8_t {
+    kToneNone,
+    kToneGrave,      // huyền
+    kToneAcute,      // sắc
+    kToneHook,       // hỏi
+    kToneTilde,      // ngã
+    kToneDot,        // nặng
+};
+
+struct Letter {
+    char32_t codepoint;
+    char base;
+    Modifier modifier;
+    Tone tone;
+};
+
+// Sorted by codepoint for binary search
+inline constexpr Letter kLetters[] = {
+    {0x00C0, 'A', kModNone, kToneGrave},  // À
+    {0x00C1, 'A', kModNone, kToneAcute},  // Á
+    {0x00C2, 'A', kModCircumflex, kToneNone},  // Â
+    {0x00C3, 'A', kModNone, kToneTilde},  // Ã
+    {0x00C8, 'E', kModNone, kToneGrave},  // È
+    {0x00C9, 'E', kModNone, kToneAcute},  // É
+    {0x00CA, 'E', kModCircumflex, kToneNone},  // Ê
+    {0x00CC, 'I', kModNone, kToneGrave},  // Ì
+    {0x00CD, 'I', kModNone, kToneAcute},  // Í
+    {0x00D2, 'O', kModNone, kToneGrave},  // Ò
+    {0x00D3, 'O', kModNone, kToneAcute},  // Ó
+    {0x00D4, 'O', kModCircumflex, kToneNone},  // Ô
+    {0x00D5, 'O', kModNone, kToneTilde},  // Õ
+    {0x00D9, 'U', kModNone, kToneGrave},  // Ù
+    {0x00DA, 'U', kModNone, kToneAcute},  // Ú
+    {0x00DD, 'Y', kModNone, kToneAcute},  // Ý
+    {0x00E0, 'a', kModNone, kToneGrave},  // à
+    {0x00E1, 'a', kModNone, kToneAcute},  // á
+    {0x00E2, 'a', kModCircumflex, kToneNone},  // â
+    {0x00E3, 'a', kModNone, kToneTilde},  // ã
+    {0x00E8, 'e', kModNone, kToneGrave},  // è
+    {0x00E9, 'e', kModNone, kToneAcute},  // é
+    {0x00EA, 'e', kModCircumflex, kToneNone},  // ê
+    {0x00EC, 'i', kModNone, kToneGrave},  // ì
+    {0x00ED, 'i', kModNone, kToneAcute},  // í
+    {0x00F2, 'o', kModNone, kToneGrave},  // ò
+    {0x00F3, 'o', kModNone, kToneAcute},  // ó
+    {0x00F4, 'o', kModCircumflex, kToneNone},  // ô
+    {0x00F5, 'o', kModNone, kToneTilde},  // õ
+    {0x00F9, 'u', kModNone, kToneGrave},  // ù
+    {0x00FA, 'u', kModNone, kToneAcute},  // ú
+    {0x00FD, 'y', kModNone, kToneAcute},  // ý
+    {0x0102, 'A', kModBreve, kToneNone},  // Ă
+    {0x0103, 'a', kModBreve, kToneNone},  // ă
+    {0x0110, 'D', kModStroke, kToneNone},  // Đ
+    {0x0111, 'd', kModStroke, kToneNone},  // đ
+    {0x0128, 'I', kModNone, kToneTilde},  // Ĩ
+    {0x0129, 'i', kModNone, kToneTilde},  // ĩ
+    {0x0168, 'U', kModNone, kToneTilde},  // Ũ
+    {0x0169, 'u', kModNone, kToneTilde},  // ũ
+    {0x01A0, 'O', kModHorn, kToneNone},  // Ơ
+    {0x01A1, 'o', kModHorn, kToneNone},  // ơ
+    {0x01AF, 'U', kModHorn, kToneNone},  // Ư
+    {0x01B0, 'u', kModHorn, kToneNone},  // ư
+    {0x1EA0, 'A', kModNone, kToneDot},  // Ạ
+    {0x1EA1, 'a', kModNone, kToneDot},  // ạ
+    {0x1EA2, 'A', kModNone, kToneHook},  // Ả
+    {0x1EA3, 'a', kModNone, kToneHook},  // ả
+    {0x1EA4, 'A', kModCircumflex, kToneAcute},  // Ấ
+    {0x1EA5, 'a', kModCircumflex, kToneAcute},  // ấ
+    {0x1EA6, 'A', kModCircumflex, kToneGrave},  // Ầ
+    {0x1EA7, 'a', kModCircumflex, kToneGrave},  // ầ
+    {0x1EA8, 'A', kModCircumflex, kToneHook},  // Ẩ
+    {0x1EA9, 'a', kModCircumflex, kToneHook},  // ẩ
+    {0x1EAA, 'A', kModCircumflex, kToneTilde},  // Ẫ
+    {0x1EAB, 'a', kModCircumflex, kToneTilde},  // ẫ
+    {0x1EAC, 'A', kModCircumflex, kToneDot},  // Ậ
+    {0x1EAD, 'a', kModCircumflex, kToneDot},  // ậ
+    {0x1EAE, 'A', kModBreve, kToneAcute},  // Ắ
+    {0x1EAF, 'a', kModBreve, kToneAcute},  // ắ
+    {0x1EB0, 'A', kModBreve, kToneGrave},  // Ằ
+    {0x1EB1, 'a', kModBreve, kToneGrave},  // ằ
+    {0x1EB2, 'A', kModBreve, kToneHook},  // Ẳ
+    {0x1EB3, 'a', kModBreve, kToneHook},  // ẳ
+    {0x1EB4, 'A', kModBreve, kToneTilde},  // Ẵ
+    {0x1EB5, 'a', kModBreve, kToneTilde},  // ẵ
+    {0x1EB6, 'A', kModBreve, kToneDot},  // Ặ
+    {0x1EB7, 'a', kModBreve, kToneDot},  // ặ
+    {0x1EB8, 'E', kModNone, kToneDot},  // Ẹ
+    {0x1EB9, 'e', kModNone, kToneDot},  // ẹ
+    {0x1EBA, 'E', kModNone, kToneHook},  // Ẻ
+    {0x1EBB, 'e', kModNone, kToneHook},  // ẻ
+    {0x1EBC, 'E', kModNone, kToneTilde},  // Ẽ
+    {0x1EBD, 'e', kModNone, kToneTilde},  // ẽ
+    {0x1EBE, 'E', kModCircumflex, kToneAcute},  // Ế
+    {0x1EBF, 'e', kModCircumflex, kToneAcute},  // ế
+    {0x1EC0, 'E', kModCircumflex, kToneGrave},  // Ề
+    {0x1EC1, 'e', kModCircumflex, kToneGrave},  // ề
+    {0x1EC2, 'E', kModCircumflex, kToneHook},  // Ể
+    {0x1EC3, 'e', kModCircumflex, kToneHook},  // ể
+    {0x1EC4, 'E', kModCircumflex, kToneTilde},  // Ễ
+    {0x1EC5, 'e', kModCircumflex, kToneTilde},  // ễ
+    {0x1EC6, 'E', kModCircumflex, kToneDot},  // Ệ
+    {0x1EC7, 'e', kModCircumflex, kToneDot},  // ệ
+    {0x1EC8, 'I', kModNone, kToneHook},  // Ỉ
+    {0x1EC9, 'i', kModNone, kToneHook},  // ỉ
+    {0x1ECA, 'I', kModNone, kToneDot},  // Ị
+    {0x1ECB, 'i', kModNone, kToneDot},  // ị
+    {0x1ECC, 'O', kModNone, kToneDot},  // Ọ
+    {0x1ECD, 'o', kModNone, kToneDot},  // ọ
+    {0x1ECE, 'O', kModNone, kToneHook},  // Ỏ
+    {0x1ECF, 'o', kModNone, kToneHook},  // ỏ
+    {0x1ED0, 'O', kModCircumflex, kToneAcute},  // Ố
+    {0x1ED1, 'o', kModCircumflex, kToneAcute},  // ố
+    {0x1ED2, 'O', kModCircumflex, kToneGrave},  // Ồ
+    {0x1ED3, 'o', kModCircumflex, kToneGrave},  // ồ
+    {0x1ED4, 'O', kModCircumflex, kToneHook},  // Ổ
+    {0x1ED5, 'o', kModCircumflex, kToneHook},  // ổ
+    {0x1ED6, 'O', kModCircumflex, kToneTilde},  // Ỗ
+    {0x1ED7, 'o', kModCircumflex, kToneTilde},  // ỗ
+    {0x1ED8, 'O', kModCircumflex, kToneDot},  // Ộ
+    {0x1ED9, 'o', kModCircumflex, kToneDot},  // ộ
+    {0x1EDA, 'O', kModHorn, kToneAcute},  // Ớ
+    {0x1EDB, 'o', kModHorn, kToneAcute},  // ớ
+    {0x1EDC, 'O', kModHorn, kToneGrave},  // Ờ
+    {0x1EDD, 'o', kModHorn, kToneGrave},  // ờ
+    {0x1EDE, 'O', kModHorn, kToneHook},  // Ở
+    {0x1EDF, 'o', kModHorn, kToneHook},  // ở
+    {0x1EE0, 'O', kModHorn, kToneTilde},  // Ỡ
+    {0x1EE1, 'o', kModHorn, kToneTilde},  // ỡ
+    {0x1EE2, 'O', kModHorn, kToneDot},  // Ợ
+    {0x1EE3, 'o', kModHorn, kToneDot},  // ợ
+    {0x1EE4, 'U', kModNone, kToneDot},  // Ụ
+    {0x1EE5, 'u', kModNone, kToneDot},  // ụ
+    {0x1EE6, 'U', kModNone, kToneHook},  // Ủ
+    {0x1EE7, 'u', kModNone, kToneHook},  // ủ
+    {0x1EE8, 'U', kModHorn, kToneAcute},  // Ứ
+    {0x1EE9, 'u', kModHorn, kToneAcute},  // ứ
+    {0x1EEA, 'U', kModHorn, kToneGrave},  // Ừ
+    {0x1EEB, 'u', kModHorn, kToneGrave},  // ừ
+    {0x1EEC, 'U', kModHorn, kToneHook},  // Ử
+    {0x1EED, 'u', kModHorn, kToneHook},  // ử
+    {0x1EEE, 'U', kModHorn, kToneTilde},  // Ữ
+    {0x1EEF, 'u', kModHorn, kToneTilde},  // ữ
+    {0x1EF0, 'U', kModHorn, kToneDot},  // Ự
+    {0x1EF1, 'u', kModHorn, kToneDot},  // ự
+    {0x1EF2, 'Y', kModNone, kToneGrave},  // Ỳ
+    {0x1EF3, 'y', kModNone, kToneGrave},  // ỳ
+    {0x1EF4, 'Y', kModNone, kToneDot},  // Ỵ
+    {0x1EF5, 'y', kModNone, kToneDot},  // ỵ
+    {0x1EF6, 'Y', kModNone, kToneHook},  // Ỷ
+    {0x1EF7, 'y', kModNone, kToneHook},  // ỷ
+    {0x1EF8, 'Y', kModNone, kToneTilde},  // Ỹ
+    {0x1EF9, 'y', kModNone, kToneTilde},  // ỹ
+};
+
+inline constexpr size_t kLetterCount = sizeof(kLetters) / sizeof(kLetters[0]);
+
+constexpr bool IsSorted() {
+    for (size_t i = 1; i < kLetterCount; ++i) {
+        if (kLetters[i - 1].codepoint >= kLetters[i].codepoint) {
+            return false;
+        }
+    }
+    return true;
+}
+static_assert(IsSorted(), "kLetters must be sorted by codepoint");
+static_assert(kLetterCount == 134, "Vietnamese has 134 precomposed letters");
+
+constexpr const Letter* FindLetter(char32_t codepoint) {
+    size_t lo = 0, hi = kLetterCount;
+    while (lo < hi) {
+        size_t mid = (lo + hi) / 2;
+        if (kLetters[mid].codepoint == codepoint) {
+            return &kLetters[mid];
+        }
+        if (kLetters[mid].codepoint < codepoint) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return nullptr;
+}
+
+struct Utf8Char {
+    char32_t codepoint;
+    uint8_t length;     // bytes consumed, 0 at end of input
+};
+
+constexpr char32_t kReplacementChar = U'?';
+
+// Decode one UTF-8 sequence. Malformed or truncated input yields '?' and
+// consumes one byte so the caller always makes progress.
+constexpr Utf8Char DecodeUtf8(const char* s, size_t size) {
+    if (size == 0 || s[0] == '\0') {
+        return {0, 0};
+    }
+    uint8_t b0 = static_cast<uint8_t>(s[0]);
+    if (b0 < 0x80) {
+        return {b0, 1};
+    }
+    uint8_t length = 0;
+    char32_t cp = 0;
+    if ((b0 & 0xE0) == 0xC0) {
+        length = 2;
+        cp = b0 & 0x1F;
+    } else if ((b0 & 0xF0) == 0xE0) {
+        length = 3;
+        cp = b0 & 0x0F;
+    } else if ((b0 & 0xF8) == 0xF0) {
+        length = 4;
+        cp = b0 & 0x07;
+    } else {
+        return {kReplacementChar, 1};
+    }
+    if (size < length) {
+        return {kReplacementChar, 1};
+    }
+    for (uint8_t i = 1; i < length; ++i) {
+        uint8_t b = static_cast<uint8_t>(s[i]);
+        if ((b & 0xC0) != 0x80) {
+            return {kReplacementChar, 1};
+        }
+        cp = (cp << 6) | (b & 0x3F);
+    }
+    return {cp, length};
+}
+
+static_assert(DecodeUtf8("\xE1\xBB\x87", 3).codepoint == 0x1EC7, "ệ");
+static_assert(DecodeUtf8("\xC4\x91", 2).codepoint == 0x0111, "đ");
+static_assert(DecodeUtf8("\xE1\xBB", 2).codepoint == kReplacementChar, "truncated");
+
+// ASCII shown when a letter does not get a CGRAM slot
+constexpr char ToAscii(char32_t codepoint) {
+    if (codepoint < 0x80) {
+        return static_cast<char>(codepoint);
+    }
+    const Letter* letter = FindLetter(codepoint);
+    return letter ? letter->base : '?';
+}
+
+static_assert(ToAscii(0x1EAD) == 'a', "ậ -> a");
+static_assert(ToAscii(0x0110) == 'D', "Đ -> D");
+
+using Glyph = std::array<uint8_t, 8>;
+
+// Letters drawn in rows 2..6 so rows 0..1 stay free for marks and row 7 for
+// the dot below. Capitals use small-cap shapes for the same reason.
+constexpr std::array<uint8_t, 5> BaseRows(char base) {
+    switch (base) {
+        case 'a': return {0b01110, 0b00001, 0b01111, 0b10001, 0b01111};
+        case 'e': return {0b01110, 0b10001, 0b11111, 0b10000, 0b01110};
+        case 'i': return {0b01100, 0b00100, 0b00100, 0b00100, 0b01110};
+        case 'o': return {0b01110, 0b10001, 0b10001, 0b10001, 0b01110};
+        case 'u': return {0b10001, 0b10001, 0b10001, 0b10011, 0b01101};
+        case 'y': return {0b10001, 0b10001, 0b01111, 0b00001, 0b01110};
+        case 'A': return {0b01110, 0b10001, 0b11111, 0b10001, 0b10001};
+        case 'E': return {0b11111, 0b10000, 0b11110, 0b10000, 0b11111};
+        case 'I': return {0b01110, 0b00100, 0b00100, 0b00100, 0b01110};
+        case 'O': return {0b01110, 0b10001, 0b10001, 0b10001, 0b01110};
+        case 'U': return {0b10001, 0b10001, 0b10001, 0b10001, 0b01110};
+        case 'Y': return {0b10001, 0b10001, 0b01010, 0b00100, 0b00100};
+        default:  return {0, 0, 0, 0, 0};
+    }
+}
+
+constexpr Glyph ComposeGlyph(const Letter& letter) {
+    Glyph g{};
+    if (letter.modifier == kModStroke) {
+        if (letter.base == 'd') {
+            g = {0b00010, 0b00111, 0b00010, 0b01110, 0b10010, 0b10010, 0b01110, 0};
+        } else {
+            g = {0b01110, 0b01001, 0b01001, 0b11101, 0b01001, 0b01001, 0b01110, 0};
+        }
+        return g;
+    }
+
+    auto rows = BaseRows(letter.base);
+    for (size_t i = 0; i < rows.size(); ++i) {
+        g[i + 2] = rows[i];
+    }
+
+    bool has_cap = letter.modifier == kModBreve || letter.modifier == kModCircumflex;
+    switch (letter.modifier) {
+        case kModBreve:      g[1] = 0b10001; break;
+        case kModCircumflex: g[1] = 0b01010; break;
+        case kModHorn:       g[1] |= 0b00001; g[2] |= 0b00010; break;
+        default: break;
+    }
+
+    // With a cap the tone squeezes into row 0, otherwise it gets two rows
+    switch (letter.tone) {
+        case kToneGrave:
+            if (has_cap) { g[0] = 0b01000; } else { g[0] = 0b01000; g[1] |= 0b00100; }
+            break;
+        case kToneAcute:
+            if (has_cap) { g[0] = 0b00010; } else { g[0] = 0b00010; g[1] |= 0b00100; }
+            break;
+        case kToneHook:
+            if (has_cap) { g[0] = 0b00110; } else { g[0] = 0b01100; g[1] |= 0b00100; }
+            break;
+        case kToneTilde:
+            if (has_cap) { g[0] = 0b01101; } else { g[0] = 0b01101; g[1] |= 0b10010; }
+            break;
+        case kToneDot:
+            g[7] = 0b00100;
+            break;
+        default:
+            if (letter.modifier == kModCircumflex) {
+                g[0] = 0b00100;
+            }
+            break;
+    }
+    return g;
+}
+
+static_assert(ComposeGlyph(*FindLetter(0x1EC7))[7] == 0b00100, "ệ has a dot below");
+
+} // namespace vn
+
+#endif // LCD1602_VIETNAMESE_H
@@ -15,6 +15,7 @@
 #include "oled_display.h"
 #include "board.h"
 #include "settings.h"
+#include "audio_latency.h"
 #include "lvgl_theme.h"
 #include "lvgl_display.h"
 
@@ -170,6 +171,33 @@ void McpServer::AddUserOnlyTools() {
             return true;
         });
 
+#if CONFIG_USE_AUDIO_LATENCY_TRACE
+    AddUserOnlyTool("self.audio.get_latency", "Per-stage audio latency histograms (ms) of the uplink and downlink paths",
+        PropertyList({
+            Property("reset", kPropertyTypeBoolean, false)
+        }),
+        [](const PropertyList& properties) -> ReturnValue {
+            cJSON* json = AudioLatency::GetJson();
+            if (properties["reset"].value<bool>()) {
+                AudioLatency::Reset();
+            }
+            return json;
+        });
+#endif
+
+#if CONFIG_USE_UPLINK_SILENCE_SUPPRESSION
+    AddUserOnlyTool("self.audio.get_uplink_stats", "Uplink frames sent and suppressed as silence while listening",
+        PropertyList(),
+        [](const PropertyList& properties) -> ReturnValue {
+            auto stats = Application::GetInstance().GetAudioService().GetUplinkStats();
+            cJSON* json = cJSON_CreateObject();
+            cJSON_AddNumberToObject(json, "sent", stats.sent);
+            cJSON_AddNumberToObject(json, "suppressed", stats.suppressed);
+            cJSON_AddNumberToObject(json, "keepalives", stats.keepalives);
+            return json;
+        });
+#endif
+
     // Display control
 #ifdef HAVE_LVGL
     auto display = dynamic_cast<LvglDisplay*>(Board::GetInstance().GetDisplay());
@@ -7,11 +7,23 @@
 #include <chrono>
 #include <vector>
 
+#include "audio_pool.h"
+#include "audio_latency.h"
+
 struct AudioStreamPacket {
     int sample_rate = 0;
     int frame_duration = 0;
     uint32_t timestamp = 0;
+    uint32_t sequence = 0;  // Transport sequence number, 0 if the transport has none
+    uint32_t decode_index = 0;  // Order of arrival at the decode queue, set by AudioService
     std::vector<uint8_t> payload;
+#if CONFIG_USE_AUDIO_LATENCY_TRACE
+    AudioTrace trace;
+#endif
+
+    ~AudioStreamPacket() { AudioPool::ReleasePayload(std::move(payload)); }
+    static void* operator new(size_t size) { return AudioPool::AllocatePacket(size); }
+    static void operator delete(void* ptr) { AudioPool::FreePacket(ptr); }
 };
 
 struct BinaryProtocol2 {
@@ -51,6 +63,17 @@ public:
     inline int server_frame_duration() const {
         return server_frame_duration_;
     }
+    inline int client_frame_duration() const {
+        return client_frame_duration_;
+    }
+    // Uplink frame duration announced in the next hello message
+    inline void SetClientFrameDuration(int frame_duration) {
+        client_frame_duration_ = frame_duration;
+    }
+    // Uplink frame duration the server hello accepted, 0 if it did not say
+    inline int accepted_client_frame_duration() const {
+        return accepted_client_frame_duration_;
+    }
     inline const std::string& session_id() const {
         return session_id_;
     }
@@ -85,6 +108,8 @@ protected:
 
     int server_sample_rate_ = 24000;
     int server_frame_duration_ = 60;
+    int client_frame_duration_ = 60;
+    int accepted_client_frame_duration_ = 0;
     bool error_occurred_ = false;
     std::string session_id_;
     std::chrono::time_point<std::chrono::steady_clock> last_incoming_time_;
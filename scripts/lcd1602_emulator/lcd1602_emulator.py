@@ -0,0 +1,177 @@
+import argparse
+import re
+import sys
+
+
+'''
+  Replay LCD1602 I2C transactions captured with CONFIG_LCD1602_BUS_RECORDER.
+  Models the ST7032 / AiP31068 command set, reconstructs the screen after
+  every update and reports bus time per update at a given SCL clock.
+'''
+
+LINE_RE = re.compile(r'LCDTX (\d+) ([0-9a-fA-F]+)')
+
+
+class St7032:
+    def __init__(self):
+        self.ddram = [0x20] * 0x80
+        self.cgram = [0] * 64
+        self.address = 0
+        self.cgram_mode = False
+        self.increment = True
+        self.instruction_set = 0
+        self.display_on = False
+        # Analog side, only reachable with IS=1
+        self.contrast = 0
+        self.booster = False
+        self.icon = False
+        self.follower = False
+        self.follower_ratio = 0
+        self.oscillator = 0
+
+    def command(self, cmd):
+        if cmd & 0x80:
+            self.address = cmd & 0x7F
+            self.cgram_mode = False
+        elif cmd & 0x40:
+            # 0x40-0x7F is Set CGRAM Address with IS=0 and the extended table with IS=1
+            if self.instruction_set == 0:
+                self.address = cmd & 0x3F
+                self.cgram_mode = True
+            elif cmd & 0x30 == 0x30:
+                self.contrast = (self.contrast & 0x30) | (cmd & 0x0F)
+            elif cmd & 0x30 == 0x20:
+                self.follower = bool(cmd & 0x08)
+                self.follower_ratio = cmd & 0x07
+            elif cmd & 0x30 == 0x10:
+                self.icon = bool(cmd & 0x08)
+                self.booster = bool(cmd & 0x04)
+                self.contrast = (self.contrast & 0x0F) | ((cmd & 0x03) << 4)
+            # 0x40-0x4F sets the ICON RAM address, icons are not modelled
+        elif cmd & 0x20:
+            self.instruction_set = cmd & 0x01
+        elif cmd & 0x10:
+            if self.instruction_set == 1:
+                self.oscillator = cmd & 0x0F
+            # IS=0: cursor/display shift, the shift is not modelled
+        elif cmd & 0x08:
+            self.display_on = bool(cmd & 0x04)
+        elif cmd & 0x04:
+            self.increment = bool(cmd & 0x02)
+        elif cmd & 0x02:
+            self.address = 0
+            self.cgram_mode = False
+        elif cmd & 0x01:
+            self.ddram = [0x20] * 0x80
+            self.address = 0
+            self.cgram_mode = False
+
+    def data(self, value):
+        step = 1 if self.increment else -1
+        if self.cgram_mode:
+            self.cgram[self.address & 0x3F] = value & 0x1F
+            self.address = (self.address + step) & 0x3F
+        else:
+            self.ddram[self.address & 0x7F] = value
+            self.address = (self.address + step) & 0x7F
+
+    def transaction(self, payload):
+        i = 0
+        while i < len(payload):
+            control = payload[i]
+            i += 1
+            continuation = control & 0x80
+            is_data = control & 0x40
+            chunk = payload[i:i + 1] if continuation else payload[i:]
+            i += len(chunk)
+            for value in chunk:
+                if is_data:
+                    self.data(value)
+                else:
+                    self.command(value)
+
+    def row(self, row, columns=16):
+        base = 0x40 * row
+        out = []
+        for value in self.ddram[base:base + columns]:
+            if value < 0x10:
+                out.append('#')  # CGRAM glyph
+            elif 0x20 <= value < 0x7F:
+                out.append(chr(value))
+            else:
+                out.append('?')
+        return ''.join(out)
+
+
+def bus_time_us(length, clock):
+    # START + address byte + payload bytes (9 clocks each with ACK) + STOP
+    return ((length + 1) * 9 + 2) * 1000000 / clock
+
+
+def load(stream):
+    for line in stream:
+        match = LINE_RE.search(line)
+        if match:
+            yield int(match.group(1)), bytes.fromhex(match.group(2))
+
+
+def group_updates(transactions, gap_us):
+    update = []
+    last = None
+    for timestamp, payload in transactions:
+        if update and timestamp - last > gap_us:
+            yield update
+            update = []
+        update.append((timestamp, payload))
+        last = timestamp
+    if update:
+        yield update
+
+
+def percentile(values, p):
+    ordered = sorted(values)
+    return ordered[min(len(ordered) - 1, int(len(ordered) * p / 100))]
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Replay a LCD1602 I2C bus log')
+    parser.add_argument('log', nargs='?', help='monitor log, stdin if omitted')
+    parser.add_argument('--clock', type=int, default=100000, help='SCL clock in Hz (default 100000)')
+    parser.add_argument('--gap-ms', type=float, default=15, help='idle time that separates updates')
+    parser.add_argument('--quiet', action='store_true', help='only print the summary')
+    args = parser.parse_args()
+
+    stream = open(args.log, encoding='utf-8', errors='replace') if args.log else sys.stdin
+    lcd = St7032()
+    times = []
+    total_bytes = 0
+    total_transactions = 0
+
+    for index, update in enumerate(group_updates(load(stream), args.gap_ms * 1000)):
+        elapsed = 0
+        size = 0
+        for _, payload in update:
+            lcd.transaction(payload)
+            elapsed += bus_time_us(len(payload), args.clock)
+            size += len(payload)
+        times.append(elapsed)
+        total_bytes += size
+        total_transactions += len(update)
+        if not args.quiet:
+            print(f"#{index:<4} t={update[0][0] / 1000:10.1f}ms  tx={len(update):3d}  bytes={size:4d}  bus={elapsed / 1000:6.2f}ms"
+                  f"  |{lcd.row(0)}|{lcd.row(1)}|")
+
+    if not times:
+        print('No LCDTX lines found, enable CONFIG_LCD1602_BUS_RECORDER')
+        return
+    print(f"updates={len(times)} transactions={total_transactions} bytes={total_bytes} "
+          f"bus time per update @ {args.clock / 1000:.0f}kHz: "
+          f"mean={sum(times) / len(times) / 1000:.2f}ms p50={percentile(times, 50) / 1000:.2f}ms "
+          f"p95={percentile(times, 95) / 1000:.2f}ms max={max(times) / 1000:.2f}ms")
+    print(f"panel: display {'on' if lcd.display_on else 'off'} contrast={lcd.contrast}/63 "
+          f"booster={'on' if lcd.booster else 'off'} follower={'on' if lcd.follower else 'off'} "
+          f"ratio={lcd.follower_ratio}")
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,138 @@
+#include <algorithm>
+#include <cstdlib>
+#include <vector>
+
+#include "audio_mixer.h"
+#include "host_test.h"
+
+namespace {
+
+constexpr size_t kSamples = 240;  // One 10 ms output slice at 24 kHz
+
+struct Sources {
+    std::vector<int16_t> speech;
+    std::vector<int16_t> cue;
+    const int16_t* inputs[kAudioMixerSourceCount] = {};
+
+    Sources(int16_t speech_level, int16_t cue_level)
+        : speech(kSamples, speech_level), cue(kSamples, cue_level) {}
+    const int16_t* const* Play(bool speech_on, bool cue_on) {
+        inputs[kAudioMixerSpeech] = speech_on ? speech.data() : nullptr;
+        inputs[kAudioMixerCue] = cue_on ? cue.data() : nullptr;
+        return inputs;
+    }
+};
+
+std::vector<int16_t> Mix(AudioMixer& mixer, const int16_t* const* inputs) {
+    std::vector<int16_t> out(kSamples, 12345);
+    mixer.Mix(inputs, out.data(), out.size());
+    return out;
+}
+
+// Largest change between neighbouring samples, across the previous call too
+int MaxStep(const std::vector<int16_t>& previous, const std::vector<int16_t>& out) {
+    int step = std::abs(out[0] - previous.back());
+    for (size_t i = 1; i < out.size(); i++) {
+        step = std::max(step, std::abs(out[i] - out[i - 1]));
+    }
+    return step;
+}
+
+} // namespace
+
+TEST(UnityGainPassesThrough) {
+    AudioMixer mixer;
+    std::vector<int16_t> speech(kSamples);
+    for (size_t i = 0; i < kSamples; i++) {
+        speech[i] = int16_t(i * 271 - 32767);
+    }
+    const int16_t* inputs[kAudioMixerSourceCount] = {speech.data(), nullptr};
+    CHECK(Mix(mixer, inputs) == speech);
+}
+
+TEST(NothingToPlayIsSilence) {
+    AudioMixer mixer;
+    Sources sources(1000, 1000);
+    CHECK(Mix(mixer, sources.Play(false, false)) == std::vector<int16_t>(kSamples, 0));
+}
+
+TEST(GainScalesEachSource) {
+    AudioMixer mixer;
+    mixer.SetGain(kAudioMixerSpeech, 50);
+    mixer.SetGain(kAudioMixerCue, 25);
+    Sources sources(8000, 8000);
+    auto out = Mix(mixer, sources.Play(true, false));
+    CHECK(out.front() == 4000 && out.back() == 4000);
+    out = Mix(mixer, sources.Play(false, true));
+    CHECK(out.front() == 2000 && out.back() == 2000);
+
+    mixer.SetGain(kAudioMixerSpeech, 150);  // Clamped to unity
+    out = Mix(mixer, sources.Play(true, false));
+    CHECK(out.back() == 8000);
+}
+
+TEST(SumSaturatesSymmetrically) {
+    AudioMixer mixer;
+    Sources loud(30000, 30000);
+    auto out = Mix(mixer, loud.Play(true, true));
+    CHECK(out == std::vector<int16_t>(kSamples, 32767));
+
+    Sources quiet(-30000, -30000);
+    out = Mix(mixer, quiet.Play(true, true));
+    CHECK(out == std::vector<int16_t>(kSamples, -32767));
+}
+
+TEST(CueDucksSpeechWithoutAJump) {
+    AudioMixer mixer;
+    mixer.SetDucking(kAudioMixerCue, 30);
+    Sources sources(10000, 0);
+
+    auto previous = Mix(mixer, sources.Play(true, false));
+    CHECK(previous.back() == 10000);
+
+    // Ramps down across the first call with the cue, then holds
+    auto out = Mix(mixer, sources.Play(true, true));
+    CHECK(out.front() >= 9900);
+    CHECK(out.back() < 3100 && out.back() >= 2999);
+    CHECK(MaxStep(previous, out) <= 10000 * 70 / 100 / int(kSamples) + 2);
+    previous = out;
+    out = Mix(mixer, sources.Play(true, true));
+    CHECK(out.front() == 2999 && out.back() == 2999);
+    CHECK(MaxStep(previous, out) <= 100);
+
+    // And back up once the cue is over
+    previous = out;
+    out = Mix(mixer, sources.Play(true, false));
+    CHECK(out.front() <= 3100);
+    CHECK(out.back() >= 9900);
+    CHECK(MaxStep(previous, out) <= 10000 * 70 / 100 / int(kSamples) + 2);
+    out = Mix(mixer, sources.Play(true, false));
+    CHECK(out.front() == 10000);
+}
+
+TEST(SpeechDoesNotDuckTheCue) {
+    AudioMixer mixer;
+    mixer.SetDucking(kAudioMixerCue, 30);
+    Sources sources(0, 10000);
+    auto out = Mix(mixer, sources.Play(true, true));
+    CHECK(out.front() == 10000 && out.back() == 10000);
+}
+
+TEST(ResetDropsTheDuckLevel) {
+    AudioMixer mixer;
+    mixer.SetDucking(kAudioMixerCue, 0);
+    Sources sources(10000, 0);
+    Mix(mixer, sources.Play(true, true));
+    mixer.Reset();
+    // Without the reset speech would fade in from silence
+    auto out = Mix(mixer, sources.Play(true, false));
+    CHECK(out.front() == 10000);
+}
+
+TEST(EmptyMixLeavesOutputAlone) {
+    AudioMixer mixer;
+    Sources sources(1000, 1000);
+    int16_t out = 7;
+    mixer.Mix(sources.Play(true, true), &out, 0);
+    CHECK(out == 7);
+}
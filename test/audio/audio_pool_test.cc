@@ -0,0 +1,126 @@
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "audio_pool.h"
+#include "audio_service.h"
+#include "host_test.h"
+
+// The pools are process wide, so every case works with differences of the stats
+
+TEST(PacketsComeFromTheSlab) {
+    auto before = AudioPool::GetPacketStats();
+    REQUIRE(before.in_use == 0);
+    std::vector<std::unique_ptr<AudioStreamPacket>> packets;
+    for (int i = 0; i < before.capacity; i++) {
+        packets.push_back(std::make_unique<AudioStreamPacket>());
+    }
+    auto full = AudioPool::GetPacketStats();
+    CHECK(full.in_use == before.capacity);
+    CHECK(full.high_water == before.capacity);
+    CHECK(full.fallbacks == before.fallbacks);
+
+    // Past the capacity packets still work, from the heap
+    packets.push_back(std::make_unique<AudioStreamPacket>());
+    packets.back()->payload.assign(100, 0x5A);
+    CHECK(AudioPool::GetPacketStats().fallbacks == before.fallbacks + 1);
+    CHECK(AudioPool::GetPacketStats().in_use == before.capacity);
+
+    packets.clear();
+    CHECK(AudioPool::GetPacketStats().in_use == 0);
+}
+
+TEST(SlotsAreReused) {
+    auto first = std::make_unique<AudioStreamPacket>();
+    void* address = first.get();
+    first.reset();
+    auto second = std::make_unique<AudioStreamPacket>();
+    CHECK(second.get() == address);
+}
+
+TEST(PayloadKeepsItsCapacity) {
+    // Drain idle payloads so the next Acquire sees the one released here
+    while (AudioPool::AcquirePayload().capacity() > 0) {
+    }
+    {
+        auto packet = std::make_unique<AudioStreamPacket>();
+        packet->payload = AudioPool::AcquirePayload();
+        packet->payload.resize(320);
+    }
+    CHECK(AudioPool::GetPayloadStats().in_use == 1);
+    auto payload = AudioPool::AcquirePayload();
+    CHECK(payload.empty());
+    CHECK(payload.capacity() >= 320);
+    CHECK(AudioPool::GetPayloadStats().in_use == 0);
+
+    // An empty pool hands out a fresh vector and counts the miss
+    auto misses = AudioPool::GetPayloadStats().fallbacks;
+    CHECK(AudioPool::AcquirePayload().capacity() == 0);
+    CHECK(AudioPool::GetPayloadStats().fallbacks == misses + 1);
+}
+
+TEST(PcmKeepsItsCapacity) {
+    while (AudioPool::AcquirePcm().capacity() > 0) {
+    }
+    {
+        auto task = std::make_unique<AudioTask>();
+        task->pcm.resize(960);
+    }
+    auto pcm = AudioPool::AcquirePcm();
+    CHECK(pcm.empty());
+    CHECK(pcm.capacity() == 960);
+}
+
+TEST(FullBufferPoolFreesTheRest) {
+    auto capacity = AudioPool::GetPcmStats().capacity;
+    for (int i = 0; i < capacity + 5; i++) {
+        std::vector<int16_t> pcm(16);
+        AudioPool::ReleasePcm(std::move(pcm));
+    }
+    CHECK(AudioPool::GetPcmStats().in_use == capacity);
+    CHECK(AudioPool::GetPcmStats().high_water == capacity);
+    // Buffers without capacity are not kept
+    while (AudioPool::AcquirePcm().capacity() > 0) {
+    }
+    AudioPool::ReleasePcm(std::vector<int16_t>());
+    CHECK(AudioPool::GetPcmStats().in_use == 0);
+}
+
+TEST(SteadyStreamStaysInThePool) {
+    auto packets = AudioPool::GetPacketStats().fallbacks;
+    auto tasks = AudioPool::GetTaskStats().fallbacks;
+    // Warm up one buffer of each kind, then stream
+    for (int i = 0; i < 1000; i++) {
+        auto packet = std::make_unique<AudioStreamPacket>();
+        packet->payload = AudioPool::AcquirePayload();
+        packet->payload.resize(120);
+        auto task = std::make_unique<AudioTask>();
+        task->pcm = AudioPool::AcquirePcm();
+        task->pcm.resize(960);
+    }
+    CHECK(AudioPool::GetPacketStats().fallbacks == packets);
+    CHECK(AudioPool::GetTaskStats().fallbacks == tasks);
+}
+
+TEST(ThreadsShareThePools) {
+    // Producer and consumer on different threads, as the network and decoder tasks are
+    auto before = AudioPool::GetPacketStats();
+    std::vector<std::unique_ptr<AudioStreamPacket>> handoff[2];
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 2; t++) {
+        threads.emplace_back([&, t] {
+            for (int round = 0; round < 2000; round++) {
+                for (int i = 0; i < 8; i++) {
+                    handoff[t].push_back(std::make_unique<AudioStreamPacket>());
+                }
+                handoff[t].clear();
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    auto after = AudioPool::GetPacketStats();
+    CHECK(after.in_use == 0);
+    CHECK(after.fallbacks == before.fallbacks);
+}
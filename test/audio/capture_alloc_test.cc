@@ -0,0 +1,206 @@
+// Counts heap allocations on the capture path. AudioService::ReadAudioData and
+// AudioInputTask do not build on the host, so CaptureFrame() repeats their
+// steps with the same pieces: codec read into persistent scratch, deinterleave,
+// per-channel PcmResampler, interleave, NoAudioProcessor::Feed, and the
+// AudioTask hand-off that returns the buffer to the pool.
+
+#include <atomic>
+#include <cmath>
+#include <cstdlib>
+#include <memory>
+#include <new>
+#include <vector>
+
+#include "audio_codec.h"
+#include "audio_pool.h"
+#include "audio_service.h"
+#include "host_test.h"
+#include "pcm_kernels.h"
+#include "pcm_resampler.h"
+#include "pcm_view.h"
+#include "processors/no_audio_processor.h"
+
+static std::atomic<long> allocations{0};
+
+// GCC pairs the inlined malloc with the delete below and warns, but both sides
+// of the replacement use the C heap
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+
+void* operator new(size_t size) {
+    allocations++;
+    if (void* ptr = std::malloc(size ? size : 1)) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept {
+    std::free(ptr);
+}
+
+namespace {
+
+// Counts the allocations made while it is alive
+class AllocationCounter {
+public:
+    AllocationCounter() : start_(allocations.load()) {}
+    long count() const { return allocations.load() - start_; }
+
+private:
+    long start_;
+};
+
+class SineCodec : public AudioCodec {
+public:
+    SineCodec(int sample_rate, int channels) {
+        input_sample_rate_ = sample_rate;
+        output_sample_rate_ = sample_rate;
+        input_channels_ = channels;
+        input_enabled_ = true;
+    }
+
+protected:
+    int Read(int16_t* dest, int samples) override {
+        for (int i = 0; i < samples; i++) {
+            dest[i] = int16_t(8000 * std::sin(phase_));
+            phase_ += 0.05;
+        }
+        return samples;
+    }
+    int Write(const int16_t* data, int samples) override { return samples; }
+
+private:
+    double phase_ = 0;
+};
+
+// The capture side of AudioService for one codec
+struct Capture {
+    SineCodec codec;
+    PcmResampler input_resampler;
+    PcmResampler reference_resampler;
+    std::vector<int16_t> capture_buffer;
+    std::vector<int16_t> mic_scratch[2];
+    std::vector<int16_t> reference_scratch[2];
+    std::vector<int16_t> data;
+    NoAudioProcessor processor;
+    size_t frames_out = 0;
+
+    Capture(int sample_rate, int channels) : codec(sample_rate, channels) {
+        input_resampler.Configure(sample_rate, 16000);
+        reference_resampler.Configure(sample_rate, 16000);
+        processor.Initialize(&codec, OPUS_FRAME_DURATION_MS, nullptr);
+        processor.OnOutput([this](std::vector<int16_t>&& pcm) {
+            // PushTaskToEncodeQueue, then the encoder drops the task
+            auto task = std::make_unique<AudioTask>();
+            task->pcm = std::move(pcm);
+            frames_out++;
+        });
+        processor.Start();
+    }
+
+    // As ReadAudioData
+    bool Read(int samples) {
+        if (codec.input_sample_rate() == 16000) {
+            data.resize(samples * codec.input_channels());
+            return codec.InputData(data);
+        }
+        capture_buffer.resize(samples * codec.input_sample_rate() / 16000 * codec.input_channels());
+        if (!codec.InputData(capture_buffer)) {
+            return false;
+        }
+        if (codec.input_channels() == 2) {
+            size_t frames = capture_buffer.size() / 2;
+            size_t output_samples = input_resampler.GetOutputSamples(frames);
+            mic_scratch[0].resize(frames);
+            reference_scratch[0].resize(frames);
+            mic_scratch[1].resize(output_samples);
+            reference_scratch[1].resize(output_samples);
+            pcm::Deinterleave(capture_buffer.data(), mic_scratch[0].data(), reference_scratch[0].data(), frames);
+            input_resampler.Process(mic_scratch[0].data(), frames, mic_scratch[1].data());
+            reference_resampler.Process(reference_scratch[0].data(), frames, reference_scratch[1].data());
+            data.resize(output_samples * 2);
+            pcm::Interleave(mic_scratch[1].data(), reference_scratch[1].data(), data.data(), output_samples);
+        } else {
+            data.resize(input_resampler.GetOutputSamples(capture_buffer.size()));
+            input_resampler.Process(capture_buffer.data(), capture_buffer.size(), data.data());
+        }
+        return true;
+    }
+
+    // One pass of AudioInputTask feeding the processor
+    void CaptureFrame() {
+        if (data.capacity() == 0) {
+            data = AudioPool::AcquirePcm();
+        }
+        if (Read(processor.GetFeedSize())) {
+            processor.Feed(std::move(data));
+        }
+    }
+};
+
+long SteadyStateAllocations(int sample_rate, int channels) {
+    Capture capture(sample_rate, channels);
+    for (int i = 0; i < 10; i++) {
+        capture.CaptureFrame();
+    }
+    AllocationCounter counter;
+    for (int i = 0; i < 500; i++) {
+        capture.CaptureFrame();
+    }
+    long count = counter.count();
+    CHECK(capture.frames_out == 510);
+    return count;
+}
+
+} // namespace
+
+TEST(CounterSeesAllocations) {
+    AllocationCounter counter;
+    auto vector = std::make_unique<std::vector<int>>(10);
+    CHECK(counter.count() == 2);
+}
+
+TEST(MonoAt16kIsAllocationFree) {
+    CHECK(SteadyStateAllocations(16000, 1) == 0);
+}
+
+TEST(MonoResampledIsAllocationFree) {
+    CHECK(SteadyStateAllocations(48000, 1) == 0);
+    CHECK(SteadyStateAllocations(24000, 1) == 0);
+}
+
+TEST(MicAndReferenceResampledIsAllocationFree) {
+    CHECK(SteadyStateAllocations(24000, 2) == 0);
+    CHECK(SteadyStateAllocations(44100, 2) == 0);
+}
+
+TEST(ViewsDoNotCopy) {
+    std::vector<int16_t> interleaved = {1, -1, 2, -2, 3, -3, 4, -4};
+    std::vector<int16_t> reference_copy;
+    reference_copy.reserve(4);
+    std::vector<int16_t> expected_reference = {-1, -2, -3, -4};
+    std::vector<int16_t> expected_mic = {1, 2, 3, 4};
+
+    AllocationCounter counter;
+    auto mic = PcmView::Channel(interleaved, 2, 0);
+    auto reference = PcmView::Channel(interleaved, 2, 1);
+    size_t mic_size = mic.size();
+    bool mic_contiguous = mic.contiguous();
+    int16_t mic_last = mic[3];
+    reference.CopyTo(reference_copy);
+    KeepChannelInPlace(interleaved, 2, 0);
+    bool kept_contiguous = PcmView(interleaved.data(), interleaved.size()).contiguous();
+    long count = counter.count();
+
+    CHECK(mic_size == 4);
+    CHECK(!mic_contiguous);
+    CHECK(mic_last == 4);
+    CHECK(reference_copy == expected_reference);
+    CHECK(interleaved == expected_mic);
+    CHECK(kept_contiguous);
+    CHECK(count == 0);
+}
@@ -0,0 +1,191 @@
+// Full-duplex latency of the Opus codec work with one shared task (the old
+// OpusCodecTask, one decode then one encode per loop) against separate
+// encoder and decoder tasks on their own cores.
+//
+// Opus does not build on the host, so the codec is simulated: every encode
+// and decode takes a configurable time with random spread, and the tasks are
+// simulated on a 100 us clock. Queue limits come from audio_service.h. Mic
+// frames arrive every frame period, TTS arrives in sentence bursts faster than
+// real time, and playback drains one frame per period.
+//
+//   codec_split_bench [--quick] [--encode-ms N] [--decode-ms N]
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <random>
+#include <vector>
+
+#include "audio_service.h"
+
+namespace {
+
+constexpr int kTickUs = 100;
+constexpr int kFrameUs = OPUS_FRAME_DURATION_MS * 1000;
+
+struct Config {
+    double encode_ms = 12;
+    double decode_ms = 4;
+    int seconds = 300;
+};
+
+struct Result {
+    std::vector<int> encode_us;  // Capture to encoded
+    std::vector<int> decode_us;  // Ready to decode (room in the playback queue) to decoded
+    int mic_drops = 0;
+    int underruns = 0;
+};
+
+struct Worker {
+    enum Job { kIdle, kEncode, kDecode } job = kIdle;
+    int64_t done_at = 0;
+    int64_t job_start = 0;  // Capture time or decode ready time
+    bool encode_next = false;  // Shared loop: the encode half of the iteration is next
+};
+
+Result Simulate(const Config& config, bool split) {
+    std::mt19937 rng(1);
+    std::uniform_real_distribution<double> spread(0.5, 1.5);
+    auto cost_us = [&](double ms) {
+        double cost = ms * 1000 * spread(rng);
+        // One frame in 50 is much slower: a cache miss storm, a flash write, a busy core
+        if (rng() % 50 == 0) cost *= 3;
+        return int64_t(cost);
+    };
+
+    Result result;
+    std::deque<int64_t> encode_queue;  // Capture times
+    std::deque<int64_t> decode_queue;  // Arrival times
+    int playback_frames = 0;
+    int64_t decode_ready_since = -1;
+    bool playing = false;
+    Worker workers[2];
+
+    // TTS: a sentence of 8..40 frames every few seconds, sent at 4x real time
+    int64_t next_sentence = 2000000;
+    int sentence_left = 0;
+    int64_t next_packet = 0;
+
+    int64_t end = int64_t(config.seconds) * 1000000;
+    for (int64_t now = 0; now < end; now += kTickUs) {
+        if (now % kFrameUs == 0) {
+            if (encode_queue.size() < MAX_ENCODE_TASKS_IN_QUEUE) {
+                encode_queue.push_back(now);
+            } else {
+                result.mic_drops++;
+            }
+            // The output task plays one frame per period once playback started
+            if (playback_frames > 0) {
+                playback_frames--;
+                playing = true;
+            } else if (playing && sentence_left == 0 && decode_queue.empty()) {
+                playing = false;
+            } else if (playing) {
+                result.underruns++;
+            }
+        }
+        if (now >= next_sentence && sentence_left == 0) {
+            sentence_left = 8 + rng() % 33;
+            next_packet = now;
+            next_sentence = now + int64_t(sentence_left) * kFrameUs + 500000 + rng() % 3000000;
+        }
+        if (sentence_left > 0 && now >= next_packet) {
+            if (decode_queue.size() < MAX_DECODE_QUEUE_MS / OPUS_FRAME_DURATION_MS) {
+                decode_queue.push_back(now);
+            }
+            sentence_left--;
+            next_packet = now + kFrameUs / 4;
+        }
+
+        // Finish jobs
+        for (auto& worker : workers) {
+            if (worker.job != Worker::kIdle && now >= worker.done_at) {
+                if (worker.job == Worker::kEncode) {
+                    result.encode_us.push_back(int(now - worker.job_start));
+                } else {
+                    result.decode_us.push_back(int(now - worker.job_start));
+                    playback_frames++;
+                }
+                worker.job = Worker::kIdle;
+            }
+        }
+
+        bool can_decode = !decode_queue.empty() && playback_frames < MAX_PLAYBACK_TASKS_IN_QUEUE;
+        for (auto& worker : workers) {
+            if (worker.job == Worker::kDecode) can_decode = false;
+        }
+        if (can_decode && decode_ready_since < 0) {
+            decode_ready_since = now;
+        }
+        auto start_decode = [&](Worker& worker) {
+            worker.job = Worker::kDecode;
+            worker.job_start = std::max(decode_ready_since, decode_queue.front());
+            worker.done_at = now + cost_us(config.decode_ms);
+            decode_queue.pop_front();
+            decode_ready_since = -1;
+        };
+        auto start_encode = [&](Worker& worker) {
+            worker.job = Worker::kEncode;
+            worker.job_start = encode_queue.front();
+            worker.done_at = now + cost_us(config.encode_ms);
+            encode_queue.pop_front();
+        };
+
+        if (split) {
+            if (workers[0].job == Worker::kIdle && !encode_queue.empty()) start_encode(workers[0]);
+            if (workers[1].job == Worker::kIdle && can_decode) start_decode(workers[1]);
+        } else if (workers[0].job == Worker::kIdle) {
+            // Each loop iteration tries a decode, then an encode
+            Worker& worker = workers[0];
+            for (int half = 0; half < 2 && worker.job == Worker::kIdle; half++) {
+                if (worker.encode_next && !encode_queue.empty()) {
+                    start_encode(worker);
+                } else if (!worker.encode_next && can_decode) {
+                    start_decode(worker);
+                }
+                worker.encode_next = !worker.encode_next;
+            }
+            if (worker.job == Worker::kIdle) {
+                // Nothing to do: the task blocks and its next iteration starts with a decode
+                worker.encode_next = false;
+            }
+        }
+    }
+    return result;
+}
+
+void Print(const char* name, Result& result) {
+    auto percentile = [](std::vector<int>& values, double p) {
+        std::sort(values.begin(), values.end());
+        return values.empty() ? 0.0 : values[size_t(p * (values.size() - 1))] / 1000.0;
+    };
+    std::printf("%-7s encode p50 %6.1f p99 %6.1f max %6.1f ms | decode p50 %6.1f p99 %6.1f max %6.1f ms"
+        " | mic drops %d, underruns %d\n", name,
+        percentile(result.encode_us, 0.5), percentile(result.encode_us, 0.99), percentile(result.encode_us, 1),
+        percentile(result.decode_us, 0.5), percentile(result.decode_us, 0.99), percentile(result.decode_us, 1),
+        result.mic_drops, result.underruns);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Config config;
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--quick") == 0) {
+            config.seconds = 20;
+        } else if (std::strcmp(argv[i], "--encode-ms") == 0 && i + 1 < argc) {
+            config.encode_ms = std::atof(argv[++i]);
+        } else if (std::strcmp(argv[i], "--decode-ms") == 0 && i + 1 < argc) {
+            config.decode_ms = std::atof(argv[++i]);
+        }
+    }
+    std::printf("%d ms frames, encode %.1f ms, decode %.1f ms (x0.5..1.5, 1 in 50 x3), %d s simulated\n",
+        OPUS_FRAME_DURATION_MS, config.encode_ms, config.decode_ms, config.seconds);
+    Result shared = Simulate(config, false);
+    Result split = Simulate(config, true);
+    Print("shared", shared);
+    Print("split", split);
+    return 0;
+}
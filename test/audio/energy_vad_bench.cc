@@ -0,0 +1,103 @@
+// Runs EnergyVad over labelled mixes from vad_signals.h and reports, per
+// scenario, the 10 ms blocks it got wrong and the time per 60 ms frame. The
+// onset_ms after a voice starts and the hangover_ms after it ends are wrong by
+// design and not counted.
+//
+//   energy_vad_bench [--quick]
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#include "processors/energy_vad.h"
+#include "vad_signals.h"
+
+using namespace vad_signals;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr size_t kBlock = kSampleRate / 100;
+constexpr size_t kFrame = kBlock * 6;
+
+struct Scenario {
+    const char* name;
+    double noise_rms;
+    double voice_rms;
+    std::vector<Segment> segments;
+};
+
+// Talk in bursts with pauses, as in a conversation turn
+std::vector<Segment> Turns(Kind background, int turns) {
+    std::vector<Segment> segments = {{background, 2000}};
+    for (int i = 0; i < turns; i++) {
+        segments.push_back({kVoice, 600 + 300 * (i % 5)});
+        segments.push_back({background, i % 3 == 0 ? 1500 : 250});
+    }
+    segments.push_back({background, 2000});
+    return segments;
+}
+
+void Run(const Scenario& scenario, int seeds) {
+    EnergyVadConfig config;
+    int onset_blocks = config.onset_ms / 10;
+    int hangover_blocks = config.hangover_ms / 10;
+    long blocks = 0, false_alarms = 0, misses = 0;
+    double seconds = 0;
+    size_t frames = 0;
+    for (int seed = 1; seed <= seeds; seed++) {
+        Generator generator(seed, scenario.noise_rms, scenario.voice_rms);
+        Signal signal = generator.Make(scenario.segments);
+
+        // Per block labels, and how far each block is from a label change
+        std::vector<bool> labels;
+        for (size_t i = 0; i + kBlock <= signal.samples.size(); i += kBlock) {
+            labels.push_back(signal.speech[i + kBlock / 2]);
+        }
+        std::vector<bool> states;
+        EnergyVad vad(kSampleRate, config);
+        auto start = Clock::now();
+        for (size_t i = 0; i + kFrame <= signal.samples.size(); i += kFrame) {
+            for (size_t b = 0; b < kFrame; b += kBlock) {
+                states.push_back(vad.Process(signal.samples.data() + i + b, kBlock));
+            }
+            frames++;
+        }
+        seconds += std::chrono::duration<double>(Clock::now() - start).count();
+
+        int since_start = 1 << 20, since_end = 1 << 20;
+        for (size_t i = 0; i < states.size(); i++) {
+            if (i > 0 && labels[i] && !labels[i - 1]) since_start = 0;
+            if (i > 0 && !labels[i] && labels[i - 1]) since_end = 0;
+            bool excused = (labels[i] && since_start < onset_blocks) || (!labels[i] && since_end < hangover_blocks);
+            since_start++;
+            since_end++;
+            if (excused) continue;
+            blocks++;
+            false_alarms += states[i] && !labels[i];
+            misses += !states[i] && labels[i];
+        }
+    }
+    std::printf("%-20s %7ld blocks  %5.2f%% false alarms  %5.2f%% misses  %6.2f us/frame\n", scenario.name,
+        blocks, 100.0 * false_alarms / blocks, 100.0 * misses / blocks, seconds * 1e6 / frames);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    int seeds = argc > 1 && std::strcmp(argv[1], "--quick") == 0 ? 1 : 20;
+    std::vector<Scenario> scenarios = {
+        {"quiet room", 30, 2500, Turns(kQuiet, 12)},
+        {"quiet, soft voice", 30, 400, Turns(kQuiet, 12)},
+        {"noisy room", 300, 2500, Turns(kQuiet, 12)},
+        {"fan hiss", 30, 8000, Turns(kHiss, 12)},
+        {"hiss only", 30, 2500, {{kHiss, 20000}}},
+        {"hum, then talk", 30, 2500, {{kHum, 12000}, {kVoice, 1500}, {kHum, 3000}}},
+    };
+    for (auto& scenario : scenarios) {
+        Run(scenario, seeds);
+    }
+    return 0;
+}
@@ -0,0 +1,178 @@
+// EnergyVad on the labelled signals of vad_signals.h, and NoAudioProcessor
+// reporting it with thresholds taken from the "vad" settings.
+
+#include <vector>
+
+#include "audio_codec.h"
+#include "host_test.h"
+#include "processors/energy_vad.h"
+#include "processors/no_audio_processor.h"
+#include "settings.h"
+#include "vad_signals.h"
+
+using namespace vad_signals;
+
+namespace {
+
+constexpr size_t kBlock = kSampleRate / 100;  // 10 ms
+
+// The speaking state after every 10 ms of the signal
+std::vector<bool> Run(EnergyVad& vad, const Signal& signal) {
+    std::vector<bool> states;
+    for (size_t i = 0; i + kBlock <= signal.samples.size(); i += kBlock) {
+        states.push_back(vad.Process(signal.samples.data() + i, kBlock));
+    }
+    return states;
+}
+
+// First block at or after `from_ms` in the given state, -1 if none
+int FirstMs(const std::vector<bool>& states, bool state, int from_ms = 0) {
+    for (size_t i = from_ms / 10; i < states.size(); i++) {
+        if (states[i] == state) {
+            return int(i + 1) * 10;
+        }
+    }
+    return -1;
+}
+
+class SilentCodec : public AudioCodec {
+public:
+    SilentCodec() {
+        input_sample_rate_ = kSampleRate;
+        input_channels_ = 1;
+    }
+
+protected:
+    int Read(int16_t* dest, int samples) override { return samples; }
+    int Write(const int16_t* data, int samples) override { return samples; }
+};
+
+} // namespace
+
+TEST(QuietRoomIsSilence) {
+    EnergyVad vad;
+    Generator generator;
+    auto states = Run(vad, generator.Make({{kQuiet, 5000}}));
+    CHECK(FirstMs(states, true) == -1);
+    CHECK(vad.noise_floor() < 2000);
+}
+
+TEST(VoiceStartsAfterOnset) {
+    EnergyVad vad;
+    Generator generator;
+    auto states = Run(vad, generator.Make({{kQuiet, 1000}, {kVoice, 1000}}));
+    CHECK(FirstMs(states, true) == 1000 + EnergyVadConfig().onset_ms);
+    CHECK(FirstMs(states, false, 1030) == -1);
+}
+
+TEST(HangoverBridgesPauses) {
+    EnergyVad vad;
+    Generator generator;
+    auto states = Run(vad, generator.Make({{kQuiet, 1000}, {kVoice, 800}, {kQuiet, 250}, {kVoice, 800}, {kQuiet, 1000}}));
+    CHECK(FirstMs(states, true) == 1030);
+    // Still speaking through the pause, then stops hangover_ms after the last voiced block
+    int end = FirstMs(states, false, 1030);
+    CHECK(end >= 2850 + EnergyVadConfig().hangover_ms - 20);
+    CHECK(end <= 2850 + EnergyVadConfig().hangover_ms + 20);
+}
+
+TEST(LongUtteranceIsNotAbsorbed) {
+    EnergyVad vad;
+    Generator generator;
+    auto states = Run(vad, generator.Make({{kQuiet, 500}, {kVoice, 4000}, {kQuiet, 1000}}));
+    CHECK(FirstMs(states, true) == 530);
+    int end = FirstMs(states, false, 530);
+    CHECK(end >= 4500 + EnergyVadConfig().hangover_ms - 20);
+}
+
+TEST(LoudHissIsNotSpeech) {
+    EnergyVad vad;
+    Generator generator;
+    auto states = Run(vad, generator.Make({{kQuiet, 500}, {kHiss, 3000}}));
+    CHECK(FirstMs(states, true) == -1);
+}
+
+TEST(VoiceOverHissIsSpeech) {
+    EnergyVad vad;
+    Generator generator(2, 30, 10000);
+    auto states = Run(vad, generator.Make({{kHiss, 3000}, {kVoice, 1000}, {kHiss, 1000}}));
+    int start = FirstMs(states, true);
+    CHECK(start >= 3000 && start <= 3100);
+}
+
+TEST(SteadyHumIsAbsorbed) {
+    EnergyVad vad;
+    Generator generator;
+    auto states = Run(vad, generator.Make({{kQuiet, 500}, {kHum, 12000}}));
+    // A tone passes the per-block checks at first, the rising floor ends it
+    int start = FirstMs(states, true);
+    CHECK(start > 0);
+    int end = FirstMs(states, false, start);
+    CHECK(end > 0 && end < 500 + 3000);
+    CHECK(FirstMs(states, true, end) == -1);
+}
+
+TEST(ThresholdsFollowTheConfig) {
+    Generator generator;
+    auto signal = generator.Make({{kQuiet, 1000}, {kVoice, 1000}});
+
+    EnergyVadConfig strict;
+    strict.min_rms = 5000;
+    EnergyVad deaf(kSampleRate, strict);
+    CHECK(FirstMs(Run(deaf, signal), true) == -1);
+
+    EnergyVadConfig slow;
+    slow.onset_ms = 200;
+    EnergyVad vad(kSampleRate, slow);
+    CHECK(FirstMs(Run(vad, signal), true) == 1200);
+}
+
+TEST(ResetForgetsSpeech) {
+    EnergyVad vad;
+    Generator generator;
+    Run(vad, generator.Make({{kQuiet, 500}, {kVoice, 500}}));
+    CHECK(vad.speaking());
+    vad.Reset();
+    CHECK(!vad.speaking());
+}
+
+TEST(NoAudioProcessorReportsVad) {
+    Settings settings("vad", true);
+    settings.SetInt("onset_ms", 120);
+    settings.SetInt("hangover_ms", 200);
+
+    SilentCodec codec;
+    NoAudioProcessor processor;
+    processor.Initialize(&codec, 60, nullptr);
+    std::vector<std::pair<size_t, bool>> changes;
+    size_t fed = 0;
+    processor.OnOutput([&](std::vector<int16_t>&& data) { fed += data.size(); });
+    processor.OnVadStateChange([&](bool speaking) { changes.push_back({fed, speaking}); });
+    processor.Start();
+
+    Generator generator;
+    auto signal = generator.Make({{kQuiet, 960}, {kVoice, 960}, {kQuiet, 960}});
+    size_t frame = processor.GetFeedSize();
+    REQUIRE(frame == 960);
+    for (size_t i = 0; i + frame <= signal.samples.size(); i += frame) {
+        processor.Feed(std::vector<int16_t>(signal.samples.begin() + i, signal.samples.begin() + i + frame));
+    }
+    REQUIRE(changes.size() == 2);
+    // Reported while feeding the 60 ms frame in which the state changed: voice
+    // from 960 ms starts speech at 1080 ms, in the frame from 1020 ms, and ends
+    // it 200 ms after 1920 ms, in the frame from 2100 ms
+    CHECK(changes[0].second && changes[0].first == 1020 * 16);
+    CHECK(!changes[1].second && changes[1].first == 2100 * 16);
+
+    // A session stopped mid-speech ends it at the next start
+    for (size_t i = 0; i < 10; i++) {
+        processor.Feed(std::vector<int16_t>(signal.samples.begin() + 960 * 16, signal.samples.begin() + 960 * 16 + frame));
+    }
+    REQUIRE(changes.size() == 3);
+    processor.Stop();
+    processor.Start();
+    REQUIRE(changes.size() == 4);
+    CHECK(!changes[3].second);
+
+    settings.EraseAll();
+}
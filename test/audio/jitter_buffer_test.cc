@@ -0,0 +1,203 @@
+#include <memory>
+#include <vector>
+
+#include "host_test.h"
+#include "jitter_buffer.h"
+
+namespace {
+
+constexpr int kFrameMs = 60;
+
+std::unique_ptr<AudioStreamPacket> Packet(uint32_t sequence) {
+    auto packet = std::make_unique<AudioStreamPacket>();
+    packet->sequence = sequence;
+    packet->frame_duration = kFrameMs;
+    return packet;
+}
+
+// Pops until the buffer has nothing to hand out at now_ms, returns the sequences (0 for a lost frame)
+std::vector<uint32_t> Drain(JitterBuffer& buffer, int64_t now_ms) {
+    std::vector<uint32_t> played;
+    std::unique_ptr<AudioStreamPacket> packet;
+    while (true) {
+        auto status = buffer.Pop(now_ms, packet);
+        if (status == kJitterBufferPacket) {
+            played.push_back(packet->sequence);
+        } else if (status == kJitterBufferLost) {
+            played.push_back(0);
+        } else {
+            return played;
+        }
+    }
+}
+
+} // namespace
+
+TEST(InOrderStreamPlaysAtOnce) {
+    JitterBuffer buffer;
+    buffer.Push(Packet(1), 1000);
+    CHECK(Drain(buffer, 1000) == std::vector<uint32_t>{1});
+    CHECK(buffer.empty());
+    CHECK(buffer.stats().target_depth == JITTER_BUFFER_MIN_DEPTH);
+}
+
+TEST(ReordersPackets) {
+    JitterBuffer buffer;
+    buffer.Push(Packet(1), 1000);
+    Drain(buffer, 1000);
+    buffer.Push(Packet(2), 1060);
+    buffer.Push(Packet(4), 1120);
+    buffer.Push(Packet(3), 1125);
+    CHECK(Drain(buffer, 1130) == (std::vector<uint32_t>{2, 3, 4}));
+    CHECK(buffer.stats().late == 0);
+    CHECK(buffer.stats().concealed == 0);
+}
+
+TEST(OvertakenPacketStillPlays) {
+    // In real time, at the minimum depth: 3 arrives just before 2
+    JitterBuffer buffer;
+    buffer.Push(Packet(1), 1000);
+    Drain(buffer, 1000);
+    buffer.Push(Packet(3), 1118);
+    CHECK(Drain(buffer, 1118).empty());
+    buffer.Push(Packet(2), 1121);
+    CHECK(Drain(buffer, 1121) == (std::vector<uint32_t>{2, 3}));
+    CHECK(buffer.stats().concealed == 0);
+    CHECK(buffer.stats().late == 0);
+}
+
+TEST(WaitsForAMissingFrameThenConceals) {
+    JitterBuffer buffer;
+    buffer.Push(Packet(1), 1000);
+    Drain(buffer, 1000);
+    buffer.Push(Packet(3), 1120);
+
+    std::unique_ptr<AudioStreamPacket> packet;
+    CHECK(buffer.Pop(1120, packet) == kJitterBufferBuffering);
+    // Half a frame later 2 is given up on and concealed, then 3 plays
+    CHECK(buffer.Pop(1120 + kFrameMs / 2, packet) == kJitterBufferLost);
+    CHECK(buffer.Pop(1120 + kFrameMs / 2, packet) == kJitterBufferPacket);
+    CHECK(packet->sequence == 3);
+    CHECK(buffer.stats().concealed == 1);
+
+    // 2 arriving now is too late to play
+    buffer.Push(Packet(2), 1200);
+    CHECK(buffer.stats().late == 1);
+    CHECK(buffer.empty());
+}
+
+TEST(DuplicateIsLate) {
+    JitterBuffer buffer;
+    buffer.Push(Packet(5), 1000);
+    buffer.Push(Packet(5), 1001);
+    CHECK(buffer.size() == 1);
+    CHECK(buffer.stats().late == 1);
+}
+
+TEST(PacedStreamIsNotAnUnderrun) {
+    // A real-time stream leaves the buffer empty between packets, which is normal
+    JitterBuffer buffer;
+    std::unique_ptr<AudioStreamPacket> packet;
+    for (uint32_t sequence = 1; sequence <= 100; sequence++) {
+        int64_t now = 1000 + sequence * kFrameMs;
+        buffer.Push(Packet(sequence), now);
+        CHECK(buffer.Pop(now, packet) == kJitterBufferPacket);
+        CHECK(buffer.Pop(now + 1, packet) == kJitterBufferEmpty);
+    }
+    CHECK(buffer.stats().underruns == 0);
+    CHECK(buffer.stats().target_depth == JITTER_BUFFER_MIN_DEPTH);
+}
+
+TEST(UnderrunCountsWhenTheStreamContinues) {
+    JitterBuffer buffer;
+    buffer.Push(Packet(1), 1000);
+    Drain(buffer, 1000);
+    int depth = buffer.stats().target_depth;
+
+    // Playback ran dry, the next packet arriving shows the stream was not over
+    buffer.Underrun();
+    CHECK(buffer.stats().underruns == 0);
+    buffer.Push(Packet(2), 1065);
+    CHECK(buffer.stats().underruns == 1);
+    CHECK(int(buffer.stats().target_depth) == depth + 1);
+
+    // Playback restarts only with the deeper target buffered, or after waiting for it
+    std::unique_ptr<AudioStreamPacket> packet;
+    CHECK(buffer.Pop(1065, packet) == kJitterBufferBuffering);
+    buffer.Push(Packet(3), 1125);
+    CHECK(Drain(buffer, 1125) == (std::vector<uint32_t>{2, 3}));
+
+    buffer.Underrun();
+    buffer.Push(Packet(4), 1185);
+    CHECK(buffer.stats().underruns == 2);
+    CHECK(buffer.Pop(1185, packet) == kJitterBufferBuffering);
+    CHECK(buffer.Pop(1185 + buffer.stats().target_depth * kFrameMs, packet) == kJitterBufferPacket);
+}
+
+TEST(UnderrunAtTheEndIsNotCounted) {
+    JitterBuffer buffer;
+    buffer.Push(Packet(1), 1000);
+    Drain(buffer, 1000);
+    buffer.Underrun();
+    buffer.Underrun();
+    CHECK(buffer.stats().underruns == 0);
+    // A new stream after a pause starts clean
+    buffer.Push(Packet(500), 5000);
+    CHECK(buffer.stats().underruns == 0);
+    CHECK(Drain(buffer, 5000) == std::vector<uint32_t>{500});
+}
+
+TEST(UnsequencedPacketsAreNumbered) {
+    JitterBuffer buffer;
+    for (int i = 0; i < 3; i++) {
+        buffer.Push(Packet(0), 1000);
+    }
+    CHECK(Drain(buffer, 1000) == (std::vector<uint32_t>{1, 2, 3}));
+    buffer.Push(Packet(0), 1200);
+    CHECK(Drain(buffer, 1200) == std::vector<uint32_t>{4});
+}
+
+TEST(SequenceJumpRestarts) {
+    JitterBuffer buffer;
+    buffer.Push(Packet(10), 1000);
+    buffer.Push(Packet(11), 1000);
+    buffer.Push(Packet(10 + 4 * JITTER_BUFFER_MAX_PACKETS), 1060);
+    CHECK(buffer.size() == 1);
+    CHECK(Drain(buffer, 1060) == std::vector<uint32_t>{10 + 4 * JITTER_BUFFER_MAX_PACKETS});
+}
+
+TEST(FarAheadPacketSkipsTheWindow) {
+    JitterBuffer buffer;
+    buffer.Push(Packet(1), 1000);
+    buffer.Push(Packet(2), 1000);
+    // 1 and 2 are pushed out of the window to make room
+    buffer.Push(Packet(1 + JITTER_BUFFER_MAX_PACKETS + 1), 1000);
+    CHECK(buffer.stats().late == 2);
+    CHECK(buffer.size() == 1);
+}
+
+TEST(LateArrivalsRaiseTheTarget) {
+    JitterBuffer buffer;
+    std::unique_ptr<AudioStreamPacket> packet;
+    // Every other packet comes 50 ms late
+    for (uint32_t sequence = 1; sequence <= 60; sequence++) {
+        int64_t now = 1000 + sequence * kFrameMs + (sequence % 2 ? 50 : 0);
+        buffer.Push(Packet(sequence), now);
+        Drain(buffer, now);
+    }
+    CHECK(buffer.stats().jitter_ms > 10);
+    CHECK(buffer.stats().target_depth > JITTER_BUFFER_MIN_DEPTH);
+    CHECK(buffer.stats().target_depth <= JITTER_BUFFER_MAX_DEPTH);
+}
+
+TEST(EarlyBurstsDoNotRaiseTheTarget) {
+    // The server sends TTS faster than real time, packets arriving early cost nothing
+    JitterBuffer buffer;
+    for (uint32_t sequence = 1; sequence <= 16; sequence++) {
+        buffer.Push(Packet(sequence), 1000 + sequence * 5);
+    }
+    CHECK(buffer.full());
+    CHECK(buffer.stats().jitter_ms == 0);
+    CHECK(buffer.stats().target_depth == JITTER_BUFFER_MIN_DEPTH);
+    CHECK(Drain(buffer, 2000).size() == 16);
+}
@@ -0,0 +1,172 @@
+// What playing an activation code costs the caller: six digit sounds, once
+// with the page scan and packet copies PlaySound did on every call, once
+// through the cached OggOpusIndex. The decoder task still copies each packet
+// into a pooled payload, which is timed separately. The old caller also waited
+// on the full decode queue, which no host timing shows.
+//
+//   ogg_opus_index_bench [--quick]
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "host_runtime.h"
+#include "ogg_opus_index.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct Packet {
+    int sample_rate;
+    std::vector<uint8_t> payload;
+};
+
+// The parsing half of the old AudioService::PlaySound, which then pushed each
+// packet to the decode queue
+size_t ScanAndCopy(std::string_view ogg, std::vector<std::unique_ptr<Packet>>& out) {
+    const uint8_t* buf = reinterpret_cast<const uint8_t*>(ogg.data());
+    size_t size = ogg.size();
+    size_t offset = 0;
+    auto find_page = [&](size_t start)->size_t {
+        for (size_t i = start; i + 4 <= size; ++i) {
+            if (buf[i] == 'O' && buf[i+1] == 'g' && buf[i+2] == 'g' && buf[i+3] == 'S') return i;
+        }
+        return static_cast<size_t>(-1);
+    };
+    bool seen_head = false;
+    bool seen_tags = false;
+    int sample_rate = 16000;
+    size_t copied = 0;
+    while (true) {
+        size_t pos = find_page(offset);
+        if (pos == static_cast<size_t>(-1)) break;
+        offset = pos;
+        if (offset + 27 > size) break;
+        const uint8_t* page = buf + offset;
+        uint8_t page_segments = page[26];
+        size_t seg_table_off = offset + 27;
+        if (seg_table_off + page_segments > size) break;
+        size_t body_size = 0;
+        for (size_t i = 0; i < page_segments; ++i) body_size += page[27 + i];
+        size_t body_off = seg_table_off + page_segments;
+        if (body_off + body_size > size) break;
+        size_t cur = body_off;
+        size_t seg_idx = 0;
+        while (seg_idx < page_segments) {
+            size_t pkt_len = 0;
+            size_t pkt_start = cur;
+            bool continued = false;
+            do {
+                uint8_t l = page[27 + seg_idx++];
+                pkt_len += l;
+                cur += l;
+                continued = (l == 255);
+            } while (continued && seg_idx < page_segments);
+            if (pkt_len == 0) continue;
+            const uint8_t* pkt_ptr = buf + pkt_start;
+            if (!seen_head) {
+                if (pkt_len >= 19 && std::memcmp(pkt_ptr, "OpusHead", 8) == 0) {
+                    seen_head = true;
+                    sample_rate = pkt_ptr[12] | (pkt_ptr[13] << 8) | (pkt_ptr[14] << 16) | (pkt_ptr[15] << 24);
+                }
+                continue;
+            }
+            if (!seen_tags) {
+                if (pkt_len >= 8 && std::memcmp(pkt_ptr, "OpusTags", 8) == 0) {
+                    seen_tags = true;
+                }
+                continue;
+            }
+            auto packet = std::make_unique<Packet>();
+            packet->sample_rate = sample_rate;
+            packet->payload.resize(pkt_len);
+            std::memcpy(packet->payload.data(), pkt_ptr, pkt_len);
+            copied += pkt_len;
+            out.push_back(std::move(packet));
+        }
+        offset = body_off + body_size;
+    }
+    return copied;
+}
+
+std::string ReadFile(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(in), {});
+}
+
+template <typename Body>
+double MicrosecondsPerCall(int iterations, Body body) {
+    auto start = Clock::now();
+    for (int i = 0; i < iterations; i++) {
+        body();
+    }
+    return std::chrono::duration<double, std::micro>(Clock::now() - start).count() / iterations;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    bool quick = argc > 1 && std::strcmp(argv[1], "--quick") == 0;
+    int iterations = quick ? 20 : 2000;
+    host_log_set_level('W');
+
+    std::vector<std::string> digits;
+    size_t bytes = 0;
+    for (const char* digit : {"1", "9", "4", "7", "0", "2"}) {
+        digits.push_back(ReadFile(std::string(HOST_TEST_ASSETS_DIR "/locales/en-US/") + digit + ".ogg"));
+        bytes += digits.back().size();
+    }
+    for (auto& digit : digits) {
+        OggOpusIndex::Get(digit);
+    }
+
+    size_t copied = 0;
+    std::vector<std::unique_ptr<Packet>> packets;
+    double scan_us = MicrosecondsPerCall(iterations, [&] {
+        packets.clear();
+        copied = 0;
+        for (auto& digit : digits) {
+            copied += ScanAndCopy(digit, packets);
+        }
+    });
+
+    size_t queued = 0;
+    double index_us = MicrosecondsPerCall(iterations, [&] {
+        queued = 0;
+        for (auto& digit : digits) {
+            queued += OggOpusIndex::Get(digit)->size();
+        }
+    });
+
+    std::vector<uint8_t> payload;
+    payload.reserve(1500);
+    double decoder_us = MicrosecondsPerCall(iterations, [&] {
+        for (auto& digit : digits) {
+            const OggOpusIndex* sound = OggOpusIndex::Get(digit);
+            for (size_t i = 0; i < sound->size(); i++) {
+                payload.assign(sound->packet_data(i), sound->packet_data(i) + sound->packet_size(i));
+            }
+        }
+    });
+
+    double build_us = MicrosecondsPerCall(iterations, [&] {
+        for (auto& digit : digits) {
+            OggOpusIndex index(digit);
+            if (index.empty()) std::abort();
+        }
+    });
+
+    std::printf("6 digits, %zu bytes of Ogg, %zu packets\n", bytes, queued);
+    std::printf("caller, scan and copy   %8.2f us  %zu bytes copied, %zu allocations\n", scan_us, copied, packets.size() * 2);
+    std::printf("caller, cached index    %8.2f us  0 bytes copied\n", index_us);
+    std::printf("decoder task, copy out  %8.2f us  into a pooled payload\n", decoder_us);
+    std::printf("first play, build index %8.2f us  once per sound\n", build_us);
+    return 0;
+}
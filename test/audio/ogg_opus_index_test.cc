@@ -0,0 +1,232 @@
+// OggOpusIndex on hand-built pages and on every sound shipped in main/assets,
+// against a plain Ogg demuxer that reassembles packets across pages.
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include "host_test.h"
+#include "ogg_opus_index.h"
+
+namespace {
+
+using Bytes = std::vector<uint8_t>;
+
+struct Packet {
+    Bytes data;
+    bool spans_pages = false;
+};
+
+// Every packet of the stream, headers included, in order
+std::vector<Packet> Demux(const std::string& ogg) {
+    std::vector<Packet> packets;
+    Packet pending;
+    bool open = false;
+    size_t offset = 0;
+    while (offset + 27 <= ogg.size() && ogg.compare(offset, 4, "OggS") == 0) {
+        const uint8_t* page = reinterpret_cast<const uint8_t*>(ogg.data()) + offset;
+        int segments = page[26];
+        const uint8_t* body = page + 27 + segments;
+        for (int i = 0; i < segments; i++) {
+            if (!open) {
+                pending = Packet();
+                open = true;
+            }
+            pending.data.insert(pending.data.end(), body, body + page[27 + i]);
+            body += page[27 + i];
+            if (page[27 + i] < 255) {
+                packets.push_back(pending);
+                open = false;
+            } else if (i == segments - 1) {
+                pending.spans_pages = true;
+            }
+        }
+        offset = body - reinterpret_cast<const uint8_t*>(ogg.data());
+    }
+    return packets;
+}
+
+// One Ogg page holding the given packets; with `continued` the last one has no
+// terminating lacing value and goes on at the start of the next page
+void AppendPage(std::string& ogg, const std::vector<Bytes>& packets, bool continued = false) {
+    std::string lacing;
+    std::string body;
+    for (size_t p = 0; p < packets.size(); p++) {
+        size_t length = packets[p].size();
+        bool last_continued = continued && p == packets.size() - 1;
+        while (length >= 255) {
+            lacing += char(255);
+            length -= 255;
+        }
+        if (!last_continued) {
+            lacing += char(length);
+        }
+        body.append(packets[p].begin(), packets[p].end());
+    }
+    std::string header = "OggS";
+    header.append(22, '\0');
+    header += char(lacing.size());
+    ogg += header + lacing + body;
+}
+
+Bytes OpusHead(uint32_t sample_rate) {
+    Bytes head = {'O', 'p', 'u', 's', 'H', 'e', 'a', 'd', 1, 1, 0x38, 0x01};
+    for (int i = 0; i < 4; i++) {
+        head.push_back(uint8_t(sample_rate >> (8 * i)));
+    }
+    head.insert(head.end(), {0, 0, 0});
+    return head;
+}
+
+Bytes OpusTags() {
+    return {'O', 'p', 'u', 's', 'T', 'a', 'g', 's', 0, 0, 0, 0, 0, 0, 0, 0};
+}
+
+Bytes Audio(size_t length, uint8_t fill) {
+    return Bytes(length, fill);
+}
+
+Bytes PacketAt(const OggOpusIndex& index, size_t i) {
+    return Bytes(index.packet_data(i), index.packet_data(i) + index.packet_size(i));
+}
+
+std::string ReadFile(const std::filesystem::path& path) {
+    std::ifstream in(path, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(in), {});
+}
+
+} // namespace
+
+TEST(ReadsHeadersAndPackets) {
+    std::string ogg;
+    AppendPage(ogg, {OpusHead(24000)});
+    AppendPage(ogg, {OpusTags()});
+    AppendPage(ogg, {Audio(3, 1), Audio(120, 2), Audio(255, 3), Audio(600, 4)});
+    AppendPage(ogg, {Audio(1, 5)});
+
+    OggOpusIndex index(ogg);
+    CHECK(index.sample_rate() == 24000);
+    REQUIRE(index.size() == 5);
+    CHECK(PacketAt(index, 0) == Audio(3, 1));
+    CHECK(PacketAt(index, 1) == Audio(120, 2));
+    CHECK(PacketAt(index, 2) == Audio(255, 3));
+    CHECK(PacketAt(index, 3) == Audio(600, 4));
+    CHECK(PacketAt(index, 4) == Audio(1, 5));
+    // Views into the data, not copies
+    CHECK(index.packet_data(0) > reinterpret_cast<const uint8_t*>(ogg.data()));
+    CHECK(index.packet_data(4) < reinterpret_cast<const uint8_t*>(ogg.data()) + ogg.size());
+}
+
+TEST(SkipsPacketsSplitAcrossPages) {
+    std::string ogg;
+    AppendPage(ogg, {OpusHead(16000)});
+    AppendPage(ogg, {OpusTags()});
+    Bytes split = Audio(300, 7);
+    AppendPage(ogg, {Audio(10, 1), Bytes(split.begin(), split.begin() + 255)}, true);
+    AppendPage(ogg, {Bytes(split.begin() + 255, split.end()), Audio(20, 2)});
+
+    OggOpusIndex index(ogg);
+    REQUIRE(index.size() == 2);
+    CHECK(PacketAt(index, 0) == Audio(10, 1));
+    CHECK(PacketAt(index, 1) == Audio(20, 2));
+}
+
+TEST(StopsAtTruncatedPage) {
+    std::string ogg;
+    AppendPage(ogg, {OpusHead(16000)});
+    AppendPage(ogg, {OpusTags()});
+    AppendPage(ogg, {Audio(40, 1)});
+    AppendPage(ogg, {Audio(40, 2)});
+    ogg.resize(ogg.size() - 10);
+
+    OggOpusIndex index(ogg);
+    REQUIRE(index.size() == 1);
+    CHECK(PacketAt(index, 0) == Audio(40, 1));
+}
+
+TEST(NoHeadersMeansNoPackets) {
+    std::string ogg;
+    AppendPage(ogg, {Audio(40, 1), Audio(40, 2)});
+    OggOpusIndex index(ogg);
+    CHECK(index.empty());
+    CHECK(index.sample_rate() == 16000);
+
+    OggOpusIndex nothing(std::string_view{});
+    CHECK(nothing.empty());
+}
+
+TEST(FrameDurationFromToc) {
+    // SILK 60 ms, hybrid 20 ms, CELT 2.5 ms, each as one frame
+    CHECK(OggOpusIndex::PacketDurationMs(Bytes{(3 << 3) | 0, 0}.data(), 2) == 60);
+    CHECK(OggOpusIndex::PacketDurationMs(Bytes{(13 << 3) | 0, 0}.data(), 2) == 20);
+    CHECK(OggOpusIndex::PacketDurationMs(Bytes{(16 << 3) | 0, 0}.data(), 2) == 2);
+    // Two 10 ms CELT frames, then a code 3 packet carrying six 20 ms SILK frames
+    CHECK(OggOpusIndex::PacketDurationMs(Bytes{(18 << 3) | 1, 0}.data(), 2) == 20);
+    CHECK(OggOpusIndex::PacketDurationMs(Bytes{(1 << 3) | 3, 6}.data(), 2) == 120);
+    CHECK(OggOpusIndex::PacketDurationMs(Bytes{(1 << 3) | 3}.data(), 1) == 0);
+    CHECK(OggOpusIndex::PacketDurationMs(nullptr, 0) == 0);
+
+    std::string ogg;
+    AppendPage(ogg, {OpusHead(16000)});
+    AppendPage(ogg, {OpusTags()});
+    AppendPage(ogg, {Audio(40, (17 << 3) | 0), Audio(40, (17 << 3) | 0)});
+    OggOpusIndex index(ogg);
+    CHECK(index.frame_duration_ms() == 5);
+
+    OggOpusIndex empty(std::string_view{});
+    CHECK(empty.frame_duration_ms() == 60);
+}
+
+TEST(GetCachesPerBlob) {
+    std::string first, second;
+    AppendPage(first, {OpusHead(16000)});
+    AppendPage(first, {OpusTags()});
+    AppendPage(first, {Audio(40, 1)});
+    second = first;
+
+    const OggOpusIndex* index = OggOpusIndex::Get(first);
+    CHECK(index->size() == 1);
+    CHECK(OggOpusIndex::Get(first) == index);
+    CHECK(OggOpusIndex::Get(second) != index);
+}
+
+TEST(MatchesDemuxerOnAssets) {
+    int sounds = 0;
+    for (auto& entry : std::filesystem::recursive_directory_iterator(HOST_TEST_ASSETS_DIR)) {
+        if (entry.path().extension() != ".ogg") {
+            continue;
+        }
+        std::string ogg = ReadFile(entry.path());
+        auto packets = Demux(ogg);
+        REQUIRE(packets.size() >= 2);
+        std::vector<Bytes> expected;
+        for (size_t i = 2; i < packets.size(); i++) {
+            if (!packets[i].spans_pages && !packets[i].data.empty()) {
+                expected.push_back(packets[i].data);
+            }
+        }
+
+        OggOpusIndex index(ogg);
+        uint32_t sample_rate;
+        std::memcpy(&sample_rate, packets[0].data.data() + 12, 4);
+        CHECK(index.sample_rate() == int(sample_rate));
+        CHECK(index.size() == expected.size());
+        bool same = index.size() == expected.size();
+        for (size_t i = 0; same && i < expected.size(); i++) {
+            same = PacketAt(index, i) == expected[i];
+        }
+        if (!same) {
+            std::printf("  %s differs\n", entry.path().c_str());
+        }
+        CHECK(same);
+        for (size_t i = 0; i < expected.size(); i++) {
+            CHECK(OggOpusIndex::PacketDurationMs(expected[i].data(), expected[i].size()) == index.frame_duration_ms());
+        }
+        sounds++;
+    }
+    std::printf("  %d sounds\n", sounds);
+    CHECK(sounds > 0);
+}
@@ -0,0 +1,86 @@
+#include "host_test.h"
+#include "opus_complexity.h"
+
+namespace {
+
+constexpr int kFrameMs = 60;
+// 40% of a 60 ms frame
+constexpr int64_t kBudgetUs = 24000;
+
+// Feeds frames of the given encode time until complexity changes, returns how many it took
+int FramesToChange(OpusComplexity& complexity, int64_t encode_us, int limit = 1000) {
+    for (int i = 1; i <= limit; i++) {
+        if (complexity.Update(encode_us, kFrameMs)) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+} // namespace
+
+TEST(StartsAtZeroAndRisesWhenCalm) {
+    OpusComplexity complexity(5, 40);
+    CHECK(complexity.complexity() == 0);
+    int frames = FramesToChange(complexity, kBudgetUs / 4);
+    CHECK(frames == OPUS_COMPLEXITY_SETTLE_FRAMES + OPUS_COMPLEXITY_RAISE_FRAMES - 1);
+    CHECK(complexity.complexity() == 1);
+    for (int i = 0; i < 10; i++) {
+        FramesToChange(complexity, kBudgetUs / 4);
+    }
+    CHECK(complexity.complexity() == 5);
+    CHECK(FramesToChange(complexity, kBudgetUs / 4) == -1);
+}
+
+TEST(DropsOnAnOverrun) {
+    OpusComplexity complexity(5, 40);
+    while (complexity.complexity() < 3) {
+        FramesToChange(complexity, 1000);
+    }
+    CHECK(complexity.Update(kBudgetUs + 1, kFrameMs));
+    CHECK(complexity.complexity() == 2);
+}
+
+TEST(DropsWhenTheAverageIsHigh) {
+    OpusComplexity complexity(5, 40);
+    while (complexity.complexity() < 2) {
+        FramesToChange(complexity, 1000);
+    }
+    // Every frame fits, but the average sits above 3/4 of the budget
+    CHECK(FramesToChange(complexity, kBudgetUs * 4 / 5) == OPUS_COMPLEXITY_SETTLE_FRAMES);
+    CHECK(complexity.complexity() == 1);
+}
+
+TEST(HoldsInTheMiddleBand) {
+    OpusComplexity complexity(5, 40);
+    FramesToChange(complexity, 1000);
+    REQUIRE(complexity.complexity() == 1);
+    CHECK(FramesToChange(complexity, kBudgetUs / 2) == -1);
+    CHECK(complexity.complexity() == 1);
+}
+
+TEST(NeverBelowZeroOrAboveMax) {
+    OpusComplexity complexity(2, 40);
+    CHECK(FramesToChange(complexity, kBudgetUs * 10) == -1);
+    CHECK(complexity.complexity() == 0);
+    OpusComplexity capped(99, 40);
+    for (int i = 0; i < 20; i++) {
+        FramesToChange(capped, 0);
+    }
+    CHECK(capped.complexity() == 10);
+}
+
+TEST(DisabledAtMaxZero) {
+    OpusComplexity complexity(0, 40);
+    CHECK(FramesToChange(complexity, 0) == -1);
+    CHECK(complexity.complexity() == 0);
+}
+
+TEST(ResetRestartsMeasurement) {
+    OpusComplexity complexity(5, 40);
+    FramesToChange(complexity, 1000);
+    REQUIRE(complexity.complexity() == 1);
+    complexity.Reset();
+    CHECK(complexity.complexity() == 0);
+    CHECK(complexity.average_us() == 0);
+}
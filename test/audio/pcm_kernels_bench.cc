@@ -0,0 +1,140 @@
+// Times each pcm:: kernel against the loop it replaced (pcm_reference.h) on one
+// 60 ms frame, in the layout of Google Benchmark's console output. Host numbers
+// only show the relative cost; the firmware is built with its own flags.
+//
+//   pcm_kernels_bench [--quick]
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "pcm_kernels.h"
+#include "pcm_reference.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr size_t kFrame = 960;  // 60 ms at 16 kHz
+double min_seconds = 0.5;
+
+// Keeps the compiler from dropping a result nobody reads
+template <typename T>
+void DoNotOptimize(T const& value) {
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+void Run(const char* name, const std::function<void()>& body) {
+    // Doubles the iteration count until a run is long enough to time
+    for (long iterations = 1;; iterations *= 2) {
+        auto start = Clock::now();
+        for (long i = 0; i < iterations; i++) {
+            body();
+        }
+        double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+        if (seconds >= min_seconds || iterations >= (1L << 40)) {
+            double ns = seconds * 1e9 / iterations;
+            std::printf("%-32s %10.1f ns %12ld %10.1f M/s\n", name, ns, iterations, kFrame / ns * 1e3);
+            return;
+        }
+    }
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    if (argc > 1 && std::strcmp(argv[1], "--quick") == 0) {
+        min_seconds = 0.01;
+    }
+
+    std::mt19937 random(1);
+    std::vector<int16_t> in(kFrame * 2), work(kFrame * 2), left(kFrame), right(kFrame), taps(kFrame);
+    std::vector<int32_t> slots(kFrame);
+    for (auto& sample : in) {
+        sample = int16_t(random());
+    }
+    for (auto& slot : slots) {
+        slot = int32_t(random());
+    }
+    for (auto& tap : taps) {
+        tap = int16_t(int(random() % 64) - 32);
+    }
+    std::vector<int32_t> wide(kFrame);
+
+    std::printf("%-32s %13s %12s %12s\n", "Benchmark", "Time", "Iterations", "Samples");
+    std::printf("%s\n", std::string(72, '-').c_str());
+
+    Run("ScaleToInt32/reference", [&] {
+        reference::ScaleToInt32(in.data(), wide.data(), kFrame, 40000);
+        DoNotOptimize(wide[kFrame - 1]);
+    });
+    Run("ScaleToInt32/pcm", [&] {
+        pcm::ScaleToInt32(in.data(), wide.data(), kFrame, 40000);
+        DoNotOptimize(wide[kFrame - 1]);
+    });
+    Run("ShiftToInt16/reference", [&] {
+        reference::ShiftToInt16(slots.data(), work.data(), kFrame, 12);
+        DoNotOptimize(work[kFrame - 1]);
+    });
+    Run("ShiftToInt16/pcm", [&] {
+        pcm::ShiftToInt16(slots.data(), work.data(), kFrame, 12);
+        DoNotOptimize(work[kFrame - 1]);
+    });
+    Run("ApplyGain/reference", [&] {
+        std::memcpy(work.data(), in.data(), kFrame * sizeof(int16_t));
+        reference::ApplyGain(work.data(), kFrame, 10);
+        DoNotOptimize(work[kFrame - 1]);
+    });
+    Run("ApplyGain/pcm", [&] {
+        std::memcpy(work.data(), in.data(), kFrame * sizeof(int16_t));
+        pcm::ApplyGain(work.data(), kFrame, 10);
+        DoNotOptimize(work[kFrame - 1]);
+    });
+    Run("MixInto/reference", [&] {
+        reference::MixInto(work.data(), in.data(), kFrame);
+        DoNotOptimize(work[kFrame - 1]);
+    });
+    Run("MixInto/pcm", [&] {
+        pcm::MixInto(work.data(), in.data(), kFrame);
+        DoNotOptimize(work[kFrame - 1]);
+    });
+    Run("Deinterleave/reference", [&] {
+        reference::Deinterleave(in.data(), left.data(), right.data(), kFrame);
+        DoNotOptimize(right[kFrame - 1]);
+    });
+    Run("Deinterleave/pcm", [&] {
+        pcm::Deinterleave(in.data(), left.data(), right.data(), kFrame);
+        DoNotOptimize(right[kFrame - 1]);
+    });
+    Run("Interleave/reference", [&] {
+        reference::Interleave(left.data(), right.data(), work.data(), kFrame);
+        DoNotOptimize(work[kFrame * 2 - 1]);
+    });
+    Run("Interleave/pcm", [&] {
+        pcm::Interleave(left.data(), right.data(), work.data(), kFrame);
+        DoNotOptimize(work[kFrame * 2 - 1]);
+    });
+    Run("DotProduct/reference", [&] {
+        DoNotOptimize(reference::DotProduct(in.data(), taps.data(), kFrame));
+    });
+    Run("DotProduct/pcm", [&] {
+        DoNotOptimize(pcm::DotProduct(in.data(), taps.data(), kFrame));
+    });
+    Run("Peak/reference", [&] {
+        DoNotOptimize(reference::Peak(in.data(), kFrame));
+    });
+    Run("Peak/pcm", [&] {
+        DoNotOptimize(pcm::Peak(in.data(), kFrame));
+    });
+    Run("Rms/reference", [&] {
+        DoNotOptimize(reference::Rms(in.data(), kFrame));
+    });
+    Run("Rms/pcm", [&] {
+        DoNotOptimize(pcm::Rms(in.data(), kFrame));
+    });
+    return 0;
+}
@@ -0,0 +1,106 @@
+#ifndef PCM_REFERENCE_H
+#define PCM_REFERENCE_H
+
+// The per-sample loops the pcm:: kernels replaced, written out the way the
+// codecs and the audio service had them. pcm_kernels_test checks the kernels
+// against them bit for bit and pcm_kernels_bench times both. They are kept out
+// of line like the kernels, so the bench cannot specialize them for its
+// constant arguments.
+
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+namespace reference {
+
+// NoAudioCodec::Write
+[[gnu::noipa]] inline void ScaleToInt32(const int16_t* data, int32_t* buffer, size_t samples, int32_t volume_factor) {
+    for (size_t i = 0; i < samples; i++) {
+        int64_t temp = int64_t(data[i]) * volume_factor;
+        if (temp > INT32_MAX) {
+            buffer[i] = INT32_MAX;
+        } else if (temp < INT32_MIN) {
+            buffer[i] = INT32_MIN;
+        } else {
+            buffer[i] = static_cast<int32_t>(temp);
+        }
+    }
+}
+
+// NoAudioCodec::Read
+[[gnu::noipa]] inline void ShiftToInt16(const int32_t* bit32_buffer, int16_t* dest, size_t samples, int shift) {
+    for (size_t i = 0; i < samples; i++) {
+        int32_t value = bit32_buffer[i] >> shift;
+        dest[i] = (value > INT16_MAX) ? INT16_MAX : (value < -INT16_MAX) ? -INT16_MAX : (int16_t)value;
+    }
+}
+
+// NoAudioCodecSimplexPdm::Read
+[[gnu::noipa]] inline void ApplyGain(int16_t* dest, size_t samples, int gain_factor) {
+    for (size_t i = 0; i < samples; i++) {
+        int32_t amplified = dest[i] * gain_factor;
+        dest[i] = (amplified > INT16_MAX) ? INT16_MAX : (amplified < -INT16_MAX) ? -INT16_MAX : (int16_t)amplified;
+    }
+}
+
+[[gnu::noipa]] inline void MixInto(int16_t* dst, const int16_t* src, size_t samples) {
+    for (size_t i = 0; i < samples; i++) {
+        int32_t sum = dst[i] + src[i];
+        dst[i] = (sum > INT16_MAX) ? INT16_MAX : (sum < -INT16_MAX) ? -INT16_MAX : (int16_t)sum;
+    }
+}
+
+[[gnu::noipa]] inline void FadeOut(int16_t* data, size_t samples) {
+    for (size_t i = 0; i < samples; i++) {
+        int64_t gain_numerator = int64_t(samples) - 1 - int64_t(i);
+        data[i] = int16_t(int64_t(data[i]) * gain_numerator / int64_t(samples));
+    }
+}
+
+// AudioService::ReadAudioData, stereo input
+[[gnu::noipa]] inline void Deinterleave(const int16_t* data, int16_t* mic, int16_t* reference, size_t frames) {
+    for (size_t i = 0, j = 0; i < frames; ++i, j += 2) {
+        mic[i] = data[j];
+        reference[i] = data[j + 1];
+    }
+}
+
+[[gnu::noipa]] inline void Interleave(const int16_t* mic, const int16_t* reference, int16_t* data, size_t frames) {
+    for (size_t i = 0, j = 0; i < frames; ++i, j += 2) {
+        data[j] = mic[i];
+        data[j + 1] = reference[i];
+    }
+}
+
+[[gnu::noipa]] inline int64_t DotProduct(const int16_t* a, const int16_t* b, size_t samples) {
+    int64_t sum = 0;
+    for (size_t i = 0; i < samples; i++) {
+        sum += int64_t(a[i]) * b[i];
+    }
+    return sum;
+}
+
+[[gnu::noipa]] inline uint16_t Peak(const int16_t* data, size_t samples) {
+    int peak = 0;
+    for (size_t i = 0; i < samples; i++) {
+        peak = std::max(peak, std::abs(int(data[i])));
+    }
+    return peak;
+}
+
+[[gnu::noipa]] inline uint16_t Rms(const int16_t* data, size_t samples) {
+    if (samples == 0) {
+        return 0;
+    }
+    double sum = 0;
+    for (size_t i = 0; i < samples; i++) {
+        sum += double(data[i]) * data[i];
+    }
+    return uint16_t(std::floor(std::sqrt(std::floor(sum / samples))));
+}
+
+} // namespace reference
+
+#endif // PCM_REFERENCE_H
@@ -0,0 +1,73 @@
+// PcmResampler cost and quality per rate pair: time per 60 ms frame, the
+// worst THD+N over passband tones and the worst alias rejection, both from
+// sine fits (sine_fit.h).
+//
+//   pcm_resampler_bench [--quick]
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#include "pcm_resampler.h"
+#include "sine_fit.h"
+
+using namespace sine_fit;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+std::vector<int16_t> Resample(int input_rate, int output_rate, const std::vector<int16_t>& input) {
+    PcmResampler resampler;
+    resampler.Configure(input_rate, output_rate);
+    std::vector<int16_t> output(resampler.GetOutputSamples(input.size()));
+    resampler.Process(input.data(), input.size(), output.data());
+    return output;
+}
+
+void Run(int input_rate, int output_rate, int frames) {
+    int lower = std::min(input_rate, output_rate);
+    double worst_snr = 1e9;
+    for (double frequency = 100; frequency <= 0.35 * lower; frequency *= 1.5) {
+        auto output = Resample(input_rate, output_rate, Sine(frequency, input_rate, input_rate));
+        worst_snr = std::min(worst_snr, FitSine(output, frequency, output_rate, 200).snr_db());
+    }
+    double worst_alias = -1e9;
+    for (double frequency = 0.55 * output_rate; frequency < 0.5 * input_rate; frequency += 250) {
+        auto output = Resample(input_rate, output_rate, Sine(frequency, input_rate, input_rate));
+        worst_alias = std::max(worst_alias, 20 * std::log10(Rms(output, 200) / (16000 / std::sqrt(2))));
+    }
+
+    PcmResampler resampler;
+    resampler.Configure(input_rate, output_rate);
+    auto frame = Sine(1000, input_rate, input_rate * 60 / 1000);
+    std::vector<int16_t> output(resampler.GetOutputSamples(frame.size()) + 1);
+    auto start = Clock::now();
+    for (int i = 0; i < frames; i++) {
+        resampler.Process(frame.data(), frame.size(), output.data());
+    }
+    double us = std::chrono::duration<double, std::micro>(Clock::now() - start).count() / frames;
+
+    char alias[16] = "-";
+    if (worst_alias > -1e9) {
+        std::snprintf(alias, sizeof(alias), "%.1f dB", worst_alias);
+    }
+    std::printf("%6d -> %-6d %8.2f us/frame  THD+N %5.1f dB  aliases %9s\n", input_rate, output_rate, us,
+        worst_snr, alias);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    int frames = argc > 1 && std::strcmp(argv[1], "--quick") == 0 ? 100 : 20000;
+    const int rates[][2] = {
+        {48000, 16000}, {44100, 16000}, {32000, 16000}, {24000, 16000}, {16000, 24000}, {16000, 48000},
+    };
+    for (auto& rate : rates) {
+        Run(rate[0], rate[1], frames);
+    }
+    return 0;
+}
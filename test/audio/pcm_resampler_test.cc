@@ -0,0 +1,177 @@
+// PcmResampler quality on the ratios the audio service uses, measured with a
+// sine fit (sine_fit.h), plus the streaming contract: chunked calls give the
+// same samples as one call.
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "host_test.h"
+#include "pcm_resampler.h"
+#include "sine_fit.h"
+
+using namespace sine_fit;
+
+namespace {
+
+// Input 48k / 44.1k / 24k mics, 24k server audio, 16k codecs
+const int kRates[][2] = {
+    {48000, 16000}, {44100, 16000}, {32000, 16000}, {24000, 16000}, {16000, 24000}, {16000, 48000},
+};
+
+// Filter start-up, in output samples
+constexpr size_t kSkip = 200;
+
+std::vector<int16_t> Resample(PcmResampler& resampler, const std::vector<int16_t>& input) {
+    std::vector<int16_t> output(resampler.GetOutputSamples(input.size()));
+    size_t produced = resampler.Process(input.data(), input.size(), output.data());
+    CHECK(produced == output.size());
+    return output;
+}
+
+std::vector<int16_t> Resample(int input_rate, int output_rate, const std::vector<int16_t>& input) {
+    PcmResampler resampler;
+    REQUIRE(resampler.Configure(input_rate, output_rate));
+    return Resample(resampler, input);
+}
+
+} // namespace
+
+TEST(PassbandIsFlatAndClean) {
+    for (auto& rate : kRates) {
+        int lower = std::min(rate[0], rate[1]);
+        // Up to 35% of the lower rate, 5.6 kHz for 16 kHz
+        for (double frequency : {100.0, 1000.0, 3000.0, 0.35 * lower}) {
+            auto output = Resample(rate[0], rate[1], Sine(frequency, rate[0], rate[0]));
+            auto fit = FitSine(output, frequency, rate[1], kSkip);
+            double gain_db = 20 * std::log10(fit.amplitude / 16000);
+            if (std::fabs(gain_db) > 0.05 || fit.snr_db() < 74) {
+                std::printf("  %d -> %d at %.0f Hz: gain %.3f dB, SNR %.1f dB\n", rate[0], rate[1], frequency,
+                    gain_db, fit.snr_db());
+            }
+            CHECK(std::fabs(gain_db) <= 0.05);
+            CHECK(fit.snr_db() >= 74);
+        }
+    }
+}
+
+TEST(StopbandStartsJustAboveNyquist) {
+    // -6 dB at 90% of the output Nyquist frequency, 65 dB down by 110% of it
+    for (auto& rate : kRates) {
+        if (rate[0] < rate[1]) {
+            continue;
+        }
+        auto at_nyquist = Resample(rate[0], rate[1], Sine(0.5 * rate[1], rate[0], rate[0]));
+        CHECK(20 * std::log10(Rms(at_nyquist, kSkip) / (16000 / std::sqrt(2))) < -20);
+        auto above = Resample(rate[0], rate[1], Sine(0.55 * rate[1], rate[0], rate[0]));
+        CHECK(20 * std::log10(Rms(above, kSkip) / (16000 / std::sqrt(2))) < -65);
+    }
+}
+
+TEST(RejectsAliases) {
+    for (auto& rate : kRates) {
+        if (rate[0] < rate[1]) {
+            continue;
+        }
+        // Tones the output cannot carry would fold back into the band
+        for (double fraction : {0.6, 0.75, 0.95}) {
+            double frequency = fraction * std::min(rate[0] / 2.0, 1.5 * rate[1]);
+            frequency = std::max(frequency, 0.6 * rate[1]);
+            auto output = Resample(rate[0], rate[1], Sine(frequency, rate[0], rate[0]));
+            double rejection_db = 20 * std::log10(Rms(output, kSkip) / (16000 / std::sqrt(2)));
+            if (rejection_db > -70) {
+                std::printf("  %d -> %d at %.0f Hz: %.1f dB\n", rate[0], rate[1], frequency, rejection_db);
+            }
+            CHECK(rejection_db <= -70);
+        }
+    }
+}
+
+TEST(ChunkedCallsMatchOneCall) {
+    std::mt19937 random(1);
+    for (auto& rate : kRates) {
+        auto input = Sine(997, rate[0], rate[0] / 2);
+        auto expected = Resample(rate[0], rate[1], input);
+
+        PcmResampler resampler;
+        REQUIRE(resampler.Configure(rate[0], rate[1]));
+        std::vector<int16_t> output;
+        for (size_t offset = 0; offset < input.size();) {
+            // Odd sizes, single samples and more than one internal chunk
+            size_t chunk = std::min<size_t>(input.size() - offset, random() % 3 == 0 ? 1 : random() % 700);
+            std::vector<int16_t> part(resampler.GetOutputSamples(chunk));
+            CHECK(resampler.Process(input.data() + offset, chunk, part.data()) == part.size());
+            output.insert(output.end(), part.begin(), part.end());
+            offset += chunk;
+        }
+        CHECK(output == expected);
+    }
+}
+
+TEST(OutputCountFollowsTheRatio) {
+    for (auto& rate : kRates) {
+        PcmResampler resampler;
+        REQUIRE(resampler.Configure(rate[0], rate[1]));
+        // Whole frames of every frame duration the service uses
+        for (int frame_ms : {10, 20, 60}) {
+            size_t input = rate[0] * frame_ms / 1000;
+            CHECK(resampler.GetOutputSamples(input) == size_t(rate[1] * frame_ms / 1000));
+        }
+        size_t total = 0;
+        std::vector<int16_t> input(7), output(64);
+        for (int i = 0; i < 1000; i++) {
+            total += resampler.Process(input.data(), input.size(), output.data());
+        }
+        // Odd calls carry the phase over, so the stream as a whole rounds up once
+        CHECK(total == size_t((7000 * int64_t(rate[1]) + rate[0] - 1) / rate[0]));
+    }
+}
+
+TEST(ResetRestartsTheStream) {
+    PcmResampler resampler;
+    REQUIRE(resampler.Configure(24000, 16000));
+    auto input = Sine(440, 24000, 1440);
+    auto first = Resample(resampler, input);
+    Resample(resampler, Sine(3000, 24000, 333));
+    resampler.Reset();
+    CHECK(Resample(resampler, input) == first);
+}
+
+TEST(ConfigureRejectsUnsupportedRatios) {
+    PcmResampler resampler;
+    CHECK(!resampler.configured());
+    CHECK(!resampler.Configure(0, 16000));
+    CHECK(!resampler.Configure(16000, -1));
+    // 16k to 44.1k needs 441 phases
+    CHECK(!resampler.Configure(16000, 44100));
+    CHECK(!resampler.configured());
+    int16_t sample = 1000;
+    CHECK(resampler.Process(&sample, 1, nullptr) == 0);
+    CHECK(resampler.Configure(16000, 16000));
+    CHECK(resampler.GetOutputSamples(160) == 160);
+}
+
+TEST(FullScaleDoesNotWrap) {
+    PcmResampler resampler;
+    REQUIRE(resampler.Configure(48000, 16000));
+    // A full-scale square wave overshoots at its edges, which must clamp
+    // rather than wrap around to the other sign
+    std::vector<int16_t> square(4800);
+    for (size_t i = 0; i < square.size(); i++) {
+        square[i] = (i / 60) % 2 ? -32767 : 32767;
+    }
+    auto output = Resample(resampler, square);
+    int16_t low = 0, high = 0;
+    int crossings = 0;
+    for (size_t i = kSkip; i < output.size(); i++) {
+        low = std::min(low, output[i]);
+        high = std::max(high, output[i]);
+        crossings += (output[i] < 0) != (output[i - 1] < 0);
+    }
+    CHECK(high == 32767);
+    CHECK(low == -32767);
+    // One per edge of the square wave, a wrap would add two
+    CHECK(crossings == int((output.size() - kSkip) / 20));
+}
@@ -0,0 +1,140 @@
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "host_test.h"
+#include "pre_roll_buffer.h"
+
+namespace {
+
+std::vector<int16_t> Ramp(int16_t first, size_t samples) {
+    std::vector<int16_t> ramp(samples);
+    for (size_t i = 0; i < samples; i++) {
+        ramp[i] = int16_t(first + i);
+    }
+    return ramp;
+}
+
+// Everything a reader gets, following Read() across the wrap
+std::vector<int16_t> ReadAll(const PreRollBuffer& buffer, size_t max_samples = 1000) {
+    std::vector<int16_t> out;
+    const int16_t* data;
+    while (size_t samples = buffer.Read(out.size(), max_samples, &data)) {
+        out.insert(out.end(), data, data + samples);
+    }
+    return out;
+}
+
+} // namespace
+
+TEST(KeepsTheLatestSamples) {
+    PreRollBuffer buffer(100);
+    auto first = Ramp(0, 70);
+    auto second = Ramp(70, 70);
+    buffer.Write(first.data(), first.size());
+    buffer.Write(second.data(), second.size());
+    CHECK(buffer.size() == 100);
+    buffer.Snapshot();
+    REQUIRE(buffer.BeginRead());
+    CHECK(ReadAll(buffer) == Ramp(40, 100));
+    CHECK(ReadAll(buffer, 7) == Ramp(40, 100));
+    buffer.EndRead();
+    CHECK(buffer.size() == 0);
+}
+
+TEST(OversizedWriteKeepsItsTail) {
+    PreRollBuffer buffer(50);
+    auto ramp = Ramp(0, 120);
+    buffer.Write(ramp.data(), ramp.size());
+    buffer.Snapshot();
+    REQUIRE(buffer.BeginRead());
+    CHECK(ReadAll(buffer) == Ramp(70, 50));
+}
+
+TEST(StridedWriteMatchesContiguous) {
+    PreRollBuffer buffer(64);
+    std::vector<int16_t> interleaved;
+    for (int16_t i = 0; i < 90; i++) {
+        interleaved.push_back(i);
+        interleaved.push_back(-1);
+    }
+    buffer.Write(PcmView::Channel(interleaved, 2, 0));
+    buffer.Snapshot();
+    REQUIRE(buffer.BeginRead());
+    CHECK(ReadAll(buffer) == Ramp(26, 64));
+}
+
+TEST(SnapshotFreezesTheAudio) {
+    PreRollBuffer buffer(10);
+    auto ramp = Ramp(0, 10);
+    buffer.Write(ramp.data(), ramp.size());
+    buffer.Snapshot();
+    auto later = Ramp(100, 5);
+    buffer.Write(later.data(), later.size());
+    REQUIRE(buffer.BeginRead());
+    CHECK(ReadAll(buffer) == ramp);
+    // Only one reader
+    CHECK(!buffer.BeginRead());
+    buffer.EndRead();
+    buffer.Write(later.data(), later.size());
+    CHECK(buffer.size() == 5);
+}
+
+TEST(ReadNeedsASnapshot) {
+    PreRollBuffer buffer(10);
+    CHECK(!buffer.BeginRead());
+    buffer.Snapshot();
+    buffer.Thaw();
+    CHECK(!buffer.BeginRead());
+    auto ramp = Ramp(0, 4);
+    buffer.Write(ramp.data(), ramp.size());
+    CHECK(buffer.size() == 4);
+}
+
+TEST(ThawDoesNotTakeAReadersSnapshot) {
+    PreRollBuffer buffer(10);
+    auto ramp = Ramp(0, 10);
+    buffer.Write(ramp.data(), ramp.size());
+    buffer.Snapshot();
+    REQUIRE(buffer.BeginRead());
+    buffer.Thaw();
+    buffer.Write(ramp.data(), 3);
+    CHECK(ReadAll(buffer) == ramp);
+}
+
+TEST(WriterAndReaderThreads) {
+    // The wake word thread writes and snapshots, the encoder reads; every
+    // snapshot read must be one contiguous run of the ramp
+    PreRollBuffer buffer(320);
+    std::atomic<bool> done{false};
+    std::atomic<int> reads{0};
+    bool ordered = true;
+    std::thread reader([&] {
+        while (!done) {
+            if (!buffer.BeginRead()) {
+                std::this_thread::yield();
+                continue;
+            }
+            auto audio = ReadAll(buffer);
+            for (size_t i = 1; i < audio.size(); i++) {
+                ordered &= int16_t(audio[i - 1] + 1) == audio[i];
+            }
+            buffer.EndRead();
+            reads++;
+        }
+    });
+    int16_t next = 0;
+    for (int i = 0; i < 20000; i++) {
+        auto frame = Ramp(next, 160);
+        next += 160;
+        buffer.Write(frame.data(), frame.size());
+        if (i % 50 == 49) {
+            buffer.Snapshot();
+            std::this_thread::yield();
+        }
+    }
+    done = true;
+    reader.join();
+    CHECK(ordered);
+    CHECK(reads > 0);
+}
@@ -0,0 +1,63 @@
+#ifndef SINE_FIT_H
+#define SINE_FIT_H
+
+// Sine test signals and a least-squares sine fit for the resampler tests: the
+// residual after removing the fitted tone is noise, distortion and aliases
+// together, so signal / residual is a THD+N figure.
+
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+namespace sine_fit {
+
+inline std::vector<int16_t> Sine(double frequency, int sample_rate, size_t samples, double amplitude = 16000) {
+    std::vector<int16_t> out(samples);
+    for (size_t i = 0; i < samples; i++) {
+        out[i] = int16_t(std::lround(amplitude * std::sin(2 * M_PI * frequency * i / sample_rate)));
+    }
+    return out;
+}
+
+struct Fit {
+    double amplitude;
+    double residual_rms;
+    double snr_db() const { return 20 * std::log10(amplitude / std::sqrt(2) / residual_rms); }
+};
+
+// Fits a * sin + b * cos at `frequency` to data[skip:], leaving out the filter start-up
+inline Fit FitSine(const std::vector<int16_t>& data, double frequency, int sample_rate, size_t skip) {
+    double ss = 0, cc = 0, sc = 0, ys = 0, yc = 0;
+    for (size_t i = skip; i < data.size(); i++) {
+        double s = std::sin(2 * M_PI * frequency * i / sample_rate);
+        double c = std::cos(2 * M_PI * frequency * i / sample_rate);
+        ss += s * s;
+        cc += c * c;
+        sc += s * c;
+        ys += data[i] * s;
+        yc += data[i] * c;
+    }
+    double det = ss * cc - sc * sc;
+    double a = (ys * cc - yc * sc) / det;
+    double b = (yc * ss - ys * sc) / det;
+    double residual = 0;
+    for (size_t i = skip; i < data.size(); i++) {
+        double s = std::sin(2 * M_PI * frequency * i / sample_rate);
+        double c = std::cos(2 * M_PI * frequency * i / sample_rate);
+        double e = data[i] - a * s - b * c;
+        residual += e * e;
+    }
+    return {std::hypot(a, b), std::sqrt(residual / (data.size() - skip)) + 1e-9};
+}
+
+inline double Rms(const std::vector<int16_t>& data, size_t skip) {
+    double sum = 0;
+    for (size_t i = skip; i < data.size(); i++) {
+        sum += double(data[i]) * data[i];
+    }
+    return std::sqrt(sum / (data.size() - skip));
+}
+
+} // namespace sine_fit
+
+#endif // SINE_FIT_H
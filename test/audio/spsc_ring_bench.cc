@@ -0,0 +1,124 @@
+// Hands timestamped frames from a producer thread to a consumer thread, once
+// through SpscRing with a semaphore as the task notification, once through the
+// mutex + condition variable + std::deque the audio queues used before.
+// Reports throughput and hand-off latency percentiles.
+//
+//   spsc_ring_bench [--quick]
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <semaphore>
+#include <thread>
+#include <vector>
+
+#include "spsc_ring.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct Frame {
+    Clock::time_point sent;
+    std::vector<uint8_t> payload;
+};
+
+constexpr size_t kQueueFrames = 40;
+
+class RingQueue {
+public:
+    void Push(std::unique_ptr<Frame>& frame) {
+        while (!ring_.Push(frame)) {
+            space_.acquire();
+        }
+        items_.release();
+    }
+    std::unique_ptr<Frame> Pop() {
+        std::unique_ptr<Frame> frame;
+        while (!ring_.Pop(frame)) {
+            items_.acquire();
+        }
+        space_.release();
+        return frame;
+    }
+
+private:
+    SpscRing<std::unique_ptr<Frame>, kQueueFrames> ring_;
+    std::counting_semaphore<> items_{0};
+    std::counting_semaphore<> space_{0};
+};
+
+class LockedQueue {
+public:
+    void Push(std::unique_ptr<Frame>& frame) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        cv_.wait(lock, [this] { return queue_.size() < kQueueFrames; });
+        queue_.push_back(std::move(frame));
+        cv_.notify_all();
+    }
+    std::unique_ptr<Frame> Pop() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        cv_.wait(lock, [this] { return !queue_.empty(); });
+        auto frame = std::move(queue_.front());
+        queue_.pop_front();
+        cv_.notify_all();
+        return frame;
+    }
+
+private:
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::deque<std::unique_ptr<Frame>> queue_;
+};
+
+template <typename Queue>
+void Run(const char* name, int frames, bool paced) {
+    Queue queue;
+    std::vector<double> latency_us;
+    latency_us.reserve(frames);
+    auto start = Clock::now();
+    std::thread producer([&] {
+        for (int i = 0; i < frames; i++) {
+            auto frame = std::make_unique<Frame>();
+            frame->payload.resize(60);
+            if (paced) {
+                // Frames arrive spaced out, so every hand-off wakes a sleeping consumer
+                std::this_thread::sleep_for(std::chrono::microseconds(200));
+            }
+            frame->sent = Clock::now();
+            queue.Push(frame);
+        }
+    });
+    for (int i = 0; i < frames; i++) {
+        auto frame = queue.Pop();
+        latency_us.push_back(std::chrono::duration<double, std::micro>(Clock::now() - frame->sent).count());
+    }
+    producer.join();
+    double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    std::sort(latency_us.begin(), latency_us.end());
+    auto percentile = [&](double p) { return latency_us[size_t(p * (latency_us.size() - 1))]; };
+    char rate[32] = "-";
+    if (!paced) {
+        std::snprintf(rate, sizeof(rate), "%.0f", frames / seconds);
+    }
+    std::printf("%-8s %-6s %10s frames/s  latency p50 %7.1f us  p99 %7.1f us  max %8.1f us\n",
+        name, paced ? "paced" : "burst", rate, percentile(0.5), percentile(0.99), latency_us.back());
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    bool quick = argc > 1 && std::strcmp(argv[1], "--quick") == 0;
+    int burst = quick ? 20000 : 1000000;
+    int paced = quick ? 200 : 5000;
+    Run<RingQueue>("spsc", burst, false);
+    Run<LockedQueue>("locked", burst, false);
+    Run<RingQueue>("spsc", paced, true);
+    Run<LockedQueue>("locked", paced, true);
+    return 0;
+}
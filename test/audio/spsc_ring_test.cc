@@ -0,0 +1,145 @@
+#include <memory>
+#include <thread>
+
+#include "host_test.h"
+#include "spsc_ring.h"
+
+TEST(KeepsFifoOrderAcrossWrap) {
+    SpscRing<int, 5> ring;  // Storage rounds up to 8
+    int next_in = 0;
+    int next_out = 0;
+    for (int round = 0; round < 20; round++) {
+        for (int i = 0; i < 3; i++) {
+            int item = next_in++;
+            CHECK(ring.Push(item));
+        }
+        for (int i = 0; i < 3; i++) {
+            int item = -1;
+            REQUIRE(ring.Pop(item));
+            CHECK(item == next_out++);
+        }
+    }
+    int item;
+    CHECK(!ring.Pop(item));
+    CHECK(ring.empty());
+}
+
+TEST(FullRingKeepsTheItem) {
+    SpscRing<std::unique_ptr<int>, 3> ring;
+    for (int i = 0; i < 3; i++) {
+        auto item = std::make_unique<int>(i);
+        CHECK(ring.Push(item));
+        CHECK(item == nullptr);
+    }
+    CHECK(ring.full());
+    auto rejected = std::make_unique<int>(3);
+    CHECK(!ring.Push(rejected));
+    REQUIRE(rejected != nullptr);
+    CHECK(*rejected == 3);
+    CHECK(ring.size() == 3);
+}
+
+TEST(LimitLowersCapacity) {
+    SpscRing<int, 10> ring;
+    ring.set_limit(4);
+    CHECK(ring.limit() == 4);
+    int pushed = 0;
+    for (int i = 0; i < 10; i++) {
+        int item = i;
+        pushed += ring.Push(item) ? 1 : 0;
+    }
+    CHECK(pushed == 4);
+    // Out of range limits mean the full capacity
+    ring.set_limit(0);
+    CHECK(ring.limit() == 10);
+    ring.set_limit(100);
+    CHECK(ring.limit() == 10);
+}
+
+TEST(ClearDropsOnlyEarlierItems) {
+    SpscRing<std::shared_ptr<int>, 8> ring;
+    auto tracked = std::make_shared<int>(0);
+    for (int i = 0; i < 4; i++) {
+        auto item = tracked;
+        ring.Push(item);
+    }
+    CHECK(tracked.use_count() == 5);
+    ring.Clear();
+    CHECK(ring.size() == 0);
+    // Discarded items keep their slots until the consumer runs
+    CHECK(!ring.full());
+
+    auto kept = std::make_shared<int>(7);
+    ring.Push(kept);
+    CHECK(ring.size() == 1);
+    std::shared_ptr<int> item;
+    REQUIRE(ring.Pop(item));
+    CHECK(*item == 7);
+    CHECK(tracked.use_count() == 1);
+    CHECK(!ring.Pop(item));
+}
+
+TEST(HandsOverEveryItemBetweenThreads) {
+    constexpr int kItems = 100000;
+    SpscRing<std::unique_ptr<int>, 16> ring;
+    std::thread producer([&] {
+        for (int i = 0; i < kItems; i++) {
+            auto item = std::make_unique<int>(i);
+            while (!ring.Push(item)) {
+                std::this_thread::yield();
+            }
+        }
+    });
+    int expected = 0;
+    bool in_order = true;
+    while (expected < kItems) {
+        std::unique_ptr<int> item;
+        if (!ring.Pop(item)) {
+            std::this_thread::yield();
+            continue;
+        }
+        in_order &= *item == expected;
+        expected++;
+    }
+    producer.join();
+    CHECK(in_order);
+    CHECK(ring.empty());
+}
+
+TEST(ClearFromAThirdThread) {
+    // The consumer must only ever see items in order, with gaps where a Clear() hit
+    constexpr int kItems = 100000;
+    SpscRing<int, 32> ring;
+    std::atomic<bool> done{false};
+    std::thread producer([&] {
+        for (int i = 0; i < kItems; i++) {
+            int item = i;
+            while (!ring.Push(item)) {
+                std::this_thread::yield();
+            }
+        }
+        done = true;
+    });
+    std::thread clearer([&] {
+        while (!done) {
+            ring.Clear();
+            std::this_thread::yield();
+        }
+    });
+    int last = -1;
+    bool increasing = true;
+    while (!done || !ring.empty()) {
+        int item;
+        if (!ring.Pop(item)) {
+            std::this_thread::yield();
+            continue;
+        }
+        increasing &= item > last;
+        last = item;
+    }
+    producer.join();
+    clearer.join();
+    CHECK(increasing);
+    int item;
+    CHECK(!ring.Pop(item));
+}
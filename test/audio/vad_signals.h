@@ -0,0 +1,93 @@
+#ifndef VAD_SIGNALS_H
+#define VAD_SIGNALS_H
+
+// Labelled 16 kHz test signals for the VAD: voiced bursts built from a
+// harmonic series with a syllable envelope, over background noise of a given
+// level. Deterministic for a given seed, shared by energy_vad_test and
+// energy_vad_bench.
+
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+namespace vad_signals {
+
+constexpr int kSampleRate = 16000;
+
+enum Kind {
+    kQuiet,  // Room noise only
+    kVoice,  // Harmonic voice over the background
+    kHiss,   // Loud broadband noise, a fan or a hair dryer
+    kHum,    // Steady low tone, mains hum or a motor
+};
+
+struct Segment {
+    Kind kind;
+    int ms;
+};
+
+struct Signal {
+    std::vector<int16_t> samples;
+    std::vector<bool> speech;  // Label per sample
+};
+
+class Generator {
+public:
+    explicit Generator(uint32_t seed = 1, double noise_rms = 30, double voice_rms = 2500)
+        : random_(seed), noise_rms_(noise_rms), voice_rms_(voice_rms) {}
+
+    Signal Make(const std::vector<Segment>& segments) {
+        Signal signal;
+        for (auto& segment : segments) {
+            Append(signal, segment);
+        }
+        return signal;
+    }
+
+private:
+    void Append(Signal& signal, const Segment& segment) {
+        std::normal_distribution<double> noise(0, noise_rms_);
+        std::normal_distribution<double> hiss(0, 2000);
+        std::uniform_real_distribution<double> pitch(110, 220);
+        int samples = segment.ms * kSampleRate / 1000;
+        double f0 = pitch(random_);
+        for (int i = 0; i < samples; i++) {
+            double t = double(i) / kSampleRate;
+            double value = noise(random_);
+            switch (segment.kind) {
+            case kVoice: {
+                // Five harmonics falling off by 1/k, a 4 Hz syllable envelope and a slow pitch drift
+                double envelope = 0.6 + 0.4 * std::sin(2 * M_PI * 4 * t);
+                double f = f0 * (1 + 0.05 * std::sin(2 * M_PI * 1.5 * t));
+                phase_ += 2 * M_PI * f / kSampleRate;
+                double voice = 0;
+                for (int k = 1; k <= 5; k++) {
+                    voice += std::sin(k * phase_) / k;
+                }
+                value += voice_rms_ * envelope * voice / 0.9;
+                break;
+            }
+            case kHiss:
+                value += hiss(random_);
+                break;
+            case kHum:
+                value += 2000 * std::sin(2 * M_PI * 100 * t);
+                break;
+            case kQuiet:
+                break;
+            }
+            signal.samples.push_back(int16_t(std::lround(std::fmax(-32767, std::fmin(32767, value)))));
+            signal.speech.push_back(segment.kind == kVoice);
+        }
+    }
+
+    std::mt19937 random_;
+    double noise_rms_;
+    double voice_rms_;
+    double phase_ = 0;
+};
+
+} // namespace vad_signals
+
+#endif // VAD_SIGNALS_H
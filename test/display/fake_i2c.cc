@@ -0,0 +1,130 @@
+#include "fake_i2c.h"
+
+#include <cstring>
+
+#include <driver/i2c_master.h>
+
+#include "host_runtime.h"
+
+struct i2c_master_bus_t {};
+struct i2c_master_dev_t {};
+
+namespace {
+
+i2c_master_bus_t bus;
+i2c_master_dev_t device;
+fake_i2c_stats_t stats;
+uint32_t device_clock_hz = 100000;
+uint32_t override_clock_hz = 0;
+
+struct St7032 {
+    uint8_t ddram[0x80];
+    uint8_t cgram[64];
+    uint8_t address = 0;
+    bool cgram_selected = false;
+    bool extended = false;  // IS=1
+
+    St7032() { std::memset(ddram, ' ', sizeof(ddram)); std::memset(cgram, 0, sizeof(cgram)); }
+
+    void Command(uint8_t command) {
+        if (command & 0x80) {
+            address = command & 0x7F;
+            cgram_selected = false;
+        } else if ((command & 0xE0) == 0x20) {
+            extended = command & 0x01;
+        } else if (extended && (command & 0xC0) == 0x40) {
+            // Icon address, power/icon/contrast, follower: panel settings only
+        } else if (command & 0x40) {
+            address = command & 0x3F;
+            cgram_selected = true;
+        } else if (command == 0x01) {
+            std::memset(ddram, ' ', sizeof(ddram));
+            address = 0;
+            cgram_selected = false;
+        } else if (command == 0x02 || command == 0x03) {
+            address = 0;
+            cgram_selected = false;
+        }
+    }
+
+    void Data(uint8_t value) {
+        if (cgram_selected) {
+            cgram[address & 0x3F] = value;
+            address = (address + 1) & 0x3F;
+        } else {
+            ddram[address & 0x7F] = value;
+            address = (address + 1) & 0x7F;
+        }
+    }
+} panel;
+
+char row_text[2][17];
+
+} // namespace
+
+extern "C" {
+
+esp_err_t i2c_new_master_bus(const i2c_master_bus_config_t* config, i2c_master_bus_handle_t* handle) {
+    *handle = &bus;
+    return ESP_OK;
+}
+
+esp_err_t i2c_master_bus_add_device(i2c_master_bus_handle_t bus_handle, const i2c_device_config_t* config,
+                                    i2c_master_dev_handle_t* handle) {
+    if (config->scl_speed_hz != 0) {
+        device_clock_hz = config->scl_speed_hz;
+    }
+    *handle = &device;
+    return ESP_OK;
+}
+
+esp_err_t i2c_master_transmit(i2c_master_dev_handle_t handle, const uint8_t* data, size_t size, int timeout_ms) {
+    // START, address and payload bytes with their ACK, STOP
+    uint32_t clock_hz = override_clock_hz != 0 ? override_clock_hz : device_clock_hz;
+    int64_t bus_time_us = int64_t((size + 1) * 9 + 2) * 1000000 / clock_hz;
+    stats.transactions++;
+    stats.bytes += size;
+    stats.bus_time_us += bus_time_us;
+    host_clock_advance_us(bus_time_us);
+
+    // Co=1: one byte follows, then another control byte; Co=0: the rest is one stream
+    size_t i = 0;
+    while (i + 1 < size) {
+        uint8_t control = data[i++];
+        bool more = control & 0x80;
+        bool rs = control & 0x40;
+        size_t end = more ? i + 1 : size;
+        for (; i < end; i++) {
+            if (rs) {
+                panel.Data(data[i]);
+            } else {
+                panel.Command(data[i]);
+            }
+        }
+    }
+    return ESP_OK;
+}
+
+void fake_i2c_set_clock_hz(uint32_t hz) {
+    override_clock_hz = hz;
+}
+
+void fake_i2c_reset_stats(void) {
+    stats = {};
+}
+
+fake_i2c_stats_t fake_i2c_get_stats(void) {
+    return stats;
+}
+
+const char* fake_st7032_row(int row) {
+    std::memcpy(row_text[row], panel.ddram + row * 0x40, 16);
+    row_text[row][16] = '\0';
+    return row_text[row];
+}
+
+const uint8_t* fake_st7032_glyph(int slot) {
+    return panel.cgram + (slot & 0x07) * 8;
+}
+
+}
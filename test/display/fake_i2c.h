@@ -0,0 +1,41 @@
+#ifndef FAKE_I2C_H
+#define FAKE_I2C_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * The i2c_master driver for the host, with an ST7032 on the other end.
+ *
+ * Every transmit is counted, advances the simulated clock by its time on the
+ * bus and is decoded like the controller would (control bytes,
+ * Set DDRAM / CGRAM Address, Clear Display, the IS=1 table ignored), so
+ * tests can check both what went on the wire and what the panel shows. The
+ * SCL clock is the one the driver configures unless a test overrides it.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+    uint32_t transactions;
+    uint32_t bytes;        // Address byte not included, as in lcd_bus_stats_t
+    uint32_t bus_time_us;  // At the clock in effect for each transaction
+} fake_i2c_stats_t;
+
+// 0 goes back to the clock in the device config
+void fake_i2c_set_clock_hz(uint32_t hz);
+void fake_i2c_reset_stats(void);
+fake_i2c_stats_t fake_i2c_get_stats(void);
+
+// The 16 visible cells of a row, NUL terminated
+const char* fake_st7032_row(int row);
+// Pattern rows of a CGRAM slot
+const uint8_t* fake_st7032_glyph(int slot);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // FAKE_I2C_H
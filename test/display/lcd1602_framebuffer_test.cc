@@ -0,0 +1,199 @@
+#include <cstring>
+#include <string>
+#include <thread>
+
+#include "fake_i2c.h"
+#include "grove_lcd_162.h"
+#include "host_runtime.h"
+#include "host_test.h"
+#include "lcd1602_framebuffer.h"
+
+namespace {
+
+struct Frame {
+    char rows[LCD_FB_ROWS][LCD_FB_COLS];
+
+    Frame(const char* line1, const char* line2) {
+        lcd_fb_fill_row(rows[0], line1);
+        lcd_fb_fill_row(rows[1], line2);
+    }
+};
+
+size_t Diff(const lcd_fb_t& fb, const Frame& next, lcd_fb_run_t* runs) {
+    return lcd_fb_diff(&fb, next.rows, runs, LCD_FB_MAX_RUNS);
+}
+
+// A blank panel with the driver's bus counters cleared
+void StartPanel() {
+    host_log_set_level('W');
+    lcd_init();
+    lcd_clear();
+    fake_i2c_reset_stats();
+    lcd_reset_bus_stats();
+}
+
+} // namespace
+
+TEST(FillRowPadsAndTruncates) {
+    char row[LCD_FB_COLS];
+    lcd_fb_fill_row(row, "Hi");
+    CHECK(std::string(row, LCD_FB_COLS) == "Hi              ");
+    lcd_fb_fill_row(row, "0123456789abcdefXYZ");
+    CHECK(std::string(row, LCD_FB_COLS) == "0123456789abcdef");
+    lcd_fb_fill_row(row, nullptr);
+    CHECK(std::string(row, LCD_FB_COLS) == std::string(LCD_FB_COLS, ' '));
+}
+
+TEST(UnchangedFrameSendsNothing) {
+    lcd_fb_t fb;
+    lcd_fb_reset(&fb);
+    lcd_fb_run_t runs[LCD_FB_MAX_RUNS];
+    CHECK(Diff(fb, Frame("", ""), runs) == 0);
+
+    Frame frame("Listening...", "U:hello");
+    lcd_fb_commit(&fb, frame.rows);
+    CHECK(Diff(fb, frame, runs) == 0);
+}
+
+TEST(InvalidFrameRepaintsWholeRows) {
+    lcd_fb_t fb;
+    lcd_fb_reset(&fb);
+    Frame frame("Listening...", "");
+    lcd_fb_commit(&fb, frame.rows);
+    lcd_fb_invalidate(&fb);
+
+    lcd_fb_run_t runs[LCD_FB_MAX_RUNS];
+    REQUIRE(Diff(fb, frame, runs) == 2);
+    for (int r = 0; r < LCD_FB_ROWS; r++) {
+        CHECK(runs[r].row == r);
+        CHECK(runs[r].col == 0);
+        CHECK(runs[r].len == LCD_FB_COLS);
+    }
+}
+
+TEST(ChangedWordIsOneRun) {
+    lcd_fb_t fb;
+    lcd_fb_reset(&fb);
+    Frame before("Listening...", "");
+    lcd_fb_commit(&fb, before.rows);
+
+    // "Listening..." -> "Speaking..." differs from column 0 through the old tail
+    lcd_fb_run_t runs[LCD_FB_MAX_RUNS];
+    REQUIRE(Diff(fb, Frame("Speaking...", ""), runs) == 1);
+    CHECK(runs[0].row == 0);
+    CHECK(runs[0].col == 0);
+    CHECK(runs[0].len == 12);
+}
+
+TEST(ShortGapsMergeLongGapsSplit) {
+    lcd_fb_t fb;
+    lcd_fb_reset(&fb);
+    lcd_fb_run_t runs[LCD_FB_MAX_RUNS];
+
+    // Dirty cells at 0 and LCD_FB_MERGE_GAP: the clean gap is one cell short of the limit
+    std::string merged(LCD_FB_COLS, ' ');
+    merged[0] = merged[LCD_FB_MERGE_GAP] = 'x';
+    REQUIRE(Diff(fb, Frame(merged.c_str(), ""), runs) == 1);
+    CHECK(runs[0].col == 0);
+    CHECK(runs[0].len == LCD_FB_MERGE_GAP + 1);
+
+    // One more clean cell and the second change gets its own transaction
+    std::string split(LCD_FB_COLS, ' ');
+    split[0] = split[LCD_FB_MERGE_GAP + 1] = 'x';
+    REQUIRE(Diff(fb, Frame(split.c_str(), ""), runs) == 2);
+    CHECK(runs[0].col == 0);
+    CHECK(runs[0].len == 1);
+    CHECK(runs[1].col == LCD_FB_MERGE_GAP + 1);
+    CHECK(runs[1].len == 1);
+}
+
+TEST(WorstCaseFitsMaxRuns) {
+    lcd_fb_t fb;
+    lcd_fb_reset(&fb);
+    std::string sparse(LCD_FB_COLS, ' ');
+    for (int c = 0; c < LCD_FB_COLS; c += LCD_FB_MERGE_GAP + 1) {
+        sparse[c] = 'x';
+    }
+    lcd_fb_run_t runs[LCD_FB_MAX_RUNS + 1];
+    std::memset(runs, 0xA5, sizeof(runs));
+    CHECK(lcd_fb_diff(&fb, Frame(sparse.c_str(), sparse.c_str()).rows, runs, LCD_FB_MAX_RUNS) == LCD_FB_MAX_RUNS);
+    CHECK(runs[LCD_FB_MAX_RUNS].row == 0xA5);
+
+    // A smaller array is never overrun
+    CHECK(lcd_fb_diff(&fb, Frame(sparse.c_str(), sparse.c_str()).rows, runs, 2) == 2);
+}
+
+TEST(DriverSendsOnlyChangedRuns) {
+    StartPanel();
+    lcd_show_lines("Listening...", "");
+    CHECK(std::string(fake_st7032_row(0)) == "Listening...    ");
+    CHECK(std::string(fake_st7032_row(1)) == std::string(LCD_FB_COLS, ' '));
+    fake_i2c_stats_t first = fake_i2c_get_stats();
+    CHECK(first.transactions == 1);
+    // Control byte, Set DDRAM Address, data control byte, 12 cells
+    CHECK(first.bytes == 3 + 12);
+
+    fake_i2c_reset_stats();
+    lcd_show_lines("Listening...", "");
+    CHECK(fake_i2c_get_stats().transactions == 0);
+
+    fake_i2c_reset_stats();
+    lcd_show_lines("Speaking...", "A:xin chao");
+    CHECK(std::string(fake_st7032_row(0)) == "Speaking...     ");
+    CHECK(std::string(fake_st7032_row(1)) == "A:xin chao      ");
+    CHECK(fake_i2c_get_stats().transactions == 2);
+
+    // The driver's own counters agree with what the bus saw
+    lcd_bus_stats_t stats;
+    lcd_get_bus_stats(&stats);
+    CHECK(stats.transactions == 1 + 2);
+    CHECK(stats.bytes == first.bytes + fake_i2c_get_stats().bytes);
+}
+
+TEST(RawWriteForcesFullRepaint) {
+    StartPanel();
+    lcd_show_lines("Listening...", "");
+    lcd_write_at(0, 1, "raw", 3);
+    CHECK(std::string(fake_st7032_row(1)).substr(0, 3) == "raw");
+
+    fake_i2c_reset_stats();
+    lcd_show_lines("Listening...", "");
+    // The shadow no longer knows the panel, so both rows go out in full
+    CHECK(fake_i2c_get_stats().transactions == 2);
+    CHECK(fake_i2c_get_stats().bytes == 2 * (3 + LCD_FB_COLS));
+    CHECK(std::string(fake_st7032_row(1)) == std::string(LCD_FB_COLS, ' '));
+}
+
+TEST(GlyphUploadIsOneTransaction) {
+    StartPanel();
+    const uint8_t rows[8] = {0x02, 0x04, 0x0E, 0x01, 0x0F, 0x11, 0x0F, 0x00};
+    lcd_upload_glyph(3, rows);
+    CHECK(fake_i2c_get_stats().transactions == 1);
+    CHECK(std::memcmp(fake_st7032_glyph(3), rows, 8) == 0);
+
+    // DDRAM is addressed again by the next line update
+    lcd_show_lines("\x0B", "");
+    CHECK(fake_st7032_row(0)[0] == 0x0B);
+}
+
+TEST(CursorAndContrastTakeTheBusLock) {
+    StartPanel();
+    const int rounds = 50;
+    std::thread contrast([&] {
+        for (int i = 0; i < rounds; i++) {
+            lcd_set_contrast(0x70 + i % 5);
+        }
+    });
+    for (int i = 0; i < rounds; i++) {
+        lcd_set_cursor(i % LCD_FB_COLS, i & 1);
+        std::this_thread::yield();
+    }
+    contrast.join();
+
+    // Five commands per contrast change, one per cursor move, none lost
+    lcd_bus_stats_t stats;
+    lcd_get_bus_stats(&stats);
+    CHECK(stats.transactions == 6 * rounds);
+    CHECK(stats.transactions == fake_i2c_get_stats().transactions);
+    CHECK(stats.bytes == fake_i2c_get_stats().bytes);
+}
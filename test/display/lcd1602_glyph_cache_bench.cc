@@ -0,0 +1,172 @@
+// Replays a Vietnamese chat corpus through Lcd1602GlyphCache and the LCD1602
+// driver on the fake bus. Reports the CGRAM hit rate and what each message
+// costs on the wire, against showing every accented letter as its base letter.
+//
+//   lcd1602_glyph_cache_bench [--quick] [corpus.txt]
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "fake_i2c.h"
+#include "grove_lcd_162.h"
+#include "host_runtime.h"
+#include "lcd1602_glyph_cache.h"
+#include "lcd1602_vietnamese.h"
+
+namespace {
+
+using Frame = std::pair<std::string, std::string>;
+
+// Word wrap into rows of LCD1602_COLS cells, the way the chat view scrolls them
+std::vector<std::string> Wrap(const std::string& text) {
+    std::vector<std::string> rows;
+    std::string row;
+    int row_cells = 0;
+    size_t i = 0;
+    while (i < text.size()) {
+        size_t end = text.find(' ', i);
+        if (end == std::string::npos) end = text.size();
+        std::string word = text.substr(i, end - i);
+        int cells = 0;
+        for (size_t p = 0; p < word.size();) {
+            p += std::max<size_t>(1, vn::DecodeUtf8(word.c_str() + p, word.size() - p).length);
+            cells++;
+        }
+        if (row_cells > 0 && row_cells + 1 + cells > LCD1602_COLS) {
+            rows.push_back(row);
+            row.clear();
+            row_cells = 0;
+        }
+        if (row_cells > 0) {
+            row += ' ';
+            row_cells++;
+        }
+        row += word;
+        row_cells += cells;
+        i = end + 1;
+    }
+    if (!row.empty()) rows.push_back(row);
+    return rows;
+}
+
+// Every frame a message shows while it scrolls one row at a time
+std::vector<std::vector<Frame>> LoadMessages(const char* path) {
+    std::vector<std::vector<Frame>> messages;
+    std::ifstream in(path);
+    std::string line;
+    while (std::getline(in, line)) {
+        size_t tab = line.find('\t');
+        if (line.empty() || line[0] == '#' || tab == std::string::npos) continue;
+        auto rows = Wrap(line.substr(tab + 1));
+        std::vector<Frame> frames;
+        for (size_t top = 0; top == 0 || top + 1 < rows.size(); top++) {
+            frames.push_back({rows[top], top + 1 < rows.size() ? rows[top + 1] : ""});
+        }
+        messages.push_back(frames);
+    }
+    return messages;
+}
+
+struct BusCost {
+    uint32_t transactions = 0;
+    uint32_t bytes = 0;
+    uint32_t bus_time_us = 0;
+};
+
+BusCost Replay(const std::vector<std::vector<Frame>>& messages, bool use_cgram, Lcd1602GlyphStats* stats) {
+    lcd_clear();
+    lcd_reset_bus_stats();
+    Lcd1602GlyphCache cache([](uint8_t slot, const uint8_t rows[8]) { lcd_upload_glyph(slot, rows); });
+    for (const auto& frames : messages) {
+        for (const auto& frame : frames) {
+            char cells[LCD1602_ROWS][LCD1602_COLS + 1];
+            if (use_cgram) {
+                cache.Render(frame.first.c_str(), frame.second.c_str(), cells);
+            } else {
+                const std::string* lines[] = {&frame.first, &frame.second};
+                for (int r = 0; r < LCD1602_ROWS; r++) {
+                    const char* p = lines[r]->c_str();
+                    size_t remaining = lines[r]->size();
+                    for (int c = 0; c < LCD1602_COLS; c++) {
+                        auto ch = vn::DecodeUtf8(p, remaining);
+                        p += ch.length;
+                        remaining -= ch.length;
+                        cells[r][c] = ch.length ? vn::ToAscii(ch.codepoint) : ' ';
+                    }
+                    cells[r][LCD1602_COLS] = '\0';
+                }
+            }
+            lcd_show_lines(cells[0], cells[1]);
+        }
+    }
+    if (stats != nullptr) {
+        *stats = cache.stats();
+    }
+    lcd_bus_stats_t bus;
+    lcd_get_bus_stats(&bus);
+    return {bus.transactions, bus.bytes, bus.bus_time_us};
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    bool quick = false;
+    const char* corpus = HOST_TEST_DATA_DIR "/vi_chat_corpus.txt";
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--quick") == 0) {
+            quick = true;
+        } else {
+            corpus = argv[i];
+        }
+    }
+
+    auto messages = LoadMessages(corpus);
+    if (messages.empty()) {
+        std::fprintf(stderr, "No messages in %s\n", corpus);
+        return 1;
+    }
+    size_t frame_count = 0;
+    for (const auto& frames : messages) {
+        frame_count += frames.size();
+    }
+
+    host_log_set_level('W');
+    lcd_init();
+
+    Lcd1602GlyphStats stats;
+    BusCost cgram = Replay(messages, true, &stats);
+    BusCost ascii = Replay(messages, false, nullptr);
+    uint32_t lookups = stats.hits + stats.uploads;
+
+    std::printf("corpus: %zu messages, %zu frames\n", messages.size(), frame_count);
+    std::printf("glyph cache: %u hits, %u uploads, %u fallbacks, hit rate %.1f%%\n",
+        stats.hits, stats.uploads, stats.fallbacks, lookups ? 100.0 * stats.hits / lookups : 0.0);
+    std::printf("%-12s %14s %14s %14s\n", "per message", "transactions", "bytes", "bus ms");
+    BusCost rows[] = {cgram, ascii};
+    const char* names[] = {"cgram", "base letters"};
+    for (int i = 0; i < 2; i++) {
+        std::printf("%-12s %14.1f %14.1f %14.2f\n", names[i],
+            double(rows[i].transactions) / messages.size(), double(rows[i].bytes) / messages.size(),
+            rows[i].bus_time_us / 1000.0 / messages.size());
+    }
+
+    // CPU cost of Render alone, the bus is not involved
+    int repeats = quick ? 1 : 200;
+    Lcd1602GlyphCache cache([](uint8_t, const uint8_t*) {});
+    char cells[LCD1602_ROWS][LCD1602_COLS + 1];
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < repeats; i++) {
+        for (const auto& frames : messages) {
+            for (const auto& frame : frames) {
+                cache.Render(frame.first.c_str(), frame.second.c_str(), cells);
+            }
+        }
+    }
+    double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    std::printf("render: %.0f ns per frame on this host\n", ns / (double(repeats) * frame_count));
+    return 0;
+}
@@ -0,0 +1,184 @@
+#include <cstring>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "fake_i2c.h"
+#include "grove_lcd_162.h"
+#include "host_runtime.h"
+#include "host_test.h"
+#include "lcd1602_glyph_cache.h"
+#include "lcd1602_vietnamese.h"
+
+namespace {
+
+struct Upload {
+    uint8_t slot;
+    vn::Glyph rows;
+};
+
+struct Renderer {
+    std::vector<Upload> uploads;
+    Lcd1602GlyphCache cache{[this](uint8_t slot, const uint8_t rows[8]) {
+        Upload upload{slot, {}};
+        std::memcpy(upload.rows.data(), rows, 8);
+        uploads.push_back(upload);
+    }};
+    char out[LCD1602_ROWS][LCD1602_COLS + 1];
+
+    void Render(const char* line1, const char* line2 = "") { cache.Render(line1, line2, out); }
+};
+
+char32_t Decode(const char* text) {
+    return vn::DecodeUtf8(text, std::strlen(text)).codepoint;
+}
+
+bool IsCgram(char code) {
+    return code >= LCD1602_CGRAM_CODE_BASE && code < LCD1602_CGRAM_CODE_BASE + LCD1602_CGRAM_SLOTS;
+}
+
+} // namespace
+
+TEST(DecodesUtf8) {
+    CHECK(vn::DecodeUtf8("A", 1).codepoint == U'A');
+    CHECK(vn::DecodeUtf8("A", 1).length == 1);
+    CHECK(vn::DecodeUtf8("\xC3\xA0", 2).codepoint == 0x00E0);   // à
+    CHECK(vn::DecodeUtf8("\xE1\xBB\xAF", 3).codepoint == 0x1EEF);  // ữ
+    CHECK(vn::DecodeUtf8("\xE1\xBB\xAF", 3).length == 3);
+    CHECK(vn::DecodeUtf8("\xF0\x9F\x98\x80", 4).codepoint == 0x1F600);
+    CHECK(vn::DecodeUtf8("", 0).length == 0);
+    CHECK(vn::DecodeUtf8("x", 0).length == 0);
+}
+
+TEST(MalformedUtf8ConsumesOneByte) {
+    // Stray continuation byte, bad continuation, truncated sequence, invalid lead byte
+    const char* inputs[] = {"\x80" "a", "\xE1" "a" "b", "\xE1\xBB", "\xFF" "a"};
+    for (const char* input : inputs) {
+        auto ch = vn::DecodeUtf8(input, std::strlen(input));
+        CHECK(ch.codepoint == vn::kReplacementChar);
+        CHECK(ch.length == 1);
+    }
+}
+
+TEST(EveryLetterHasBaseAndGlyph) {
+    std::set<vn::Glyph> lowercase;
+    for (const auto& letter : vn::kLetters) {
+        CHECK(vn::FindLetter(letter.codepoint) == &letter);
+        char base = vn::ToAscii(letter.codepoint);
+        CHECK(std::strchr("aeiouydAEIOUYD", base) != nullptr);
+        auto glyph = vn::ComposeGlyph(letter);
+        for (uint8_t row : glyph) {
+            CHECK(row < 0x20);
+        }
+        if (base >= 'a') {
+            lowercase.insert(glyph);
+        }
+    }
+    // Small caps share shapes with the lowercase letters, but no two lowercase letters look alike
+    CHECK(lowercase.size() == vn::kLetterCount / 2);
+    CHECK(vn::FindLetter(U'a') == nullptr);
+    CHECK(vn::FindLetter(0x00C4) == nullptr);  // Ä is not Vietnamese
+}
+
+TEST(AccentedLettersGetCgramCodes) {
+    Renderer renderer;
+    renderer.Render("Xin chào bạn!", "Đang nghe...");
+    CHECK(std::string(renderer.out[0]).substr(0, 6) == "Xin ch");
+    CHECK(IsCgram(renderer.out[0][6]));   // à
+    CHECK(renderer.out[0][7] == 'o');
+    CHECK(IsCgram(renderer.out[0][10]));  // ạ
+    CHECK(renderer.out[0][12] == '!');
+    CHECK(std::strlen(renderer.out[0]) == LCD1602_COLS);
+    CHECK(IsCgram(renderer.out[1][0]));   // Đ
+    CHECK(renderer.uploads.size() == 3);
+
+    // The glyph uploaded into a cell's slot is the letter's composed glyph
+    int slot = renderer.out[0][6] - LCD1602_CGRAM_CODE_BASE;
+    bool found = false;
+    for (const auto& upload : renderer.uploads) {
+        if (upload.slot == slot) {
+            found = true;
+            CHECK(upload.rows == vn::ComposeGlyph(*vn::FindLetter(Decode("à"))));
+        }
+    }
+    CHECK(found);
+}
+
+TEST(MultiByteLettersAreOneCell) {
+    Renderer renderer;
+    // 20 accented letters, only 16 fit
+    renderer.Render("ệệệệệệệệệệệệệệệệệệệệ");
+    for (int c = 0; c < LCD1602_COLS; c++) {
+        CHECK(renderer.out[0][c] == renderer.out[0][0]);
+    }
+    CHECK(renderer.uploads.size() == 1);
+    CHECK(std::string(renderer.out[1]) == std::string(LCD1602_COLS, ' '));
+}
+
+TEST(ResidentLettersAreNotUploadedAgain) {
+    Renderer renderer;
+    renderer.Render("Tôi là trợ lý");
+    size_t first = renderer.uploads.size();
+    CHECK(first == 4);
+    renderer.Render("là trợ lý ảo");
+    CHECK(renderer.uploads.size() == first + 1);  // only ả is new
+    CHECK(renderer.cache.stats().hits == 3);
+    CHECK(renderer.cache.stats().fallbacks == 0);
+}
+
+TEST(MostFrequentLettersWinTheSlots) {
+    Renderer renderer;
+    // Nine distinct accented letters, ư appears three times and must get a slot
+    renderer.Render("ưưư áàảãạ", "ắằẳ");
+    CHECK(renderer.uploads.size() == LCD1602_CGRAM_SLOTS);
+    CHECK(renderer.cache.stats().fallbacks == 1);
+    CHECK(IsCgram(renderer.out[0][0]));
+    // The last letter seen among the single occurrences falls back to its base letter
+    CHECK(renderer.out[1][2] == 'a');
+}
+
+TEST(EvictsLeastRecentlyUsed) {
+    Renderer renderer;
+    renderer.Render("áàảãạắằẳ");  // fills all 8 slots
+    renderer.Render("á");
+    renderer.Render("à");
+    renderer.uploads.clear();
+
+    // ả was used longer ago than á and à, so a new letter takes its slot over theirs
+    renderer.Render("ẵ");
+    REQUIRE(renderer.uploads.size() == 1);
+    renderer.Render("á", "à");
+    CHECK(renderer.uploads.size() == 1);
+    CHECK(IsCgram(renderer.out[0][0]));
+    CHECK(IsCgram(renderer.out[1][0]));
+}
+
+TEST(InvalidateUploadsAgain) {
+    Renderer renderer;
+    renderer.Render("Việt Nam");
+    renderer.cache.Invalidate();
+    renderer.Render("Việt Nam");
+    CHECK(renderer.uploads.size() == 2);
+    CHECK(renderer.cache.stats().hits == 0);
+}
+
+TEST(UploadsReachThePanel) {
+    host_log_set_level('W');
+    lcd_init();
+    lcd_clear();
+    Lcd1602GlyphCache cache([](uint8_t slot, const uint8_t rows[8]) { lcd_upload_glyph(slot, rows); });
+    char out[LCD1602_ROWS][LCD1602_COLS + 1];
+    cache.Render("Đã kết nối", "", out);
+    lcd_show_lines(out[0], out[1]);
+
+    const char* row = fake_st7032_row(0);
+    const char* letters[] = {"Đ", "ã", "ế", "ố"};
+    int cells[] = {0, 1, 4, 8};
+    for (int i = 0; i < 4; i++) {
+        REQUIRE(IsCgram(row[cells[i]]));
+        int slot = row[cells[i]] - LCD1602_CGRAM_CODE_BASE;
+        auto glyph = vn::ComposeGlyph(*vn::FindLetter(Decode(letters[i])));
+        CHECK(std::memcmp(fake_st7032_glyph(slot), glyph.data(), 8) == 0);
+    }
+    CHECK(std::string(row).substr(2, 2) == " k");
+}
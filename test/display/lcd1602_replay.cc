@@ -0,0 +1,155 @@
+// Replays the frames Lcd1602Display posted on the device (LCDFRAME lines of a
+// monitor log, see CONFIG_LCD1602_BUS_RECORDER) through Lcd1602GlyphCache and
+// grove_lcd_162.c on the fake bus, paced like the render task. Reports what
+// every redraw put on the bus.
+//
+//   lcd1602_replay [--clock HZ] [--quiet] [--trace] session.log
+//
+// --trace prints the driver's LCDTX lines instead of the report table, ready
+// for scripts/lcd1602_emulator.
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <esp_timer.h>
+#include <freertos/task.h>
+
+#include "fake_i2c.h"
+#include "grove_lcd_162.h"
+#include "host_runtime.h"
+#include "lcd1602_glyph_cache.h"
+
+// Render task pacing, as LCD1602_FRAME_MS in lcd1602_display.h
+#define REPLAY_FRAME_MS 30
+
+namespace {
+
+struct Frame {
+    int64_t time_us;
+    std::string lines[LCD1602_ROWS];
+};
+
+std::vector<Frame> LoadSession(const char* path) {
+    std::vector<Frame> frames;
+    std::ifstream in(path);
+    std::string line;
+    while (std::getline(in, line)) {
+        size_t pos = line.find("LCDFRAME ");
+        if (pos == std::string::npos) continue;
+        char* text = nullptr;
+        Frame frame;
+        frame.time_us = std::strtoll(line.c_str() + pos + 9, &text, 10);
+        std::string lines = text != nullptr && *text == ' ' ? text + 1 : "";
+        size_t tab = lines.find('\t');
+        frame.lines[0] = lines.substr(0, tab);
+        frame.lines[1] = tab == std::string::npos ? "" : lines.substr(tab + 1);
+        frames.push_back(frame);
+    }
+    return frames;
+}
+
+// The panel after a redraw, CGRAM glyphs shown as '#' like the emulator does
+std::string PanelRow(int row) {
+    std::string text = fake_st7032_row(row);
+    std::replace_if(text.begin(), text.end(), [](char c) { return (unsigned char)c < 0x20; }, '#');
+    return text;
+}
+
+struct Update {
+    int64_t time_us;
+    int frames;  // Posted since the previous redraw, all but the last one coalesced
+    fake_i2c_stats_t bus;
+};
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const char* session = nullptr;
+    bool quiet = false;
+    bool trace = false;
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--clock") == 0 && i + 1 < argc) {
+            fake_i2c_set_clock_hz(std::strtoul(argv[++i], nullptr, 10));
+        } else if (std::strcmp(argv[i], "--quiet") == 0) {
+            quiet = true;
+        } else if (std::strcmp(argv[i], "--trace") == 0) {
+            trace = true;
+        } else {
+            session = argv[i];
+        }
+    }
+    if (session == nullptr) {
+        std::fprintf(stderr, "usage: %s [--clock HZ] [--quiet] [--trace] session.log\n", argv[0]);
+        return 2;
+    }
+    auto frames = LoadSession(session);
+    if (frames.empty()) {
+        std::fprintf(stderr, "No LCDFRAME lines in %s, enable CONFIG_LCD1602_BUS_RECORDER\n", session);
+        return 1;
+    }
+    FILE* report = trace ? stderr : stdout;
+
+    // Start where the device did, the render task brings the panel up first
+    host_log_set_level(trace ? 'I' : 'W');
+    host_clock_advance_us(frames[0].time_us);
+    lcd_init();
+    lcd_clear();
+    Lcd1602GlyphCache glyph_cache([](uint8_t slot, const uint8_t rows[8]) { lcd_upload_glyph(slot, rows); });
+
+    // The render task: woken by a post, waits one frame, draws the latest frame
+    std::vector<Update> updates;
+    size_t next = 0;
+    while (next < frames.size()) {
+        int64_t now = esp_timer_get_time();
+        if (frames[next].time_us > now) {
+            host_clock_advance_us(frames[next].time_us - now);
+        }
+        vTaskDelay(pdMS_TO_TICKS(REPLAY_FRAME_MS));
+        size_t first = next;
+        while (next < frames.size() && frames[next].time_us <= esp_timer_get_time()) {
+            next++;
+        }
+        const Frame& latest = frames[next - 1];
+
+        Update update{esp_timer_get_time(), int(next - first), {}};
+        fake_i2c_reset_stats();
+        char cells[LCD1602_ROWS][LCD1602_COLS + 1];
+        glyph_cache.Render(latest.lines[0].c_str(), latest.lines[1].c_str(), cells);
+        lcd_show_lines(cells[0], cells[1]);
+        update.bus = fake_i2c_get_stats();
+        updates.push_back(update);
+
+        if (!quiet) {
+            std::fprintf(report, "%10.3f s  %d frame%s  %3u tx  %4u bytes  %6.2f ms  |%s|%s|\n",
+                update.time_us / 1e6, update.frames, update.frames > 1 ? "s" : " ",
+                update.bus.transactions, update.bus.bytes, update.bus.bus_time_us / 1000.0,
+                PanelRow(0).c_str(), PanelRow(1).c_str());
+        }
+    }
+
+    fake_i2c_stats_t total = {};
+    uint32_t max_us = 0;
+    std::vector<uint32_t> times;
+    for (const auto& update : updates) {
+        total.transactions += update.bus.transactions;
+        total.bytes += update.bus.bytes;
+        total.bus_time_us += update.bus.bus_time_us;
+        max_us = std::max(max_us, update.bus.bus_time_us);
+        times.push_back(update.bus.bus_time_us);
+    }
+    std::sort(times.begin(), times.end());
+    const auto& glyphs = glyph_cache.stats();
+    std::fprintf(report, "frames: %zu posted, %zu drawn\n", frames.size(), updates.size());
+    std::fprintf(report, "bus: %u transactions, %u bytes, %.2f ms\n",
+        total.transactions, total.bytes, total.bus_time_us / 1000.0);
+    std::fprintf(report, "per update: %.1f transactions, %.1f bytes, bus time p50 %.2f ms, max %.2f ms\n",
+        double(total.transactions) / updates.size(), double(total.bytes) / updates.size(),
+        times[times.size() / 2] / 1000.0, max_us / 1000.0);
+    std::fprintf(report, "glyphs: %u hits, %u uploads, %u fallbacks\n", glyphs.hits, glyphs.uploads, glyphs.fallbacks);
+    return 0;
+}
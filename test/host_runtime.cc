@@ -0,0 +1,96 @@
+#include "host_runtime.h"
+
+#include <atomic>
+#include <cstdarg>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+
+#include <esp_err.h>
+#include <esp_log.h>
+#include <esp_timer.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include <freertos/task.h>
+
+static std::atomic<int64_t> clock_us{0};
+static std::atomic<char> log_level{'I'};
+
+static int LevelRank(char level) {
+    const char* order = "EWIDV";
+    const char* found = std::strchr(order, level);
+    return found != nullptr ? int(found - order) : 0;
+}
+
+extern "C" {
+
+void host_clock_advance_us(int64_t us) {
+    clock_us += us;
+}
+
+void host_clock_reset(void) {
+    clock_us = 0;
+}
+
+void host_log_set_level(char level) {
+    log_level = level;
+}
+
+int64_t esp_timer_get_time(void) {
+    return clock_us;
+}
+
+void vTaskDelay(TickType_t ticks) {
+    clock_us += int64_t(ticks) * 1000;
+}
+
+const char* esp_err_to_name(esp_err_t code) {
+    switch (code) {
+    case ESP_OK: return "ESP_OK";
+    case ESP_FAIL: return "ESP_FAIL";
+    case ESP_ERR_NO_MEM: return "ESP_ERR_NO_MEM";
+    case ESP_ERR_INVALID_ARG: return "ESP_ERR_INVALID_ARG";
+    case ESP_ERR_INVALID_STATE: return "ESP_ERR_INVALID_STATE";
+    case ESP_ERR_TIMEOUT: return "ESP_ERR_TIMEOUT";
+    default: return "UNKNOWN ERROR";
+    }
+}
+
+void host_log(char level, const char* tag, const char* format, ...) {
+    if (LevelRank(level) > LevelRank(log_level)) {
+        return;
+    }
+    std::printf("%c (%lld) %s: ", level, (long long)(clock_us / 1000), tag);
+    va_list args;
+    va_start(args, format);
+    std::vprintf(format, args);
+    va_end(args);
+    std::printf("\n");
+}
+
+struct host_semaphore {
+    std::timed_mutex mutex;
+};
+
+SemaphoreHandle_t xSemaphoreCreateMutex(void) {
+    return new host_semaphore;
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t semaphore, TickType_t ticks) {
+    if (ticks == portMAX_DELAY) {
+        semaphore->mutex.lock();
+        return pdTRUE;
+    }
+    return semaphore->mutex.try_lock_for(std::chrono::milliseconds(ticks)) ? pdTRUE : pdFALSE;
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t semaphore) {
+    semaphore->mutex.unlock();
+    return pdTRUE;
+}
+
+void vSemaphoreDelete(SemaphoreHandle_t semaphore) {
+    delete semaphore;
+}
+
+}
@@ -0,0 +1,26 @@
+#ifndef HOST_RUNTIME_H
+#define HOST_RUNTIME_H
+
+#include <stdint.h>
+
+/*
+ * Control over the host stand-ins in stubs/. Time is simulated: it starts at
+ * zero, esp_timer_get_time() reads it and vTaskDelay() or the fake bus
+ * advance it, so timing assertions do not depend on the machine.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void host_clock_advance_us(int64_t us);
+void host_clock_reset(void);
+
+// Highest ESP_LOGx level printed, 'E' .. 'V', 'I' by default
+void host_log_set_level(char level);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // HOST_RUNTIME_H
@@ -0,0 +1,58 @@
+#include <thread>
+#include <vector>
+
+#include <esp_log.h>
+#include <esp_timer.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include <freertos/task.h>
+
+#include "host_runtime.h"
+#include "host_test.h"
+
+TEST(ClockAdvancesOnlyWhenTold) {
+    CHECK(esp_timer_get_time() == 0);
+    vTaskDelay(pdMS_TO_TICKS(20));
+    CHECK(esp_timer_get_time() == 20000);
+    host_clock_advance_us(5);
+    CHECK(esp_timer_get_time() == 20005);
+}
+
+TEST(CriticalSectionExcludesOtherThreads) {
+    static portMUX_TYPE lock = portMUX_INITIALIZER_UNLOCKED;
+    int counter = 0;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; t++) {
+        threads.emplace_back([&] {
+            for (int i = 0; i < 100000; i++) {
+                portENTER_CRITICAL(&lock);
+                counter++;
+                portEXIT_CRITICAL(&lock);
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    CHECK(counter == 400000);
+}
+
+TEST(MutexTimesOutWhileHeld) {
+    SemaphoreHandle_t mutex = xSemaphoreCreateMutex();
+    REQUIRE(xSemaphoreTake(mutex, portMAX_DELAY) == pdTRUE);
+    BaseType_t taken = pdTRUE;
+    std::thread other([&] { taken = xSemaphoreTake(mutex, pdMS_TO_TICKS(5)); });
+    other.join();
+    CHECK(taken == pdFALSE);
+    xSemaphoreGive(mutex);
+    CHECK(xSemaphoreTake(mutex, 0) == pdTRUE);
+    xSemaphoreGive(mutex);
+    vSemaphoreDelete(mutex);
+}
+
+TEST(LogLevelFiltersMessages) {
+    host_log_set_level('E');
+    ESP_LOGI("host", "not printed");
+    host_log_set_level('I');
+    ESP_LOGI("host", "printed at %lld ms", (long long)(esp_timer_get_time() / 1000));
+}
@@ -0,0 +1,68 @@
+// Settings backed by a process wide map instead of NVS, so host tests can
+// configure modules the way the settings tool does on the device
+
+#include "settings.h"
+
+#include <map>
+#include <mutex>
+
+namespace {
+
+std::mutex mutex;
+std::map<std::string, std::string> strings;
+std::map<std::string, int32_t> ints;
+
+} // namespace
+
+Settings::Settings(const std::string& ns, bool read_write) : ns_(ns), read_write_(read_write) {
+}
+
+Settings::~Settings() {
+}
+
+std::string Settings::GetString(const std::string& key, const std::string& default_value) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = strings.find(ns_ + "." + key);
+    return it != strings.end() ? it->second : default_value;
+}
+
+void Settings::SetString(const std::string& key, const std::string& value) {
+    std::lock_guard<std::mutex> lock(mutex);
+    strings[ns_ + "." + key] = value;
+}
+
+int32_t Settings::GetInt(const std::string& key, int32_t default_value) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = ints.find(ns_ + "." + key);
+    return it != ints.end() ? it->second : default_value;
+}
+
+void Settings::SetInt(const std::string& key, int32_t value) {
+    std::lock_guard<std::mutex> lock(mutex);
+    ints[ns_ + "." + key] = value;
+}
+
+bool Settings::GetBool(const std::string& key, bool default_value) {
+    return GetInt(key, default_value ? 1 : 0) != 0;
+}
+
+void Settings::SetBool(const std::string& key, bool value) {
+    SetInt(key, value ? 1 : 0);
+}
+
+void Settings::EraseKey(const std::string& key) {
+    std::lock_guard<std::mutex> lock(mutex);
+    strings.erase(ns_ + "." + key);
+    ints.erase(ns_ + "." + key);
+}
+
+void Settings::EraseAll() {
+    std::lock_guard<std::mutex> lock(mutex);
+    std::string prefix = ns_ + ".";
+    for (auto it = strings.begin(); it != strings.end();) {
+        it = it->first.compare(0, prefix.size(), prefix) == 0 ? strings.erase(it) : std::next(it);
+    }
+    for (auto it = ints.begin(); it != ints.end();) {
+        it = it->first.compare(0, prefix.size(), prefix) == 0 ? ints.erase(it) : std::next(it);
+    }
+}
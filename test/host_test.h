@@ -0,0 +1,53 @@
+#ifndef HOST_TEST_H
+#define HOST_TEST_H
+
+#include <cstdio>
+#include <functional>
+#include <vector>
+
+/*
+ * Just enough of a test framework for the host tests: TEST() registers a
+ * case, CHECK() records a failure and carries on, REQUIRE() ends the case.
+ * Every test binary links host_test_main.cc and runs all of its cases.
+ */
+
+namespace host_test {
+
+struct Case {
+    const char* name;
+    std::function<void()> body;
+};
+
+std::vector<Case>& Cases();
+void Fail(const char* file, int line, const char* expression);
+
+struct Registrar {
+    Registrar(const char* name, std::function<void()> body) { Cases().push_back({name, std::move(body)}); }
+};
+
+struct Abort {};
+
+} // namespace host_test
+
+#define HOST_TEST_CONCAT_(a, b) a##b
+#define HOST_TEST_CONCAT(a, b) HOST_TEST_CONCAT_(a, b)
+
+#define TEST(name)                                                                     \
+    static void name();                                                                \
+    static host_test::Registrar HOST_TEST_CONCAT(name, _registrar)(#name, name);       \
+    static void name()
+
+#define CHECK(expression)                                                              \
+    do {                                                                               \
+        if (!(expression)) host_test::Fail(__FILE__, __LINE__, #expression);           \
+    } while (0)
+
+#define REQUIRE(expression)                                                            \
+    do {                                                                               \
+        if (!(expression)) {                                                           \
+            host_test::Fail(__FILE__, __LINE__, #expression);                          \
+            throw host_test::Abort{};                                                  \
+        }                                                                              \
+    } while (0)
+
+#endif // HOST_TEST_H
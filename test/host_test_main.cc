@@ -0,0 +1,48 @@
+#include "host_test.h"
+
+#include <cstring>
+
+#include "host_runtime.h"
+
+namespace host_test {
+
+static int failures = 0;
+
+std::vector<Case>& Cases() {
+    static std::vector<Case> cases;
+    return cases;
+}
+
+void Fail(const char* file, int line, const char* expression) {
+    std::printf("  %s:%d: CHECK(%s) failed\n", file, line, expression);
+    failures++;
+}
+
+} // namespace host_test
+
+// Runs every case, or only those named on the command line
+int main(int argc, char** argv) {
+    int failed_cases = 0;
+    int ran = 0;
+    for (auto& test_case : host_test::Cases()) {
+        bool selected = argc < 2;
+        for (int i = 1; i < argc; i++) {
+            selected |= std::strcmp(argv[i], test_case.name) == 0;
+        }
+        if (!selected) {
+            continue;
+        }
+        host_clock_reset();
+        int before = host_test::failures;
+        try {
+            test_case.body();
+        } catch (const host_test::Abort&) {
+        }
+        bool ok = host_test::failures == before;
+        std::printf("[%s] %s\n", ok ? " OK " : "FAIL", test_case.name);
+        failed_cases += ok ? 0 : 1;
+        ran++;
+    }
+    std::printf("%d of %d cases passed\n", ran - failed_cases, ran);
+    return failed_cases == 0 && ran > 0 ? 0 : 1;
+}
@@ -0,0 +1,2 @@
+#pragma once
+/* audio_codec.h includes the board header, nothing from it is used on the host */
@@ -0,0 +1,3 @@
+#pragma once
+/* Only passed around by pointer in the tested headers */
+typedef struct cJSON cJSON;
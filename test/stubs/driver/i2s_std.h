@@ -0,0 +1,3 @@
+#pragma once
+/* AudioCodec keeps the channel handles, the host never opens one */
+typedef struct i2s_channel_obj_t* i2s_chan_handle_t;
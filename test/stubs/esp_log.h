@@ -0,0 +1,17 @@
+#pragma once
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+/* Prints "L (ms) TAG: message" like the device console, levels above the host level are dropped */
+void host_log(char level, const char* tag, const char* format, ...) __attribute__((format(printf, 3, 4)));
+#ifdef __cplusplus
+}
+#endif
+
+#define ESP_LOGE(tag, format, ...) host_log('E', tag, format, ##__VA_ARGS__)
+#define ESP_LOGW(tag, format, ...) host_log('W', tag, format, ##__VA_ARGS__)
+#define ESP_LOGI(tag, format, ...) host_log('I', tag, format, ##__VA_ARGS__)
+#define ESP_LOGD(tag, format, ...) host_log('D', tag, format, ##__VA_ARGS__)
+#define ESP_LOGV(tag, format, ...) host_log('V', tag, format, ##__VA_ARGS__)
@@ -0,0 +1,13 @@
+#pragma once
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+typedef struct esp_timer* esp_timer_handle_t;
+
+/* Simulated clock, see host_runtime.h */
+int64_t esp_timer_get_time(void);
+#ifdef __cplusplus
+}
+#endif
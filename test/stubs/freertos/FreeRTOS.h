@@ -0,0 +1,23 @@
+#pragma once
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+typedef uint32_t TickType_t;
+
+#define portMAX_DELAY ((TickType_t)0xFFFFFFFF)
+#define pdMS_TO_TICKS(ms) ((TickType_t)(ms))
+#define pdTRUE 1
+#define pdFALSE 0
+#define pdPASS 1
+
+/* Critical sections become a spinlock, which is what they are across cores */
+typedef struct {
+    unsigned char locked;
+} portMUX_TYPE;
+
+#define portMUX_INITIALIZER_UNLOCKED {0}
+#define portENTER_CRITICAL(mux) while (__atomic_test_and_set(&(mux)->locked, __ATOMIC_ACQUIRE)) {}
+#define portEXIT_CRITICAL(mux) __atomic_clear(&(mux)->locked, __ATOMIC_RELEASE)
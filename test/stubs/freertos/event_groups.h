@@ -0,0 +1,14 @@
+#pragma once
+#include "FreeRTOS.h"
+
+typedef struct host_event_group* EventGroupHandle_t;
+typedef uint32_t EventBits_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+/* Declared for inline helpers in the audio headers, not implemented on the host */
+EventBits_t xEventGroupGetBits(EventGroupHandle_t event_group);
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,16 @@
+#pragma once
+#include "FreeRTOS.h"
+
+typedef struct host_semaphore* SemaphoreHandle_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+/* Mutexes only, backed by a host mutex */
+SemaphoreHandle_t xSemaphoreCreateMutex(void);
+BaseType_t xSemaphoreTake(SemaphoreHandle_t semaphore, TickType_t ticks);
+BaseType_t xSemaphoreGive(SemaphoreHandle_t semaphore);
+void vSemaphoreDelete(SemaphoreHandle_t semaphore);
+#ifdef __cplusplus
+}
+#endif
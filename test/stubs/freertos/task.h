@@ -0,0 +1,15 @@
+#pragma once
+#include "FreeRTOS.h"
+
+typedef struct host_task* TaskHandle_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+/* Advances the simulated clock instead of sleeping */
+void vTaskDelay(TickType_t ticks);
+#ifdef __cplusplus
+}
+#endif
+
+#define taskYIELD() ((void)0)
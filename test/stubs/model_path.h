@@ -0,0 +1,3 @@
+#pragma once
+/* esp-sr model list, only passed around by pointer */
+typedef struct srmodel_list srmodel_list_t;
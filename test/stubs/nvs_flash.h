@@ -0,0 +1,5 @@
+#pragma once
+#include <stdint.h>
+
+/* settings.h keeps an NVS handle, the host Settings keep values in memory */
+typedef uint32_t nvs_handle_t;
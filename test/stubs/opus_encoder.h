@@ -0,0 +1,3 @@
+#pragma once
+/* esp-opus-encoder wrappers, held by std::unique_ptr in AudioService only */
+class OpusEncoderWrapper;
@@ -0,0 +1,5 @@
+#pragma once
+/* Host build configuration, the options the tested modules read */
+#define CONFIG_OPUS_ENCODER_MAX_COMPLEXITY 0
+#define CONFIG_OPUS_ENCODER_LOAD_PERCENT 40
+#define CONFIG_LCD1602_BUS_RECORDER 1